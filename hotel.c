@@ -7,9 +7,68 @@
  * gerenciamento de estadias e sistema de fidelidade.
  */
 
+// POSIX.1-2008 (pread, pwrite, pthread_rwlock_t, localtime_r...) também
+// com -std=c11, que sem isso só declara o ISO C
+#define _POSIX_C_SOURCE 200809L
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>   // Modo servidor; precisa vir antes de qualquer windows.h
+#include <afunix.h>     // Socket de domínio Unix (Windows 10 1803 ou posterior)
+#endif
+
 #include <stdio.h>      // (printf, scanf, etc.)
 #include <stdlib.h>     // (FILE, malloc, etc.)
 #include <string.h>     // Para funções de manipulação de strings
+#include <stddef.h>     // size_t
+#include <time.h>       // timespec_get (espera da confirmação em grupo)
+#include <errno.h>      // EINTR
+#include <signal.h>     // sig_atomic_t (encerramento do servidor)
+#include <pthread.h>    // Threads do relatório e do servidor (winpthreads no MSYS2)
+
+#define LOCAL_DA_THREAD __thread  // Variável com uma cópia por thread (GCC/MinGW)
+
+#ifdef _WIN32
+#include <io.h>         // _commit (forçar gravação em disco no Windows)
+#include <direct.h>     // _mkdir, _chdir
+#include <fcntl.h>      // _open (arquivo de travas)
+#include <sys/stat.h>   // _S_IREAD, _S_IWRITE
+#include <windows.h>    // LockFileEx (travas entre processos)
+#define sincronizarDescritor(fd) _commit(fd)
+#define criarDiretorio(nome) _mkdir(nome)
+#define mudarDiretorio(nome) _chdir(nome)
+#define DISPOSITIVO_NULO "NUL"
+#define abrirDescritor(nome) _open(nome, _O_RDWR | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE)
+#define abrirDescritorExistente(nome) _open(nome, _O_RDWR | _O_BINARY)
+#define substituirArquivo(origem, destino) \
+    (MoveFileExA(origem, destino, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) ? 0 : -1)
+#define processadoresDisponiveis() (getenv("NUMBER_OF_PROCESSORS") ? atoi(getenv("NUMBER_OF_PROCESSORS")) : 1)
+typedef SOCKET Soquete;                   // Winsock: ligar com -lws2_32
+#define SOQUETE_INVALIDO INVALID_SOCKET
+#define fecharSoquete(s) closesocket(s)
+#define FIM_ESCRITA SD_SEND
+#define soqueteInterrompido() 0           // Winsock não usa errno nem é interrompido por sinais
+#else
+#include <unistd.h>     // fsync, chdir
+#include <sys/stat.h>   // mkdir
+#include <sys/socket.h> // Modo servidor (socket de domínio Unix)
+#include <sys/un.h>     // sockaddr_un
+#include <fcntl.h>      // fcntl (travas entre processos)
+#include <sys/mman.h>   // mmap (leitura dos arquivos de dados)
+#define sincronizarDescritor(fd) fsync(fd)
+#define criarDiretorio(nome) mkdir(nome, 0755)
+#define mudarDiretorio(nome) chdir(nome)
+#define DISPOSITIVO_NULO "/dev/null"
+#define abrirDescritor(nome) open(nome, O_RDWR | O_CREAT, 0644)
+#define abrirDescritorExistente(nome) open(nome, O_RDWR)
+#define substituirArquivo(origem, destino) rename(origem, destino)
+#define processadoresDisponiveis() ((int)sysconf(_SC_NPROCESSORS_ONLN))
+typedef int Soquete;
+#define SOQUETE_INVALIDO (-1)
+#define fecharSoquete(s) close(s)
+#define FIM_ESCRITA SHUT_WR
+#define soqueteInterrompido() (errno == EINTR)
+#endif
 
 // ============================================================
 // DEFINIÇÃO DE STRUCTS (ESTRUTURAS DE DADOS)
@@ -75,9 +134,34 @@ typedef struct
     Data dataEntrada;       // Data de check-in
     Data dataSaida;         // Data de check-out
     int quantidadeDiarias;  // Número total de diárias
-    int estadiaAtiva;       // Status: 1 = ativa, 0 = finalizada
+    int estadiaAtiva;       // Status: 1 = ativa, 0 = finalizada (em memória, ver estadiaAtual)
 } Estadia;
 
+/*
+ * Estrutura com os contadores de códigos automáticos
+ * Persistida em arquivo próprio para evitar varrer os dados a cada cadastro
+ */
+typedef struct
+{
+    int proximoCliente;     // Próximo código de cliente
+    int proximoFuncionario; // Próximo código de funcionário
+    int proximoEstadia;     // Próximo código de estadia
+} Sequencias;
+
+/*
+ * Saldo de pontos de um cliente no livro de fidelidade
+ * Mantido a cada estadia e encerramento (ver LIVRO DE FIDELIDADE)
+ */
+typedef struct
+{
+    int codigoCliente;     // Cliente do saldo
+    int totalEstadias;     // Estadias do cliente (ativas e finalizadas)
+    int totalDiarias;      // Diárias somadas de todas as estadias
+    int estadiasAtivas;    // Estadias ainda não encerradas
+    int pontos;            // Pontos acumulados (PONTOS_POR_DIARIA por diária)
+    int pontosResgatados;  // Pontos já trocados por benefícios
+} SaldoFidelidade;
+
 // ============================================================
 // DEFINIÇÃO DOS NOMES DOS ARQUIVOS DE DADOS
 // ============================================================
@@ -86,1503 +170,9011 @@ typedef struct
 const char *ARQ_CLIENTES = "clientes.bin";        // Arquivo de clientes
 const char *ARQ_FUNCIONARIOS = "funcionarios.bin"; // Arquivo de funcionários
 const char *ARQ_QUARTOS = "quartos.bin";          // Arquivo de quartos
-const char *ARQ_ESTADIAS = "estadias.bin";        // Arquivo de estadias
+const char *ARQ_ESTADIAS = "estadias.bin";        // Estadias ativas e recentes (segmento quente)
+const char *ARQ_HISTORICO = "estadias_historico.bin";  // Estadias finalizadas (segmento frio)
+const char *ARQ_SEQUENCIAS = "sequencias.bin";    // Próximos códigos de cada entidade
+const char *ARQ_SEQUENCIAS_NOVO = "sequencias.novo";  // Contadores novos em gravação
+const char *ARQ_DIARIO = "diario.log";            // Diário de operações (write-ahead log)
+
+// 1 quando o processo só lê os dados (exportar): arquivos de versões
+// anteriores e diários pendentes são aplicados só na memória, e nenhum
+// arquivo de dados é convertido, regravado ou recriado
+int somenteLeitura = 0;
 
 // ============================================================
-// FUNÇÃO AUXILIAR PARA LIMPAR BUFFER DE ENTRADA
+// TABELAS EM MEMÓRIA (DADOS RESIDENTES)
 // ============================================================
 
 /*
- * Função: limparEntrada
- * Objetivo: Limpar o buffer de entrada do teclado para evitar problemas
- *           com funções como scanf e fgets
- * Parâmetros: -
- * Retorno: void
+ * Todos os registros dos arquivos binários são carregados uma única vez
+ * na inicialização (carregarDados) para vetores contíguos em memória.
+ * As consultas do menu são atendidas a partir dessas tabelas e cada
+ * alteração é gravada também no arquivo correspondente.
  */
-void limparEntrada()
-{
-    int c;  // Variável para armazenar cada caractere
-    // Lê e descarta todos os caracteres até encontrar \n ou EOF
-    while ((c = getchar()) != '\n' && c != EOF)
-    {
-        // Loop vazio - apenas consome os caracteres
-    }
-}
+Cliente *tabelaClientes = NULL;          // Clientes carregados
+int totalClientes = 0;                   // Quantidade de clientes na tabela
+int capacidadeClientes = 0;              // Espaço alocado na tabela
 
-// ============================================================
-// FUNÇÕES PARA CÁLCULO DE DIÁRIAS (VALIDAÇÃO DE DATAS)
-// ============================================================
+Funcionario *tabelaFuncionarios = NULL;  // Funcionários carregados
+int totalFuncionarios = 0;
+int capacidadeFuncionarios = 0;
+
+Quarto *tabelaQuartos = NULL;            // Quartos carregados
+int totalQuartos = 0;
+int capacidadeQuartos = 0;
+
+Estadia *tabelaEstadias = NULL;          // Estadias carregadas
+int totalEstadias = 0;
+int capacidadeEstadias = 0;
+
+Sequencias sequencias = {1, 1, 1};      // Contadores de códigos em uso
 
 /*
- * Função: diasFevereiro
- * Objetivo: Determinar quantos dias tem fevereiro em um determinado ano
- *           Considera anos bissextos
- * Parâmetros: ano - ano a ser verificado
- * Retorno: int - 29 se for bissexto, 28 se não for
+ * Função: garantirCapacidade
+ * Objetivo: Garantir que um vetor dinâmico comporte uma quantidade de itens
+ *           Dobra a capacidade quando necessário para manter inserções O(1)
+ * Parâmetros: vetor - vetor atual (pode ser NULL)
+ *             capacidade - ponteiro para a capacidade atual (atualizada)
+ *             necessario - quantidade mínima de itens a comportar
+ *             tamanho - tamanho de cada item em bytes
+ * Retorno: void* - vetor (possivelmente realocado)
  */
-int diasFevereiro(int ano)
+void *garantirCapacidade(void *vetor, int *capacidade, int necessario, size_t tamanho)
 {
-    int bissexto = 0;  // Flag para indicar se é ano bissexto
+    if (necessario <= *capacidade)
+        return vetor;  // Já há espaço suficiente
 
-    // Verifica se é ano bissexto (divisível por 4)
-    if (ano % 4 == 0)
+    int nova = *capacidade > 0 ? *capacidade : 64;
+    while (nova < necessario)
+        nova *= 2;  // Crescimento geométrico
+
+    void *novoVetor = realloc(vetor, (size_t)nova * tamanho);
+    if (!novoVetor)
     {
-        // Exceção: se for divisível por 100, só é bissexto se for divisível por 400
-        if (ano % 100 != 0 || ano % 400 == 0)
-            bissexto = 1;  // É bissexto
+        printf("Erro: memoria insuficiente.\n");
+        exit(1);
     }
-    
-    // Retorna quantidade de dias conforme o ano
-    if (bissexto == 1)
-        return 29;  // Fevereiro em ano bissexto
-    else
-        return 28;  // Fevereiro em ano não bissexto
+    *capacidade = nova;
+    return novoVetor;
 }
 
 /*
- * Função: diasNoMes
- * Objetivo: Retornar o número de dias em um determinado mês/ano
- * Parâmetros: mes - mês (1-12)
- *             ano - ano para verificar fevereiro
- * Retorno: int - número de dias no mês
+ * Função: sincronizarArquivo
+ * Objetivo: Esvaziar o buffer do arquivo e forçar a gravação no disco
+ * Parâmetros: arq - arquivo aberto para escrita
+ * Retorno: int - 1 se os dados chegaram ao disco, 0 em caso de erro
  */
-int diasNoMes(int mes, int ano)
+int sincronizarArquivo(FILE *arq)
 {
-    // Switch para determinar dias conforme o mês
-    switch (mes)
-    {
-    case 2:  // Fevereiro - depende do ano
-        return diasFevereiro(ano);
-    case 4:   // Abril
-    case 6:   // Junho
-    case 9:   // Setembro
-    case 11:  // Novembro
-        return 30;  // Meses com 30 dias
-    default:  // Todos os outros meses
-        return 31;  // Meses com 31 dias
-    }
+    return fflush(arq) == 0 &&                      // Buffer da biblioteca -> sistema
+           sincronizarDescritor(fileno(arq)) == 0;  // Sistema -> disco
 }
 
 // ============================================================
-// FUNÇÃO DE VALIDAÇÃO DE DATA
+// FORMATO DOS ARQUIVOS DE DADOS
 // ============================================================
 
 /*
- * Função: validarData
- * Objetivo: Verificar se uma data é válida
- * Parâmetros: d - estrutura Data contendo dia, mês e ano
- * Retorno: int - 1 se válida, 0 se inválida
+ * Os arquivos de clientes, funcionários, quartos e estadias não são mais
+ * cópias diretas das structs: têm formato próprio, o mesmo em qualquer
+ * compilador e processador. O livro de fidelidade e o arquivo de
+ * sequências usam o mesmo formato. (O histórico usa o mesmo cabeçalho, mas
+ * blocos compactados; ver ARQUIVO DO HISTÓRICO.)
+ *
+ *   cabeçalho do arquivo (TAMANHO_CABECALHO bytes)
+ *      0 assinatura "HOTELDG\0"       8 versão do formato
+ *     12 tipo de registro (REGISTRO_*) 16 bytes por registro
+ *     20 registros por bloco          24 total de registros
+ *     28 maior código gravado + 1     32 três palavras próprias do tipo
+ *     60 CRC32C dos bytes 0-59
+ *   blocos de REGISTROS_POR_BLOCO registros, cada um precedido de
+ *      0 CRC32C dos registros do bloco  4 registros no bloco
+ *     (TAMANHO_CABECALHO_BLOCO bytes)
+ *
+ * Inteiros têm 4 bytes e doubles 8 (IEEE 754), sempre em little-endian, e
+ * cada campo fica num deslocamento fixo (ver codificarRegistro). Cabeçalhos
+ * e registros têm tamanho múltiplo de 8, então todo registro fica alinhado
+ * no arquivo: a carga mapeia o arquivo em memória, confere os blocos e
+ * decodifica direto do mapeamento. O CRC32C usa a instrução do processador
+ * quando existe (SSE4.2 no x86-64, extensão CRC32 no ARMv8).
+ *
+ * Um registro é gravado antes do cabeçalho do seu bloco e este antes do
+ * cabeçalho do arquivo, cujo total é o que vale na leitura. Um bloco que
+ * não confere na carga pode ser só uma gravação interrompida que o diário
+ * vai refazer; por isso o aviso espera a reaplicação do diário
+ * (conferirBlocosSuspeitos). Arquivos de versões anteriores, sem
+ * cabeçalho, são convertidos uma vez na carga (converterArquivosAntigos).
+ *
+ * Os registros não são usados no próprio mapeamento: lerRegistros os
+ * decodifica para um vetor alocado e desfaz o mapeamento em seguida.
+ * As tabelas ficam residentes e mudam depois da carga (inserções que
+ * realocam o vetor, check-outs e status de quarto alterados na memória),
+ * e um mapeamento somente leitura não aceita nada disso. Além disso a
+ * compactação e a conversão trocam os arquivos por rename, o que o
+ * Windows recusa enquanto houver uma visão aberta. Por fim, o layout das
+ * structs é do compilador: no x86-64 ele coincide com o do disco, mas não
+ * em toda plataforma, e os textos lidos de um arquivo danificado precisam
+ * do \0 garantido por lerTexto. A decodificação é uma passada sequencial
+ * feita uma vez na carga, junto com a conferência dos blocos.
  */
-int validarData(Data d) {
-    // Validar ano (consideramos de 1900 a 2100 como válido)
-    if (d.ano < 1900 || d.ano > 2100) {
-        return 0;  // Ano fora do intervalo permitido
-    }
-    
-    // Validar mês (deve estar entre 1 e 12)
-    if (d.mes < 1 || d.mes > 12) {
-        return 0;  // Mês inválido
-    }
-    
-    // Validar dia baseado no mês e ano
-    int diasNoMesValido = diasNoMes(d.mes, d.ano);  // Obtém dias do mês
-    if (d.dia < 1 || d.dia > diasNoMesValido) {
-        return 0;  // Dia inválido para o mês/ano
-    }
-    
-    return 1;  // Data válida
-}
+#define FORMATO_ASSINATURA "HOTELDG"   // 7 letras + \0 = 8 bytes
+#define FORMATO_VERSAO 1
+#define TAMANHO_CABECALHO 64
+#define TAMANHO_CABECALHO_BLOCO 16
+#define REGISTROS_POR_BLOCO 512
+#define TAMANHO_MAXIMO_REGISTRO 128    // Maior registro no disco (cliente)
 
-// ============================================================
-// FUNÇÃO AUXILIAR PARA LER DATA COM VALIDAÇÃO
-// ============================================================
+// Tipos de registro gravados no cabeçalho
+#define REGISTRO_CLIENTE 1
+#define REGISTRO_FUNCIONARIO 2
+#define REGISTRO_QUARTO 3
+#define REGISTRO_ESTADIA 4
+#define REGISTRO_DIARIO 5       // Operações do diário (ver DIÁRIO DE OPERAÇÕES)
+#define REGISTRO_HISTORICO 6    // Estadias finalizadas compactadas (ver ARQUIVO DO HISTÓRICO)
+#define REGISTRO_SEQUENCIAS 7   // Contadores de códigos (um único registro)
+#define REGISTRO_FIDELIDADE 8   // Saldos do livro de fidelidade (ver LIVRO DE FIDELIDADE)
 
 /*
- * Função: lerData
- * Objetivo: Ler uma data do usuário com validação e mensagens de erro
- * Parâmetros: mensagem - texto a ser exibido para o usuário
- *             data - ponteiro para estrutura Data onde armazenar o resultado
- * Retorno: int - 1 se leitura bem sucedida, 0 se falhou após 3 tentativas
+ * Cabeçalho de um arquivo de dados já decodificado
  */
-int lerData(const char *mensagem, Data *data) {
-    int tentativas = 0;  // Contador de tentativas falhas
-    
-    // Permite até 3 tentativas
-    while (tentativas < 3) {
-        printf("%s (DD MM AAAA): ", mensagem);
-        
-        // Ler os três valores (dia, mês, ano)
-        if (scanf("%d %d %d", &data->dia, &data->mes, &data->ano) != 3) {
-            printf("Formato invalido! Digite dia, mes e ano separados por espacos.\n");
-            limparEntrada();  // Limpa buffer para próxima tentativa
-            tentativas++;
-            continue;
-        }
-        
-        // Validar a data usando a função validarData
-        if (!validarData(*data)) {
-            printf("Data invalida! Verifique se o dia, mes e ano estao corretos.\n");
-            printf("Exemplo: 25 12 2024 para 25 de dezembro de 2024.\n");
-            tentativas++;
-            continue;
-        }
-        
-        return 1; // Data válida lida com sucesso
-    }
-    
-    // Se chegou aqui, falhou após 3 tentativas
-    printf("Muitas tentativas invalidas. Voltando ao menu.\n");
-    return 0; // Falha na leitura
-}
+typedef struct
+{
+    int tipo;              // REGISTRO_*
+    int total;             // Registros gravados
+    int proximoCodigo;     // Maior código gravado + 1 (1 se vazio)
+    int complemento[3];    // Dados do tipo (livro: estadias, ativas e CRC32C dos saldos)
+} CabecalhoArquivo;
 
-// ============================================================
-// FUNÇÕES PARA GERAR CÓDIGOS AUTOMÁTICOS
-// ============================================================
+#if defined(__GNUC__) && defined(__x86_64__)
+#define CRC32C_HARDWARE      // Instrução crc32 do SSE4.2, conferida em tempo de execução
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>        // __crc32cd
+#define CRC32C_HARDWARE
+#endif
+
+unsigned int tabelaCrc32c[256];  // CRC32C por byte (sem instrução do processador)
+int crc32cPreparado = 0;
+int crc32cPorHardware = 0;       // 1 se o processador calcula o CRC32C
 
 /*
- * Função: gerarCodigoCliente
- * Objetivo: Gerar um código único para novo cliente
- *           Lê o arquivo para encontrar o maior código e incrementa
- * Parâmetros: -
- * Retorno: int - próximo código disponível
+ * Função: prepararCrc32c
+ * Objetivo: Montar a tabela do CRC32C (polinômio de Castagnoli, refletido)
+ *           e descobrir se o processador tem a instrução
+ *           Chamada na carga, antes de existirem outras threads
+ * Parâmetros: nenhum
+ * Retorno: void
  */
-int gerarCodigoCliente()
+void prepararCrc32c()
 {
-    FILE *arquivo = fopen(ARQ_CLIENTES, "rb");  // Abre para leitura binária
-    if (!arquivo)  // Se arquivo não existe
-        return 1;  // Primeiro código será 1
-
-    Cliente c;
-    int maior = 0;  // Armazena o maior código encontrado
-
-    // Percorre todos os clientes no arquivo
-    while (fread(&c, sizeof(Cliente), 1, arquivo))
+    for (unsigned int i = 0; i < 256; i++)
     {
-        if (c.codigoCliente > maior)
-            maior = c.codigoCliente;  // Atualiza maior código
+        unsigned int c = i;
+        for (int bit = 0; bit < 8; bit++)
+            c = (c & 1) ? (c >> 1) ^ 0x82F63B78u : c >> 1;
+        tabelaCrc32c[i] = c;
     }
-    fclose(arquivo);  // Fecha o arquivo
-    return maior + 1;  // Retorna próximo código
+#if defined(__GNUC__) && defined(__x86_64__)
+    crc32cPorHardware = __builtin_cpu_supports("sse4.2");
+#elif defined(CRC32C_HARDWARE)
+    crc32cPorHardware = 1;  // Garantida pela arquitetura alvo da compilação
+#endif
+    crc32cPreparado = 1;
 }
 
+#if defined(__GNUC__) && defined(__x86_64__)
 /*
- * Função: gerarCodigoFuncionario
- * Objetivo: Gerar código único para novo funcionário
- * Parâmetros: -
- * Retorno: int - próximo código disponível
+ * Função: crc32cHardware
+ * Objetivo: Avançar o CRC32C (sem inversões) com a instrução crc32 do SSE4.2,
+ *           8 bytes por instrução
  */
-int gerarCodigoFuncionario()
+__attribute__((target("sse4.2")))
+unsigned int crc32cHardware(unsigned int crc, const unsigned char *p, size_t tamanho)
 {
-    FILE *arquivo = fopen(ARQ_FUNCIONARIOS, "rb");
-    if (!arquivo)
-        return 1;  // Primeiro código
-
-    Funcionario func;
-    int maior = 0;
-
-    while (fread(&func, sizeof(Funcionario), 1, arquivo))
+    unsigned long long c = crc;
+    for (; tamanho >= 8; tamanho -= 8, p += 8)
     {
-        if (func.codigoFuncionario > maior)
-            maior = func.codigoFuncionario;
+        unsigned long long palavra;
+        memcpy(&palavra, p, 8);
+        c = __builtin_ia32_crc32di(c, palavra);
     }
-    fclose(arquivo);
-    return maior + 1;
+    crc = (unsigned int)c;
+    for (; tamanho > 0; tamanho--, p++)
+        crc = __builtin_ia32_crc32qi(crc, *p);
+    return crc;
 }
-
+#elif defined(CRC32C_HARDWARE)
 /*
- * Função: gerarCodigoEstadia
- * Objetivo: Gerar código único para nova estadia
- * Parâmetros: -
- * Retorno: int - próximo código disponível
+ * Função: crc32cHardware
+ * Objetivo: Avançar o CRC32C (sem inversões) com as instruções CRC32C do ARMv8
  */
-int gerarCodigoEstadia()
+unsigned int crc32cHardware(unsigned int crc, const unsigned char *p, size_t tamanho)
 {
-    FILE *arquivo = fopen(ARQ_ESTADIAS, "rb");
-    if (!arquivo)
-        return 1;  // Primeiro código
-
-    Estadia e;
-    int maior = 0;
-
-    while (fread(&e, sizeof(Estadia), 1, arquivo))
+    for (; tamanho >= 8; tamanho -= 8, p += 8)
     {
-        if (e.codigoEstadia > maior)
-            maior = e.codigoEstadia;
+        unsigned long long palavra;
+        memcpy(&palavra, p, 8);
+        crc = __crc32cd(crc, palavra);
     }
-    fclose(arquivo);
-    return maior + 1;
+    for (; tamanho > 0; tamanho--, p++)
+        crc = __crc32cb(crc, *p);
+    return crc;
 }
-
-// ============================================================
-// FUNÇÕES PARA SALVAR DADOS EM ARQUIVOS
-// ============================================================
+#endif
 
 /*
- * Função: salvarClienteArquivo
- * Objetivo: Salvar um cliente no arquivo binário
- * Parâmetros: c - estrutura Cliente a ser salva
- * Retorno: void
+ * Função: continuarCrc32c
+ * Objetivo: Calcular o CRC32C de um trecho, continuando de uma soma anterior
+ *           continuarCrc32c(continuarCrc32c(0, a), b) == CRC32C de a seguido de b
+ * Parâmetros: soma - CRC32C dos bytes anteriores (0 para começar)
+ *             dados, tamanho - bytes a acrescentar
+ * Retorno: unsigned int - CRC32C acumulado
  */
-void salvarClienteArquivo(Cliente c)
+unsigned int continuarCrc32c(unsigned int soma, const void *dados, size_t tamanho)
 {
-    FILE *arq = fopen(ARQ_CLIENTES, "ab");  // Abre para append binário
-    fwrite(&c, sizeof(Cliente), 1, arq);    // Escreve estrutura no arquivo
-    fclose(arq);                            // Fecha arquivo
+    if (!crc32cPreparado)
+        prepararCrc32c();
+
+    const unsigned char *p = dados;
+    unsigned int crc = ~soma;
+#ifdef CRC32C_HARDWARE
+    if (crc32cPorHardware)
+        return ~crc32cHardware(crc, p, tamanho);
+#endif
+    for (; tamanho > 0; tamanho--, p++)
+        crc = tabelaCrc32c[(crc ^ *p) & 0xFF] ^ (crc >> 8);
+    return ~crc;
 }
 
 /*
- * Função: salvarFuncionarioArquivo
- * Objetivo: Salvar um funcionário no arquivo binário
- * Parâmetros: arquivo - estrutura Funcionario a ser salva
- * Retorno: void
+ * Funções: escreverPalavra / lerPalavra / escreverReal / lerReal
+ * Objetivo: Gravar e ler números em little-endian, independente do processador
+ *           (palavra = 4 bytes; real = double IEEE 754 de 8 bytes)
  */
-void salvarFuncionarioArquivo(Funcionario arquivo)
+void escreverPalavra(unsigned char *p, unsigned int valor)
 {
-    FILE *arq = fopen(ARQ_FUNCIONARIOS, "ab");
-    fwrite(&arquivo, sizeof(Funcionario), 1, arq);
-    fclose(arq);
+    p[0] = (unsigned char)valor;
+    p[1] = (unsigned char)(valor >> 8);
+    p[2] = (unsigned char)(valor >> 16);
+    p[3] = (unsigned char)(valor >> 24);
 }
 
-/*
- * Função: salvarQuartoArquivo
- * Objetivo: Salvar um quarto no arquivo binário
- * Parâmetros: q - estrutura Quarto a ser salva
- * Retorno: void
- */
-void salvarQuartoArquivo(Quarto q)
+unsigned int lerPalavra(const unsigned char *p)
 {
-    FILE *arq = fopen(ARQ_QUARTOS, "ab");
-    fwrite(&q, sizeof(Quarto), 1, arq);
-    fclose(arq);
+    return (unsigned int)p[0] | (unsigned int)p[1] << 8 |
+           (unsigned int)p[2] << 16 | (unsigned int)p[3] << 24;
+}
+
+void escreverReal(unsigned char *p, double valor)
+{
+    unsigned long long bits;
+    memcpy(&bits, &valor, 8);
+    escreverPalavra(p, (unsigned int)bits);
+    escreverPalavra(p + 4, (unsigned int)(bits >> 32));
+}
+
+double lerReal(const unsigned char *p)
+{
+    unsigned long long bits = (unsigned long long)lerPalavra(p + 4) << 32 | lerPalavra(p);
+    double valor;
+    memcpy(&valor, &bits, 8);
+    return valor;
 }
 
 /*
- * Função: salvarEstadiaArquivo
- * Objetivo: Salvar uma estadia no arquivo binário
- * Parâmetros: e - estrutura Estadia a ser salva
- * Retorno: void
+ * Função: lerTexto
+ * Objetivo: Copiar um campo de texto do arquivo garantindo o \0 final,
+ *           mesmo que o arquivo esteja danificado
  */
-void salvarEstadiaArquivo(Estadia e)
+void lerTexto(char *destino, const unsigned char *origem, size_t tamanho)
 {
-    FILE *arq = fopen(ARQ_ESTADIAS, "ab");
-    fwrite(&e, sizeof(Estadia), 1, arq);
-    fclose(arq);
+    memcpy(destino, origem, tamanho);
+    destino[tamanho - 1] = '\0';
 }
 
-// ============================================================
-// FUNÇÃO PARA CÁLCULO DE DIAS ENTRE DATAS
-// ============================================================
-
 /*
- * Função: diasEntreDatas
- * Objetivo: Calcular o número de dias entre duas datas
- *           Usado para calcular diárias de estadia
- * Parâmetros: e - data de entrada
- *             s - data de saída
- * Retorno: int - número de dias, ou -1 se datas inválidas
+ * Função: tamanhoNoDisco / tamanhoNaMemoria
+ * Objetivo: Bytes de um registro do tipo no arquivo e na struct correspondente
  */
-int diasEntreDatas(Data e, Data s)
+int tamanhoNoDisco(int tipo)
 {
-    // Primeiro validar ambas as datas
-    if (!validarData(e) || !validarData(s)) {
-        return -1;  // Datas inválidas
+    switch (tipo)
+    {
+    case REGISTRO_CLIENTE:     return 128;
+    case REGISTRO_FUNCIONARIO: return 112;
+    case REGISTRO_QUARTO:      return 24;
+    case REGISTRO_HISTORICO:   return 0;   // Tamanho variável
+    case REGISTRO_SEQUENCIAS:  return 16;
+    case REGISTRO_FIDELIDADE:  return 24;
+    default:                   return 48;  // REGISTRO_ESTADIA
     }
-    
-    // Verificar se a data de saída é posterior à data de entrada
-    if (s.ano < e.ano)
-        return -1;  // Saída em ano anterior à entrada
-    if (s.ano == e.ano && s.mes < e.mes)
-        return -1;  // Mesmo ano, mas mês de saída anterior
-    if (s.ano == e.ano && s.mes == e.mes && s.dia <= e.dia)
-        return -1;  // Mesmo mês/ano, mas dia de saída não posterior
-
-    int dias = 0;  // Acumulador de dias
-
-    // Caso simples: mesmo mês e ano
-    if (e.ano == s.ano && e.mes == s.mes)
-        return s.dia - e.dia;  // Apenas subtrai os dias
-
-    // Dias restantes no mês de entrada
-    dias += diasNoMes(e.mes, e.ano) - e.dia;
-
-    // Meses intermediários entre entrada e saída
-    int mesAtual = e.mes + 1;
-    int anoAtual = e.ano;
+}
 
-    // Percorre meses entre entrada e saída (excluindo mês de entrada e saída)
-    while (anoAtual < s.ano || (anoAtual == s.ano && mesAtual < s.mes))
+size_t tamanhoNaMemoria(int tipo)
+{
+    switch (tipo)
     {
-        dias += diasNoMes(mesAtual, anoAtual);  // Adiciona dias do mês
-        mesAtual++;
-
-        // Ajusta ano se passar de dezembro
-        if (mesAtual > 12)
-        {
-            mesAtual = 1;
-            anoAtual++;
-        }
+    case REGISTRO_CLIENTE:     return sizeof(Cliente);
+    case REGISTRO_FUNCIONARIO: return sizeof(Funcionario);
+    case REGISTRO_QUARTO:      return sizeof(Quarto);
+    case REGISTRO_SEQUENCIAS:  return sizeof(Sequencias);
+    case REGISTRO_FIDELIDADE:  return sizeof(SaldoFidelidade);
+    default:                   return sizeof(Estadia);
     }
-
-    // Dias no mês de saída
-    dias += s.dia;
-
-    return dias;  // Retorna total de dias
 }
 
-// ============================================================
-// FUNÇÕES DE BUSCA EM ARQUIVOS
-// ============================================================
-
 /*
- * Função: buscarCliente
- * Objetivo: Buscar um cliente pelo código
- * Parâmetros: codigo - código do cliente a buscar
- *             resultado - ponteiro para armazenar cliente encontrado
- * Retorno: int - 1 se encontrou, 0 se não encontrou
+ * Função: codigoDoRegistro
+ * Objetivo: Código (ou número, no caso do quarto) que identifica o registro
  */
-int buscarCliente(int codigo, Cliente *resultado)
+int codigoDoRegistro(int tipo, const void *registro)
 {
-    FILE *arquivo = fopen(ARQ_CLIENTES, "rb");
-    if (!arquivo)
-        return 0;  // Arquivo não existe
-
-    Cliente c;
-    // Percorre arquivo procurando cliente com código especificado
-    while (fread(&c, sizeof(Cliente), 1, arquivo))
+    switch (tipo)
     {
-        if (c.codigoCliente == codigo)
-        {
-            *resultado = c;  // Copia cliente encontrado
-            fclose(arquivo);
-            return 1;  // Sucesso
-        }
+    case REGISTRO_CLIENTE:     return ((const Cliente *)registro)->codigoCliente;
+    case REGISTRO_FUNCIONARIO: return ((const Funcionario *)registro)->codigoFuncionario;
+    case REGISTRO_QUARTO:      return ((const Quarto *)registro)->numeroQuarto;
+    case REGISTRO_SEQUENCIAS:  return 0;  // Sem código próprio
+    case REGISTRO_FIDELIDADE:  return ((const SaldoFidelidade *)registro)->codigoCliente;
+    default:                   return ((const Estadia *)registro)->codigoEstadia;
     }
-    fclose(arquivo);
-    return 0;  // Cliente não encontrado
 }
 
 /*
- * Função: buscarQuarto
- * Objetivo: Buscar um quarto pelo número
- * Parâmetros: numero - número do quarto a buscar
- *             resultado - ponteiro para armazenar quarto encontrado
- * Retorno: int - 1 se encontrou, 0 se não encontrou
+ * Função: codificarRegistro
+ * Objetivo: Converter uma struct para a sua forma no arquivo
+ *           Cliente (128):     código 0, nome 4, endereço 54, telefone 104
+ *           Funcionário (112): código 0, nome 4, telefone 54, cargo 74, salário 104
+ *           Quarto (24):       número 0, capacidade 4, diária 8, ocupado 16
+ *           Estadia (48):      código 0, cliente 4, quarto 8, entrada 12-20,
+ *                              saída 24-32, diárias 36, ativa 40
+ *           Sequências (16):   cliente 0, funcionário 4, estadia 8
+ *           Saldo (24):        cliente 0, estadias 4, diárias 8, ativas 12,
+ *                              pontos 16, resgatados 20
+ *           Bytes não usados ficam zerados
+ * Parâmetros: tipo - REGISTRO_*
+ *             registro - struct de origem
+ *             destino - tamanhoNoDisco(tipo) bytes
+ * Retorno: void
  */
-int buscarQuarto(int numero, Quarto *resultado)
+void codificarRegistro(int tipo, const void *registro, unsigned char *destino)
 {
-    FILE *arquivo = fopen(ARQ_QUARTOS, "rb");
-    if (!arquivo)
-        return 0;
-
-    Quarto q;
-    while (fread(&q, sizeof(Quarto), 1, arquivo))
+    memset(destino, 0, (size_t)tamanhoNoDisco(tipo));
+    switch (tipo)
     {
-        if (q.numeroQuarto == numero)
-        {
-            *resultado = q;
-            fclose(arquivo);
-            return 1;
-        }
+    case REGISTRO_CLIENTE:
+    {
+        const Cliente *c = registro;
+        escreverPalavra(destino, (unsigned int)c->codigoCliente);
+        memcpy(destino + 4, c->nome, sizeof(c->nome));
+        memcpy(destino + 54, c->endereco, sizeof(c->endereco));
+        memcpy(destino + 104, c->telefone, sizeof(c->telefone));
+        break;
     }
-    fclose(arquivo);
-    return 0;
-}
-
-// ============================================================
-// FUNÇÃO PARA MARCAR QUARTO COMO OCUPADO OU LIVRE
-// ============================================================
+    case REGISTRO_FUNCIONARIO:
+    {
+        const Funcionario *f = registro;
+        escreverPalavra(destino, (unsigned int)f->codigoFuncionario);
+        memcpy(destino + 4, f->nome, sizeof(f->nome));
+        memcpy(destino + 54, f->telefone, sizeof(f->telefone));
+        memcpy(destino + 74, f->cargo, sizeof(f->cargo));
+        escreverReal(destino + 104, f->salario);
+        break;
+    }
+    case REGISTRO_QUARTO:
+    {
+        const Quarto *q = registro;
+        escreverPalavra(destino, (unsigned int)q->numeroQuarto);
+        escreverPalavra(destino + 4, (unsigned int)q->capacidade);
+        escreverReal(destino + 8, q->valorDiaria);
+        escreverPalavra(destino + 16, (unsigned int)q->estaOcupado);
+        break;
+    }
+    case REGISTRO_SEQUENCIAS:
+    {
+        const Sequencias *sq = registro;
+        escreverPalavra(destino, (unsigned int)sq->proximoCliente);
+        escreverPalavra(destino + 4, (unsigned int)sq->proximoFuncionario);
+        escreverPalavra(destino + 8, (unsigned int)sq->proximoEstadia);
+        break;
+    }
+    case REGISTRO_FIDELIDADE:
+    {
+        const SaldoFidelidade *sf = registro;
+        const int campos[6] = {sf->codigoCliente, sf->totalEstadias, sf->totalDiarias,
+                               sf->estadiasAtivas, sf->pontos, sf->pontosResgatados};
+        for (int i = 0; i < 6; i++)
+            escreverPalavra(destino + 4 * i, (unsigned int)campos[i]);
+        break;
+    }
+    default:
+    {
+        const Estadia *e = registro;
+        const int campos[10] = {e->codigoEstadia, e->codigoCliente, e->numeroQuarto,
+                                e->dataEntrada.dia, e->dataEntrada.mes, e->dataEntrada.ano,
+                                e->dataSaida.dia, e->dataSaida.mes, e->dataSaida.ano,
+                                e->quantidadeDiarias};
+        for (int i = 0; i < 10; i++)
+            escreverPalavra(destino + 4 * i, (unsigned int)campos[i]);
+        escreverPalavra(destino + 40, (unsigned int)e->estadiaAtiva);
+        break;
+    }
+    }
+}
 
 /*
- * Função: quartoOcupado
- * Objetivo: Alterar status de ocupação de um quarto
- * Parâmetros: numero - número do quarto
- *             ocupado - novo status (1 = ocupado, 0 = livre)
- * Retorno: void
- * 
- * Nota: Cria arquivo temporário para atualização, depois substitui o original
+ * Função: decodificarRegistro
+ * Objetivo: Montar a struct a partir da forma do registro no arquivo
+ *           (inverso de codificarRegistro)
  */
-void quartoOcupado(int numero, int ocupado)
+void decodificarRegistro(int tipo, const unsigned char *origem, void *registro)
 {
-    // Abre arquivo original para leitura e temporário para escrita
-    FILE *in = fopen(ARQ_QUARTOS, "rb");
-    FILE *out = fopen("temp.dat", "wb");
-
-    Quarto q;
-    // Lê todos os quartos do arquivo original
-    while (fread(&q, sizeof(Quarto), 1, in))
+    memset(registro, 0, tamanhoNaMemoria(tipo));  // Zera também o preenchimento da struct
+    switch (tipo)
     {
-        // Se é o quarto procurado, atualiza status
-        if (q.numeroQuarto == numero)
-            q.estaOcupado = ocupado;
-
-        // Escreve no arquivo temporário (atualizado ou não)
-        fwrite(&q, sizeof(Quarto), 1, out);
+    case REGISTRO_CLIENTE:
+    {
+        Cliente *c = registro;
+        c->codigoCliente = (int)lerPalavra(origem);
+        lerTexto(c->nome, origem + 4, sizeof(c->nome));
+        lerTexto(c->endereco, origem + 54, sizeof(c->endereco));
+        lerTexto(c->telefone, origem + 104, sizeof(c->telefone));
+        break;
+    }
+    case REGISTRO_FUNCIONARIO:
+    {
+        Funcionario *f = registro;
+        f->codigoFuncionario = (int)lerPalavra(origem);
+        lerTexto(f->nome, origem + 4, sizeof(f->nome));
+        lerTexto(f->telefone, origem + 54, sizeof(f->telefone));
+        lerTexto(f->cargo, origem + 74, sizeof(f->cargo));
+        f->salario = lerReal(origem + 104);
+        break;
+    }
+    case REGISTRO_QUARTO:
+    {
+        Quarto *q = registro;
+        q->numeroQuarto = (int)lerPalavra(origem);
+        q->capacidade = (int)lerPalavra(origem + 4);
+        q->valorDiaria = lerReal(origem + 8);
+        q->estaOcupado = (int)lerPalavra(origem + 16);
+        break;
+    }
+    case REGISTRO_SEQUENCIAS:
+    {
+        Sequencias *sq = registro;
+        sq->proximoCliente = (int)lerPalavra(origem);
+        sq->proximoFuncionario = (int)lerPalavra(origem + 4);
+        sq->proximoEstadia = (int)lerPalavra(origem + 8);
+        break;
     }
+    case REGISTRO_FIDELIDADE:
+    {
+        SaldoFidelidade *sf = registro;
+        sf->codigoCliente = (int)lerPalavra(origem);
+        sf->totalEstadias = (int)lerPalavra(origem + 4);
+        sf->totalDiarias = (int)lerPalavra(origem + 8);
+        sf->estadiasAtivas = (int)lerPalavra(origem + 12);
+        sf->pontos = (int)lerPalavra(origem + 16);
+        sf->pontosResgatados = (int)lerPalavra(origem + 20);
+        break;
+    }
+    default:
+    {
+        Estadia *e = registro;
+        int campos[10];
+        for (int i = 0; i < 10; i++)
+            campos[i] = (int)lerPalavra(origem + 4 * i);
+        e->codigoEstadia = campos[0];
+        e->codigoCliente = campos[1];
+        e->numeroQuarto = campos[2];
+        e->dataEntrada = (Data){campos[3], campos[4], campos[5]};
+        e->dataSaida = (Data){campos[6], campos[7], campos[8]};
+        e->quantidadeDiarias = campos[9];
+        e->estadiaAtiva = (int)lerPalavra(origem + 40);
+        break;
+    }
+    }
+}
 
-    // Fecha arquivos
-    fclose(in);
-    fclose(out);
-    
-    // Substitui arquivo original pelo temporário
-    remove(ARQ_QUARTOS);
-    rename("temp.dat", ARQ_QUARTOS);
+/*
+ * Funções: deslocamentoBloco / deslocamentoRegistro
+ * Objetivo: Posição em bytes do cabeçalho de um bloco e de um registro
+ */
+long deslocamentoBloco(int tipo, int bloco)
+{
+    long tamanhoBloco = TAMANHO_CABECALHO_BLOCO + (long)REGISTROS_POR_BLOCO * tamanhoNoDisco(tipo);
+    return TAMANHO_CABECALHO + bloco * tamanhoBloco;
 }
 
-// ============================================================
-// FUNÇÕES PARA PESQUISA DE CLIENTES
-// ============================================================
+long deslocamentoRegistro(int tipo, int indice)
+{
+    return deslocamentoBloco(tipo, indice / REGISTROS_POR_BLOCO) + TAMANHO_CABECALHO_BLOCO +
+           (long)(indice % REGISTROS_POR_BLOCO) * tamanhoNoDisco(tipo);
+}
 
 /*
- * Função: pesquisarCliente
- * Objetivo: Pesquisar cliente por código ou nome
- *           Permite busca exata por código ou parcial por nome
- * Parâmetros: -
+ * Função: codificarCabecalho
+ * Objetivo: Montar os TAMANHO_CABECALHO bytes do cabeçalho do arquivo
+ */
+void codificarCabecalho(const CabecalhoArquivo *c, unsigned char *destino)
+{
+    memset(destino, 0, TAMANHO_CABECALHO);
+    memcpy(destino, FORMATO_ASSINATURA, 8);
+    escreverPalavra(destino + 8, FORMATO_VERSAO);
+    escreverPalavra(destino + 12, (unsigned int)c->tipo);
+    escreverPalavra(destino + 16, (unsigned int)tamanhoNoDisco(c->tipo));
+    escreverPalavra(destino + 20, REGISTROS_POR_BLOCO);
+    escreverPalavra(destino + 24, (unsigned int)c->total);
+    escreverPalavra(destino + 28, (unsigned int)c->proximoCodigo);
+    for (int i = 0; i < 3; i++)
+        escreverPalavra(destino + 32 + 4 * i, (unsigned int)c->complemento[i]);
+    escreverPalavra(destino + 60, continuarCrc32c(0, destino, 60));
+}
+
+/*
+ * Função: temAssinatura
+ * Objetivo: Verificar se os primeiros bytes são de um arquivo no formato atual
+ *           (arquivos sem assinatura são de versões anteriores)
+ */
+int temAssinatura(const unsigned char *bytes, size_t tamanho)
+{
+    return tamanho >= 8 && memcmp(bytes, FORMATO_ASSINATURA, 8) == 0;
+}
+
+/*
+ * Função: conferirCabecalho
+ * Objetivo: Validar e ler o cabeçalho de um arquivo de dados, sem encerrar
+ *           o programa (quem chama decide o que fazer com um defeito)
+ * Parâmetros: bytes, tamanho - início do arquivo
+ *             tipo - REGISTRO_* esperado
+ *             c - cabeçalho lido
+ * Retorno: int - 0 se válido, 1 se não está no formato, 2 se é de outra
+ *          versão do formato, 3 se está danificado ou é de outro tipo
+ */
+int conferirCabecalho(const unsigned char *bytes, size_t tamanho, int tipo, CabecalhoArquivo *c)
+{
+    if (tamanho < TAMANHO_CABECALHO || !temAssinatura(bytes, tamanho))
+        return 1;
+    if (lerPalavra(bytes + 8) != FORMATO_VERSAO)
+        return 2;
+    if (lerPalavra(bytes + 60) != continuarCrc32c(0, bytes, 60) ||
+        lerPalavra(bytes + 12) != (unsigned int)tipo ||
+        lerPalavra(bytes + 16) != (unsigned int)tamanhoNoDisco(tipo) ||
+        lerPalavra(bytes + 20) != REGISTROS_POR_BLOCO)
+        return 3;
+    c->tipo = tipo;
+    c->total = (int)lerPalavra(bytes + 24);
+    c->proximoCodigo = (int)lerPalavra(bytes + 28);
+    for (int i = 0; i < 3; i++)
+        c->complemento[i] = (int)lerPalavra(bytes + 32 + 4 * i);
+    return 0;
+}
+
+/*
+ * Função: decodificarCabecalho
+ * Objetivo: Validar e ler o cabeçalho de um arquivo de dados
+ *           Encerra o programa se o arquivo não for do tipo esperado, de
+ *           outra versão do formato ou com o cabeçalho danificado: carregar
+ *           dados errados seria pior do que não abrir
+ * Parâmetros: nome - nome do arquivo (para a mensagem)
+ *             bytes, tamanho - início do arquivo
+ *             tipo - REGISTRO_* esperado
+ *             c - cabeçalho lido
  * Retorno: void
  */
-void pesquisarCliente()
+void decodificarCabecalho(const char *nome, const unsigned char *bytes, size_t tamanho,
+                          int tipo, CabecalhoArquivo *c)
 {
-    int opcao;  // Opção de busca (1=código, 2=nome)
-    printf("\n=== PESQUISAR CLIENTE ===\n");
-    printf("1 - Pesquisar por codigo\n");
-    printf("2 - Pesquisar por nome\n");
-    printf("Opcao: ");
-    scanf("%d", &opcao);
-    limparEntrada();  // Limpa buffer após scanf
-    
-    // Abre arquivo de clientes
-    FILE *arquivo = fopen(ARQ_CLIENTES, "rb");
-    if (!arquivo)
+    switch (conferirCabecalho(bytes, tamanho, tipo, c))
     {
-        printf("Nenhum cliente cadastrado.\n");
+    case 0:
         return;
+    case 1:
+        printf("Erro: %s nao esta no formato de dados do hotel.\n", nome);
+        break;
+    case 2:
+        printf("Erro: %s usa a versao %u do formato; esta versao do programa le a %d.\n",
+               nome, lerPalavra(bytes + 8), FORMATO_VERSAO);
+        break;
+    default:
+        printf("Erro: cabecalho de %s danificado ou de outro tipo de registro.\n", nome);
+        break;
     }
-    
-    Cliente c;
-    int encontrou = 0;  // Flag para indicar se encontrou resultados
-    
-    // Busca por código
-    if (opcao == 1)
+    exit(1);
+}
+
+/*
+ * Função: lerCabecalhoArquivo
+ * Objetivo: Ler só o cabeçalho de um arquivo de dados
+ *           (total de registros e próximo código sem percorrer o arquivo)
+ * Parâmetros: nome - nome do arquivo
+ *             tipo - REGISTRO_* esperado
+ *             c - cabeçalho lido (vazio se o arquivo não existe)
+ * Retorno: void
+ */
+void lerCabecalhoArquivo(const char *nome, int tipo, CabecalhoArquivo *c)
+{
+    *c = (CabecalhoArquivo){tipo, 0, 1, {0}};
+
+    FILE *arq = fopen(nome, "rb");
+    if (!arq)
+        return;
+    unsigned char bytes[TAMANHO_CABECALHO];
+    size_t lidos = fread(bytes, 1, sizeof(bytes), arq);
+    fclose(arq);
+    if (lidos > 0)
+        decodificarCabecalho(nome, bytes, lidos, tipo, c);
+}
+
+/*
+ * Função: mapearArquivo
+ * Objetivo: Mapear um arquivo inteiro em memória, somente leitura
+ * Parâmetros: nome - nome do arquivo
+ *             tamanho - bytes mapeados
+ * Retorno: const unsigned char* - início do mapeamento (NULL se o arquivo não
+ *          existe ou está vazio)
+ */
+const unsigned char *mapearArquivo(const char *nome, size_t *tamanho)
+{
+    *tamanho = 0;
+#ifdef _WIN32
+    HANDLE arquivo = CreateFileA(nome, GENERIC_READ,
+                                 FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                 NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (arquivo == INVALID_HANDLE_VALUE)
+        return NULL;
+    LARGE_INTEGER bytes;
+    const unsigned char *mapa = NULL;
+    if (GetFileSizeEx(arquivo, &bytes) && bytes.QuadPart > 0)
     {
-        int codigo;
-        printf("Digite o codigo do cliente: ");
-        scanf("%d", &codigo);
-        limparEntrada();
-        
-        // Percorre arquivo procurando cliente com código especificado
-        while (fread(&c, sizeof(Cliente), 1, arquivo))
+        HANDLE mapeamento = CreateFileMappingA(arquivo, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapeamento)
         {
-            if (c.codigoCliente == codigo)
-            {
-                printf("\n=== CLIENTE ENCONTRADO ===\n");
-                printf("Codigo: %d\n", c.codigoCliente);
-                printf("Nome: %s\n", c.nome);
-                printf("Endereco: %s\n", c.endereco);
-                printf("Telefone: %s\n", c.telefone);
-                encontrou = 1;
-                break;  // Encontrou, pode parar busca
-            }
+            mapa = MapViewOfFile(mapeamento, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapeamento);  // A visão continua válida
         }
+        if (mapa)
+            *tamanho = (size_t)bytes.QuadPart;
     }
-    // Busca por nome (parcial)
-    else if (opcao == 2)
+    CloseHandle(arquivo);
+    return mapa;
+#else
+    int fd = open(nome, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+    struct stat info;
+    const unsigned char *mapa = NULL;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
     {
-        char nomeBusca[50];
-        printf("Digite o nome (ou parte do nome) do cliente: ");
-        fgets(nomeBusca, 50, stdin);
-        nomeBusca[strcspn(nomeBusca, "\n")] = 0;  // Remove \n do final
-        
-        printf("\n=== RESULTADOS DA PESQUISA ===\n");
-        // Percorre todos os clientes
-        while (fread(&c, sizeof(Cliente), 1, arquivo))
+        void *m = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (m != MAP_FAILED)
         {
-            // Verifica se o nome buscado está contido no nome do cliente
-            // strstr retorna ponteiro se encontrar substring, NULL se não
-            if (strstr(c.nome, nomeBusca) != NULL)
-            {
-                printf("\nCodigo: %d\n", c.codigoCliente);
-                printf("Nome: %s\n", c.nome);
-                printf("Endereco: %s\n", c.endereco);
-                printf("Telefone: %s\n", c.telefone);
-                printf("-------------------\n");
-                encontrou = 1;
-            }
+            mapa = m;
+            *tamanho = (size_t)info.st_size;
         }
     }
-    else
-    {
-        printf("Opcao invalida!\n");
-        fclose(arquivo);
+    close(fd);  // O mapeamento continua válido
+    return mapa;
+#endif
+}
+
+/*
+ * Função: desmapearArquivo
+ * Objetivo: Desfazer o mapeamento de mapearArquivo
+ */
+void desmapearArquivo(const unsigned char *mapa, size_t tamanho)
+{
+    if (!mapa)
         return;
-    }
-    
-    fclose(arquivo);
-    
-    // Mensagem se não encontrou - cliente
-    if (!encontrou)
-        printf("Cliente nao encontrado.\n");
-    
-    // Pausa para usuário ver resultados
-    printf("\nPressione ENTER para voltar ao menu...");
-    getchar();
+#ifdef _WIN32
+    (void)tamanho;
+    UnmapViewOfFile(mapa);
+#else
+    munmap((void *)mapa, tamanho);
+#endif
 }
 
 /*
- * Função: pesquisarFuncionario
- * Objetivo: Pesquisar funcionário por código ou nome
- *           Funcionamento similar a pesquisarCliente
- * Parâmetros: -
- * Retorno: void
+ * Blocos que não conferiram na carga. Ficam aqui até o diário ser reaplicado:
+ * uma gravação interrompida por queda é refeita por ele e o bloco volta a
+ * conferir; o que continuar errado é dano real e é avisado.
  */
-void pesquisarFuncionario()
+#define MAX_BLOCOS_SUSPEITOS 64
+
+typedef struct
 {
-    int opcao;
-    printf("\n=== PESQUISAR FUNCIONARIO ===\n");
-    printf("1 - Pesquisar por codigo\n");
-    printf("2 - Pesquisar por nome\n");
-    printf("Opcao: ");
-    scanf("%d", &opcao);
-    limparEntrada();
-    
-    FILE *arquivo = fopen(ARQ_FUNCIONARIOS, "rb");
-    if (!arquivo)
+    const char *nome;  // Arquivo (um dos ARQ_*)
+    int tipo;
+    int bloco;
+} BlocoSuspeito;
+
+BlocoSuspeito blocosSuspeitos[MAX_BLOCOS_SUSPEITOS];
+int totalBlocosSuspeitos = 0;
+
+/*
+ * Função: blocoConfere
+ * Objetivo: Conferir o CRC32C de um bloco mapeado
+ * Parâmetros: mapa, tamanho - arquivo mapeado
+ *             tipo - REGISTRO_*
+ *             bloco - índice do bloco
+ *             esperados - registros que o cabeçalho do arquivo atribui ao bloco
+ * Retorno: int - 1 se o bloco está íntegro
+ */
+int blocoConfere(const unsigned char *mapa, size_t tamanho, int tipo, int bloco, int esperados)
+{
+    long inicio = deslocamentoBloco(tipo, bloco);
+    if ((size_t)inicio + TAMANHO_CABECALHO_BLOCO > tamanho)
+        return 0;
+    const unsigned char *cabecalho = mapa + inicio;
+    unsigned int gravados = lerPalavra(cabecalho + 4);
+    if (gravados < (unsigned int)esperados || gravados > REGISTROS_POR_BLOCO ||
+        (size_t)inicio + TAMANHO_CABECALHO_BLOCO + gravados * (size_t)tamanhoNoDisco(tipo) > tamanho)
+        return 0;
+    return lerPalavra(cabecalho) ==
+           continuarCrc32c(0, cabecalho + TAMANHO_CABECALHO_BLOCO, gravados * (size_t)tamanhoNoDisco(tipo));
+}
+
+/*
+ * Função: lerRegistros
+ * Objetivo: Decodificar os registros de um arquivo a partir de um índice
+ *           Lê do arquivo mapeado, mas devolve uma cópia decodificada (ver
+ *           no início da seção por que os registros não ficam no mapeamento)
+ * Parâmetros: nome - nome do arquivo
+ *             tipo - REGISTRO_*
+ *             primeiro - índice do primeiro registro a ler
+ *             quantidade - ponteiro para a quantidade lida
+ *             conferir - 1 para conferir o CRC32C dos blocos lidos
+ * Retorno: void* - vetor alocado com os registros (NULL se não há nenhum)
+ */
+void *lerRegistros(const char *nome, int tipo, int primeiro, int *quantidade, int conferir)
+{
+    *quantidade = 0;
+    size_t bytes;
+    const unsigned char *mapa = mapearArquivo(nome, &bytes);
+    if (!mapa)
+        return NULL;  // Arquivo ainda não existe
+
+    CabecalhoArquivo cabecalho;
+    decodificarCabecalho(nome, mapa, bytes, tipo, &cabecalho);
+    int total = cabecalho.total;
+    int tamanho = tamanhoNoDisco(tipo);
+    while (total > 0 && (size_t)deslocamentoRegistro(tipo, total - 1) + (size_t)tamanho > bytes)
+        total--;  // Arquivo truncado: lê só o que existe (o bloco não vai conferir)
+    if (primeiro >= total)
     {
-        printf("Nenhum funcionario cadastrado.\n");
-        return;
+        desmapearArquivo(mapa, bytes);
+        return NULL;
     }
-    
-    Funcionario func;
-    int encontrou = 0;
-    
-    if (opcao == 1)
+
+    size_t tamanhoStruct = tamanhoNaMemoria(tipo);
+    char *vetor = malloc((size_t)(total - primeiro) * tamanhoStruct);
+    if (!vetor)
     {
-        int codigo;
-        printf("Digite o codigo do funcionario: ");
-        scanf("%d", &codigo);
-        limparEntrada();
-        
-        while (fread(&func, sizeof(Funcionario), 1, arquivo))
-        {
-            if (func.codigoFuncionario == codigo)
-            {
-                printf("\n=== FUNCIONARIO ENCONTRADO ===\n");
-                printf("Codigo: %d\n", func.codigoFuncionario);
-                printf("Nome: %s\n", func.nome);
-                printf("Telefone: %s\n", func.telefone);
-                printf("Cargo: %s\n", func.cargo);
-                printf("Salario: R$ %.2f\n", func.salario);
-                encontrou = 1;
-                break;
-            }
-        }
+        printf("Erro: memoria insuficiente.\n");
+        exit(1);
     }
-    else if (opcao == 2)
+    for (int bloco = primeiro / REGISTROS_POR_BLOCO; bloco * REGISTROS_POR_BLOCO < total; bloco++)
     {
-        char nomeBusca[50];
-        printf("Digite o nome (ou parte do nome) do funcionario: ");
-        fgets(nomeBusca, 50, stdin);
-        nomeBusca[strcspn(nomeBusca, "\n")] = 0;
-        
-        printf("\n=== RESULTADOS DA PESQUISA ===\n");
-        while (fread(&func, sizeof(Funcionario), 1, arquivo))
-        {
-            if (strstr(func.nome, nomeBusca) != NULL)
-            {
-                printf("\nCodigo: %d\n", func.codigoFuncionario);
-                printf("Nome: %s\n", func.nome);
-                printf("Telefone: %s\n", func.telefone);
-                printf("Cargo: %s\n", func.cargo);
-                printf("Salario: R$ %.2f\n", func.salario);
-                printf("-------------------\n");
-                encontrou = 1;
-            }
-        }
+        int inicio = bloco * REGISTROS_POR_BLOCO;
+        int fim = total - inicio < REGISTROS_POR_BLOCO ? total : inicio + REGISTROS_POR_BLOCO;
+        if (conferir && !blocoConfere(mapa, bytes, tipo, bloco, cabecalho.total - inicio < REGISTROS_POR_BLOCO
+                                                                   ? cabecalho.total - inicio
+                                                                   : REGISTROS_POR_BLOCO) &&
+            totalBlocosSuspeitos < MAX_BLOCOS_SUSPEITOS)
+            blocosSuspeitos[totalBlocosSuspeitos++] = (BlocoSuspeito){nome, tipo, bloco};
+
+        const unsigned char *registro = mapa + deslocamentoRegistro(tipo, inicio > primeiro ? inicio : primeiro);
+        for (int i = inicio > primeiro ? inicio : primeiro; i < fim; i++, registro += tamanho)
+            decodificarRegistro(tipo, registro, vetor + (size_t)(i - primeiro) * tamanhoStruct);
     }
-    else
+    desmapearArquivo(mapa, bytes);
+    *quantidade = total - primeiro;
+    return vetor;
+}
+
+/*
+ * Função: lerArquivoAntigo
+ * Objetivo: Ler um arquivo de versões anteriores (cópia direta das structs,
+ *           sem cabeçalho)
+ * Parâmetros: nome - nome do arquivo de dados
+ *             tipo - REGISTRO_* (tamanho da struct)
+ *             registros - ponteiro para a quantidade lida
+ * Retorno: void* - vetor com os registros (NULL se o arquivo não existe,
+ *          está vazio ou já tem cabeçalho)
+ */
+void *lerArquivoAntigo(const char *nome, int tipo, int *registros)
+{
+    *registros = 0;
+    FILE *arq = fopen(nome, "rb");
+    if (!arq)
+        return NULL;
+    unsigned char inicio[8];
+    size_t lidos = fread(inicio, 1, sizeof(inicio), arq);
+    if (lidos == 0 || temAssinatura(inicio, lidos))
     {
-        printf("Opcao invalida!\n");
-        fclose(arquivo);
-        return;
+        fclose(arq);
+        return NULL;  // Vazio ou já no formato atual
     }
-    
-    fclose(arquivo);
-    
-    if (!encontrou)
-        printf("Funcionario nao encontrado.\n");
-    
-    printf("\nPressione ENTER para voltar ao menu...");
-    getchar();
+
+    fseek(arq, 0, SEEK_END);
+    long bytes = ftell(arq);
+    fseek(arq, 0, SEEK_SET);
+    int total = (int)(bytes / (long)tamanhoNaMemoria(tipo));  // Ignora registro incompleto
+    int capacidade = 0;
+    void *vetor = garantirCapacidade(NULL, &capacidade, total > 0 ? total : 1, tamanhoNaMemoria(tipo));
+    *registros = (int)fread(vetor, tamanhoNaMemoria(tipo), (size_t)total, arq);
+    fclose(arq);
+    return vetor;
 }
 
-// ============================================================
-// FUNÇÃO PARA MOSTRAR ESTADIAS DE UM CLIENTE
-// ============================================================
+/*
+ * Função: carregarArquivo
+ * Objetivo: Ler um arquivo de dados inteiro para um vetor em memória,
+ *           conferindo todos os blocos
+ *           Só lendo (somenteLeitura), um arquivo de versão anterior é
+ *           lido como está, em vez de convertido
+ * Parâmetros: nome - nome do arquivo
+ *             tipo - REGISTRO_*
+ *             total - ponteiro para quantidade de registros lidos
+ *             capacidade - ponteiro para capacidade alocada
+ * Retorno: void* - vetor com os registros (NULL se arquivo vazio/inexistente)
+ */
+void *carregarArquivo(const char *nome, int tipo, int *total, int *capacidade)
+{
+    void *vetor = somenteLeitura ? lerArquivoAntigo(nome, tipo, total) : NULL;
+    if (!vetor)
+        vetor = lerRegistros(nome, tipo, 0, total, 1);
+    *capacidade = *total;
+    return vetor;
+}
 
 /*
- * Função: mostrarEstadiasCliente
- * Objetivo: Mostrar todas as estadias de um cliente específico
- *           Permite busca por código ou nome do cliente
- * Parâmetros: -
- * Retorno: void
+ * Função: conferirBlocosSuspeitos
+ * Objetivo: Conferir de novo, depois da reaplicação do diário, os blocos que
+ *           falharam na carga e avisar os que continuam danificados
+ * Parâmetros: nenhum
+ * Retorno: int - quantidade de blocos danificados
  */
-void mostrarEstadiasCliente()
+int conferirBlocosSuspeitos()
 {
-    int opcao;
-    printf("\n=== PESQUISAR ESTADIAS POR CLIENTE ===\n");
-    printf("1 - Pesquisar por codigo do cliente\n");
-    printf("2 - Pesquisar por nome do cliente\n");
-    printf("Opcao: ");
-    scanf("%d", &opcao);
-    limparEntrada();
-    
-    int codigoCliente = -1;      // Código do cliente encontrado
-    char nomeCliente[50] = "";   // Nome do cliente
-    
-    // Busca por código
-    if (opcao == 1)
+    int danificados = 0;
+    for (int i = 0; i < totalBlocosSuspeitos; i++)
     {
-        printf("Digite o codigo do cliente: ");
-        scanf("%d", &codigoCliente);
-        limparEntrada();
-        
-        // Verificar se o cliente existe
-        Cliente c;
-        if (!buscarCliente(codigoCliente, &c))
+        BlocoSuspeito *s = &blocosSuspeitos[i];
+        size_t bytes;
+        const unsigned char *mapa = mapearArquivo(s->nome, &bytes);
+        CabecalhoArquivo cabecalho = {s->tipo, 0, 1, {0}};
+        if (mapa)
+            decodificarCabecalho(s->nome, mapa, bytes, s->tipo, &cabecalho);
+        int inicio = s->bloco * REGISTROS_POR_BLOCO;
+        int esperados = cabecalho.total - inicio < REGISTROS_POR_BLOCO ? cabecalho.total - inicio
+                                                                        : REGISTROS_POR_BLOCO;
+        if (esperados > 0 && !blocoConfere(mapa, bytes, s->tipo, s->bloco, esperados))
         {
-            printf("Cliente nao encontrado.\n");
+            fprintf(stderr, "Aviso: %s, registros %d a %d: soma de verificacao nao confere "
+                            "(arquivo danificado).\n",
+                    s->nome, inicio + 1, inicio + esperados);
+            danificados++;
+        }
+        desmapearArquivo(mapa, bytes);
+    }
+    totalBlocosSuspeitos = 0;
+    return danificados;
+}
+
+/*
+ * Escrita sequencial de registros, bloco a bloco. O cabeçalho de cada bloco
+ * é gravado quando ele se completa (ou em fecharEscrita) e o do arquivo só
+ * em fecharEscrita, depois de todos os registros.
+ */
+typedef struct
+{
+    FILE *arquivo;
+    CabecalhoArquivo cabecalho;
+    unsigned int somaBloco;   // CRC32C dos registros do bloco atual
+    int noBloco;              // Registros no bloco atual
+} EscritaRegistros;
+
+/*
+ * Função: fecharBloco
+ * Objetivo: Gravar o cabeçalho do bloco em que está o último registro escrito
+ */
+int fecharBloco(EscritaRegistros *e)
+{
+    unsigned char bytes[TAMANHO_CABECALHO_BLOCO] = {0};
+    escreverPalavra(bytes, e->somaBloco);
+    escreverPalavra(bytes + 4, (unsigned int)e->noBloco);
+    int bloco = (e->cabecalho.total - 1) / REGISTROS_POR_BLOCO;
+    return fseek(e->arquivo, deslocamentoBloco(e->cabecalho.tipo, bloco), SEEK_SET) == 0 &&
+           fwrite(bytes, sizeof(bytes), 1, e->arquivo) == 1;
+}
+
+/*
+ * Função: abrirEscrita
+ * Objetivo: Preparar a escrita de registros num arquivo de dados
+ * Parâmetros: e - estado da escrita
+ *             nome - nome do arquivo (criado se não existir)
+ *             tipo - REGISTRO_*
+ *             inicio - índice do primeiro registro a escrever: -1 acrescenta
+ *                      no fim, 0 recria o arquivo; registros a partir de
+ *                      inicio deixam de existir
+ * Retorno: int - 1 se abriu, 0 em caso de erro
+ */
+int abrirEscrita(EscritaRegistros *e, const char *nome, int tipo, int inicio)
+{
+    memset(e, 0, sizeof(*e));
+    e->cabecalho = (CabecalhoArquivo){tipo, 0, 1, {0}};
+    e->arquivo = inicio == 0 ? NULL : fopen(nome, "r+b");  // Leitura/escrita sem truncar
+    if (!e->arquivo)
+        e->arquivo = fopen(nome, "w+b");
+    if (!e->arquivo)
+        return 0;
+
+    unsigned char bytes[TAMANHO_CABECALHO];
+    size_t lidos = fread(bytes, 1, sizeof(bytes), e->arquivo);
+    if (lidos > 0)
+        decodificarCabecalho(nome, bytes, lidos, tipo, &e->cabecalho);
+    if (inicio < 0 || inicio > e->cabecalho.total)
+        inicio = e->cabecalho.total;
+    e->cabecalho.total = inicio;
+
+    // Bloco começado: a soma continua dos registros que já estão nele
+    e->noBloco = inicio % REGISTROS_POR_BLOCO;
+    if (e->noBloco > 0)
+    {
+        size_t tamanho = (size_t)e->noBloco * tamanhoNoDisco(tipo);
+        unsigned char *registros = malloc(tamanho);
+        int ok = registros &&
+                 fseek(e->arquivo, deslocamentoRegistro(tipo, inicio - e->noBloco), SEEK_SET) == 0 &&
+                 fread(registros, tamanho, 1, e->arquivo) == 1;
+        if (ok)
+            e->somaBloco = continuarCrc32c(0, registros, tamanho);
+        free(registros);
+        if (!ok)
+        {
+            fclose(e->arquivo);
+            return 0;
+        }
+    }
+    if (fseek(e->arquivo, deslocamentoRegistro(tipo, inicio), SEEK_SET) != 0)
+    {
+        fclose(e->arquivo);
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ * Função: escreverRegistro
+ * Objetivo: Escrever o próximo registro
+ * Parâmetros: e - estado da escrita
+ *             registro - struct do tipo do arquivo
+ * Retorno: int - 1 se escreveu, 0 em caso de erro
+ */
+int escreverRegistro(EscritaRegistros *e, const void *registro)
+{
+    int tipo = e->cabecalho.tipo;
+    int tamanho = tamanhoNoDisco(tipo);
+    unsigned char bytes[TAMANHO_MAXIMO_REGISTRO];
+    codificarRegistro(tipo, registro, bytes);
+    if (fwrite(bytes, (size_t)tamanho, 1, e->arquivo) != 1)
+        return 0;
+
+    e->somaBloco = continuarCrc32c(e->somaBloco, bytes, (size_t)tamanho);
+    e->noBloco++;
+    e->cabecalho.total++;
+    int codigo = codigoDoRegistro(tipo, registro);
+    if (codigo >= e->cabecalho.proximoCodigo)
+        e->cabecalho.proximoCodigo = codigo + 1;
+
+    if (e->noBloco == REGISTROS_POR_BLOCO)
+    {
+        // Bloco cheio: grava o cabeçalho e volta ao ponto de escrita
+        if (!fecharBloco(e) ||
+            fseek(e->arquivo, deslocamentoRegistro(tipo, e->cabecalho.total), SEEK_SET) != 0)
+            return 0;
+        e->somaBloco = 0;
+        e->noBloco = 0;
+    }
+    return 1;
+}
+
+/*
+ * Função: fecharEscrita
+ * Objetivo: Gravar os cabeçalhos pendentes e fechar o arquivo
+ * Parâmetros: e - estado da escrita
+ *             sincronizar - 1 para forçar a gravação no disco
+ * Retorno: int - 1 se tudo foi gravado, 0 em caso de erro
+ */
+int fecharEscrita(EscritaRegistros *e, int sincronizar)
+{
+    unsigned char bytes[TAMANHO_CABECALHO];
+    codificarCabecalho(&e->cabecalho, bytes);
+    int ok = (e->noBloco == 0 || fecharBloco(e)) &&
+             fseek(e->arquivo, 0, SEEK_SET) == 0 &&
+             fwrite(bytes, sizeof(bytes), 1, e->arquivo) == 1 &&
+             fflush(e->arquivo) == 0;
+    if (sincronizar)
+        ok = sincronizarArquivo(e->arquivo) && ok;
+    return fclose(e->arquivo) == 0 && ok;
+}
+
+/*
+ * Função: gravarNoFim
+ * Objetivo: Acrescentar um registro ao final de um arquivo de dados
+ * Parâmetros: nome - nome do arquivo de dados
+ *             tipo - REGISTRO_*
+ *             dados - registro a gravar
+ * Retorno: int - 1 se gravou, 0 em caso de erro
+ */
+int gravarNoFim(const char *nome, int tipo, const void *dados)
+{
+    if (somenteLeitura)
+        return 1;  // Operação reaplicada só na memória
+
+    EscritaRegistros escrita;
+    if (!abrirEscrita(&escrita, nome, tipo, -1))
+        return 0;
+    int ok = escreverRegistro(&escrita, dados);
+    return fecharEscrita(&escrita, 0) && ok;
+}
+
+/*
+ * Função: gravarArquivo
+ * Objetivo: Recriar um arquivo de dados com todos os registros de um vetor
+ * Parâmetros: nome - nome do arquivo de dados
+ *             tipo - REGISTRO_*
+ *             vetor, total - registros a gravar
+ * Retorno: int - 1 se gravou, 0 em caso de erro
+ */
+int gravarArquivo(const char *nome, int tipo, const void *vetor, int total)
+{
+    EscritaRegistros escrita;
+    if (!abrirEscrita(&escrita, nome, tipo, 0))
+        return 0;
+    int ok = 1;
+    for (int i = 0; i < total && ok; i++)
+        ok = escreverRegistro(&escrita, (const char *)vetor + (size_t)i * tamanhoNaMemoria(tipo));
+    return fecharEscrita(&escrita, 0) && ok;
+}
+
+/*
+ * Função: lerArquivoRecriavel
+ * Objetivo: Ler por inteiro um arquivo que o programa sabe recriar (livro
+ *           de fidelidade, sequências): ao contrário de lerRegistros, um
+ *           cabeçalho ou bloco que não confere não encerra o programa,
+ *           só faz o arquivo inteiro ser tratado como ausente
+ * Parâmetros: nome - nome do arquivo
+ *             tipo - REGISTRO_*
+ *             c - cabeçalho lido
+ *             quantidade - ponteiro para a quantidade de registros lidos
+ * Retorno: void* - vetor alocado com os registros (NULL se o arquivo não
+ *          existe, é de versão anterior ou não confere)
+ */
+void *lerArquivoRecriavel(const char *nome, int tipo, CabecalhoArquivo *c, int *quantidade)
+{
+    *quantidade = 0;
+    size_t bytes;
+    const unsigned char *mapa = mapearArquivo(nome, &bytes);
+    if (!mapa)
+        return NULL;
+
+    char *vetor = NULL;
+    if (conferirCabecalho(mapa, bytes, tipo, c) == 0 && c->total >= 0)
+    {
+        size_t tamanhoStruct = tamanhoNaMemoria(tipo);
+        vetor = malloc((size_t)(c->total > 0 ? c->total : 1) * tamanhoStruct);
+        int ok = vetor != NULL;
+        for (int bloco = 0; ok && bloco * REGISTROS_POR_BLOCO < c->total; bloco++)
+        {
+            int inicio = bloco * REGISTROS_POR_BLOCO;
+            int noBloco = c->total - inicio < REGISTROS_POR_BLOCO ? c->total - inicio : REGISTROS_POR_BLOCO;
+            ok = blocoConfere(mapa, bytes, tipo, bloco, noBloco);
+            for (int i = inicio; ok && i < inicio + noBloco; i++)
+                decodificarRegistro(tipo, mapa + deslocamentoRegistro(tipo, i), vetor + (size_t)i * tamanhoStruct);
+        }
+        if (ok)
+            *quantidade = c->total;
+        else
+        {
+            free(vetor);
+            vetor = NULL;
+        }
+    }
+    desmapearArquivo(mapa, bytes);
+    return vetor;
+}
+
+/*
+ * Função: gravarTrocando
+ * Objetivo: Gravar um arquivo inteiro numa cópia nova, levá-la ao disco e
+ *           só então colocá-la no lugar do arquivo: uma queda ou um disco
+ *           cheio deixam o arquivo anterior intacto
+ * Parâmetros: nome - arquivo a substituir
+ *             novo - nome da cópia em gravação
+ *             modelo - tipo e palavras próprias do tipo para o cabeçalho
+ *             vetor, total - registros a gravar
+ * Retorno: int - 1 se o arquivo foi substituído, 0 em caso de erro
+ */
+int gravarTrocando(const char *nome, const char *novo, const CabecalhoArquivo *modelo,
+                   const void *vetor, int total)
+{
+    EscritaRegistros escrita;
+    if (!abrirEscrita(&escrita, novo, modelo->tipo, 0))
+        return 0;
+    memcpy(escrita.cabecalho.complemento, modelo->complemento, sizeof(modelo->complemento));
+    int ok = 1;
+    for (int i = 0; i < total && ok; i++)
+        ok = escreverRegistro(&escrita, (const char *)vetor + (size_t)i * tamanhoNaMemoria(modelo->tipo));
+    ok = fecharEscrita(&escrita, 1) && ok;
+    if (!ok || substituirArquivo(novo, nome) != 0)
+    {
+        remove(novo);
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ * Função: gravarRegistro
+ * Objetivo: Regravar um registro na sua posição no arquivo, sem regravar o
+ *           restante, e atualizar o CRC32C do bloco
+ *           A durabilidade vem do diário; o arquivo é sincronizado no checkpoint
+ * Parâmetros: nome - nome do arquivo de dados
+ *             tipo - REGISTRO_*
+ *             indice - posição do registro no arquivo
+ *             registro - novo conteúdo
+ * Retorno: int - 1 se gravou, 0 em caso de erro
+ */
+int gravarRegistro(const char *nome, int tipo, int indice, const void *registro)
+{
+    if (somenteLeitura)
+        return 1;  // Operação reaplicada só na memória
+
+    FILE *arq = fopen(nome, "r+b");  // Leitura/escrita sem truncar
+    if (!arq)
+        return 0;
+
+    int tamanho = tamanhoNoDisco(tipo);
+    long inicioBloco = deslocamentoBloco(tipo, indice / REGISTROS_POR_BLOCO);
+    unsigned char cabecalho[TAMANHO_CABECALHO_BLOCO];
+    unsigned char *registros = NULL;
+    int noBloco = 0;
+    int ok = fseek(arq, inicioBloco, SEEK_SET) == 0 &&
+             fread(cabecalho, sizeof(cabecalho), 1, arq) == 1;
+    if (ok)
+    {
+        noBloco = (int)lerPalavra(cabecalho + 4);
+        ok = noBloco > indice % REGISTROS_POR_BLOCO && noBloco <= REGISTROS_POR_BLOCO &&
+             (registros = malloc((size_t)noBloco * tamanho)) != NULL &&
+             fread(registros, (size_t)tamanho, (size_t)noBloco, arq) == (size_t)noBloco;
+    }
+    if (ok)
+    {
+        // Novo registro no meio do bloco e soma do bloco inteiro recalculada
+        unsigned char *destino = registros + (size_t)(indice % REGISTROS_POR_BLOCO) * tamanho;
+        codificarRegistro(tipo, registro, destino);
+        escreverPalavra(cabecalho, continuarCrc32c(0, registros, (size_t)noBloco * tamanho));
+        ok = fseek(arq, deslocamentoRegistro(tipo, indice), SEEK_SET) == 0 &&
+             fwrite(destino, (size_t)tamanho, 1, arq) == 1 &&
+             fseek(arq, inicioBloco, SEEK_SET) == 0 &&
+             fwrite(cabecalho, sizeof(cabecalho), 1, arq) == 1;
+    }
+    free(registros);
+    return fclose(arq) == 0 && ok;
+}
+
+/*
+ * Função: converterArquivoAntigo
+ * Objetivo: Converter um arquivo de versões anteriores para o formato atual
+ *           Grava uma cópia convertida e a coloca no lugar do original
+ * Parâmetros: nome - nome do arquivo de dados
+ *             tipo - REGISTRO_*
+ * Retorno: int - 1 se o arquivo foi convertido
+ */
+int converterArquivoAntigo(const char *nome, int tipo)
+{
+    int registros;
+    void *vetor = lerArquivoAntigo(nome, tipo, &registros);
+    if (!vetor)
+        return 0;
+
+    char temporario[64];
+    snprintf(temporario, sizeof(temporario), "%s.convertendo", nome);
+    EscritaRegistros escrita;
+    int ok = abrirEscrita(&escrita, temporario, tipo, 0);
+    for (int i = 0; i < registros && ok; i++)
+        ok = escreverRegistro(&escrita, (char *)vetor + (size_t)i * tamanhoNaMemoria(tipo));
+    ok = ok && fecharEscrita(&escrita, 1) && substituirArquivo(temporario, nome) == 0;
+    free(vetor);
+    if (!ok)
+    {
+        printf("Erro: nao foi possivel converter %s para o formato atual.\n", nome);
+        exit(1);
+    }
+    fprintf(stderr, "%s convertido para o formato versao %d (%d registros).\n", nome, FORMATO_VERSAO, registros);
+    return 1;
+}
+
+// ============================================================
+// TRAVAS ENTRE PROCESSOS (ARQUIVO hotel.lock)
+// ============================================================
+
+/*
+ * Vários processos (recepções no menu, modo lote, importação, servidor)
+ * podem usar os mesmos arquivos ao mesmo tempo. Eles se coordenam por
+ * travas consultivas em bytes de ARQ_TRAVA, a partir de BYTE_TRAVA_DADOS:
+ *   byte BYTE_TRAVA_DADOS      - dados: compartilhada para ler os arquivos
+ *                                .bin, exclusiva para alterá-los
+ *   byte BYTE_TRAVA_DADOS+1+i  - posse do diário i (um diário por processo)
+ * Os 4 primeiros bytes do arquivo guardam a geração dos dados, somada a
+ * cada alteração; um processo que encontra uma geração diferente da última
+ * que viu lê dos arquivos o que os outros gravaram (acompanharArquivos).
+ * As travas ficam fora do trecho da geração porque no Windows elas
+ * impedem a leitura dos bytes travados. O sistema libera as travas de um
+ * processo que termina, então uma queda nunca deixa os dados travados.
+ */
+#define TRAVA_LIVRE         0
+#define TRAVA_COMPARTILHADA 1
+#define TRAVA_EXCLUSIVA     2
+#define BYTE_TRAVA_DADOS    1024
+#define MAX_DIARIOS         16   // Processos que podem alterar os dados ao mesmo tempo
+
+const char *ARQ_TRAVA = "hotel.lock";
+
+int descritorTrava = -1;            // ARQ_TRAVA aberto (nunca fechado: no POSIX
+                                    // fechar qualquer descritor solta as travas)
+unsigned int geracaoConhecida = 0;  // Geração dos dados já refletida na memória
+
+/*
+ * Função: travarByte
+ * Objetivo: Travar ou destravar um byte do arquivo de travas
+ * Parâmetros: byte - posição do byte
+ *             modo - TRAVA_LIVRE, TRAVA_COMPARTILHADA ou TRAVA_EXCLUSIVA
+ *             esperar - 1 para esperar a trava, 0 para desistir se ocupada
+ * Retorno: int - 1 se a trava foi obtida (ou solta), 0 caso contrário
+ */
+int travarByte(int byte, int modo, int esperar)
+{
+    if (descritorTrava < 0)
+        descritorTrava = somenteLeitura ? abrirDescritorExistente(ARQ_TRAVA) : abrirDescritor(ARQ_TRAVA);
+    if (descritorTrava < 0)
+        return 1;  // Diretório sem escrita (ou nunca usado): segue sem coordenação
+
+#ifdef _WIN32
+    HANDLE arquivo = (HANDLE)_get_osfhandle(descritorTrava);
+    OVERLAPPED posicao;
+    memset(&posicao, 0, sizeof(posicao));
+    posicao.Offset = (DWORD)byte;
+    if (modo == TRAVA_LIVRE)
+        return UnlockFileEx(arquivo, 0, 1, 0, &posicao) != 0;
+    DWORD opcoes = (modo == TRAVA_EXCLUSIVA ? LOCKFILE_EXCLUSIVE_LOCK : 0) |
+                   (esperar ? 0 : LOCKFILE_FAIL_IMMEDIATELY);
+    return LockFileEx(arquivo, opcoes, 0, 1, 0, &posicao) != 0;
+#else
+    struct flock trava;
+    memset(&trava, 0, sizeof(trava));
+    trava.l_type = modo == TRAVA_EXCLUSIVA ? F_WRLCK : modo == TRAVA_COMPARTILHADA ? F_RDLCK : F_UNLCK;
+    trava.l_whence = SEEK_SET;
+    trava.l_start = byte;
+    trava.l_len = 1;
+
+    int resultado;
+    do
+        resultado = fcntl(descritorTrava, esperar ? F_SETLKW : F_SETLK, &trava);
+    while (resultado != 0 && errno == EINTR);  // Sinal durante a espera
+    return resultado == 0;
+#endif
+}
+
+/*
+ * Função: travarDados
+ * Objetivo: Obter (esperando) ou soltar a trava dos arquivos de dados
+ *           Para trocar de modo é preciso soltar antes: duas trocas de
+ *           compartilhada para exclusiva ao mesmo tempo se bloqueariam
+ * Parâmetros: modo - TRAVA_LIVRE, TRAVA_COMPARTILHADA ou TRAVA_EXCLUSIVA
+ * Retorno: void
+ */
+void travarDados(int modo)
+{
+    travarByte(BYTE_TRAVA_DADOS, modo, 1);
+}
+
+/*
+ * Função: lerGeracao
+ * Objetivo: Ler a geração atual dos dados no arquivo de travas
+ * Parâmetros: -
+ * Retorno: unsigned int - geração (0 se o arquivo ainda está vazio)
+ */
+unsigned int lerGeracao()
+{
+    unsigned int geracao = 0;
+    if (descritorTrava < 0)
+        return 0;
+#ifdef _WIN32
+    // Leitura na posição 0 sem mexer na posição do descritor, como o pread
+    HANDLE arquivo = (HANDLE)_get_osfhandle(descritorTrava);
+    OVERLAPPED posicao;
+    memset(&posicao, 0, sizeof(posicao));
+    DWORD lidos = 0;
+    if (!ReadFile(arquivo, &geracao, sizeof(geracao), &lidos, &posicao) || lidos != sizeof(geracao))
+        geracao = 0;
+#else
+    // pread não mexe na posição do descritor: seguro entre threads
+    if (pread(descritorTrava, &geracao, sizeof(geracao), 0) != (ssize_t)sizeof(geracao))
+        geracao = 0;
+#endif
+    return geracao;
+}
+
+/*
+ * Função: gravarGeracao
+ * Objetivo: Gravar a nova geração dos dados (com a trava exclusiva)
+ * Parâmetros: geracao - geração a gravar
+ * Retorno: void
+ */
+void gravarGeracao(unsigned int geracao)
+{
+    if (descritorTrava < 0)
+        return;
+#ifdef _WIN32
+    HANDLE arquivo = (HANDLE)_get_osfhandle(descritorTrava);
+    OVERLAPPED posicao;
+    memset(&posicao, 0, sizeof(posicao));
+    DWORD gravados;
+    WriteFile(arquivo, &geracao, sizeof(geracao), &gravados, &posicao);  // Falha: os outros só deixam de notar
+#else
+    if (pwrite(descritorTrava, &geracao, sizeof(geracao), 0) != (ssize_t)sizeof(geracao))
+        return;  // Os outros processos apenas deixam de notar esta alteração
+#endif
+}
+
+// ============================================================
+// ÍNDICE HASH POR CÓDIGO
+// ============================================================
+
+/*
+ * Índice hash com endereçamento aberto (sondagem linear)
+ * Mapeia um código (sempre positivo) para a posição do registro na tabela
+ * em memória; a mesma posição vezes o tamanho do registro é o deslocamento
+ * dele no arquivo
+ */
+typedef struct
+{
+    int *chaves;      // Código guardado em cada posição (0 = posição vazia)
+    int *posicoes;    // Posição do registro na tabela de dados
+    int capacidade;   // Quantidade de posições (sempre potência de 2)
+    int quantidade;   // Quantidade de chaves inseridas
+} IndiceHash;
+
+IndiceHash indiceClientes = {NULL, NULL, 0, 0};  // codigoCliente -> posição
+IndiceHash indiceEstadias = {NULL, NULL, 0, 0};  // codigoEstadia -> posição
+IndiceHash primeiraEstadiaCliente = {NULL, NULL, 0, 0};  // codigoCliente -> primeira estadia
+IndiceHash ultimaEstadiaCliente = {NULL, NULL, 0, 0};    // codigoCliente -> última estadia
+
+/*
+ * Função: hashCodigo
+ * Objetivo: Espalhar códigos sequenciais pelas posições do índice
+ * Parâmetros: chave - código a espalhar
+ *             mascara - capacidade do índice menos 1
+ * Retorno: int - posição inicial da sondagem
+ */
+int hashCodigo(int chave, int mascara)
+{
+    unsigned int h = (unsigned int)chave * 2654435761u;  // Hash multiplicativo (Knuth)
+    return (int)((h ^ (h >> 16)) & (unsigned int)mascara);
+}
+
+/*
+ * Função: indiceInserir
+ * Objetivo: Inserir (ou atualizar) a posição associada a um código
+ *           Dobra o índice quando a ocupação passa de 50%
+ * Parâmetros: indice - índice a alterar
+ *             chave - código do registro (> 0)
+ *             posicao - posição do registro na tabela
+ * Retorno: void
+ */
+void indiceInserir(IndiceHash *indice, int chave, int posicao)
+{
+    if ((indice->quantidade + 1) * 2 > indice->capacidade)
+    {
+        // Reconstrói com o dobro de posições
+        IndiceHash novo;
+        novo.capacidade = indice->capacidade > 0 ? indice->capacidade * 2 : 1024;
+        novo.quantidade = 0;
+        novo.chaves = calloc((size_t)novo.capacidade, sizeof(int));
+        novo.posicoes = malloc((size_t)novo.capacidade * sizeof(int));
+        if (!novo.chaves || !novo.posicoes)
+        {
+            printf("Erro: memoria insuficiente.\n");
+            exit(1);
+        }
+        for (int i = 0; i < indice->capacidade; i++)
+            if (indice->chaves[i] != 0)
+                indiceInserir(&novo, indice->chaves[i], indice->posicoes[i]);
+
+        free(indice->chaves);
+        free(indice->posicoes);
+        *indice = novo;
+    }
+
+    int mascara = indice->capacidade - 1;
+    int i = hashCodigo(chave, mascara);
+    while (indice->chaves[i] != 0 && indice->chaves[i] != chave)
+        i = (i + 1) & mascara;  // Sondagem linear
+
+    if (indice->chaves[i] == 0)
+        indice->quantidade++;
+    indice->chaves[i] = chave;
+    indice->posicoes[i] = posicao;
+}
+
+/*
+ * Função: indiceBuscar
+ * Objetivo: Obter a posição do registro com um código
+ * Parâmetros: indice - índice a consultar
+ *             chave - código procurado
+ * Retorno: int - posição na tabela, ou -1 se não existir
+ */
+int indiceBuscar(const IndiceHash *indice, int chave)
+{
+    if (indice->capacidade == 0 || chave <= 0)
+        return -1;
+
+    int mascara = indice->capacidade - 1;
+    int i = hashCodigo(chave, mascara);
+    while (indice->chaves[i] != 0)
+    {
+        if (indice->chaves[i] == chave)
+            return indice->posicoes[i];
+        i = (i + 1) & mascara;
+    }
+    return -1;  // Posição vazia: código não existe
+}
+
+// ============================================================
+// TABELA DE ENDEREÇAMENTO DIRETO DE QUARTOS
+// ============================================================
+
+/*
+ * Números de quarto são inteiros pequenos e densos (101, 102, ..., 1510),
+ * então a posição de cada quarto na tabela é guardada num vetor indexado
+ * diretamente pelo número. Para tolerar números esparsos o vetor é dividido
+ * em páginas de QUARTOS_POR_PAGINA entradas, alocadas só quando usadas.
+ */
+#define QUARTOS_POR_PAGINA 1024
+
+int **paginasQuartos = NULL;   // Páginas indexadas por numero / QUARTOS_POR_PAGINA
+int totalPaginasQuartos = 0;   // Quantidade de entradas no vetor de páginas
+
+/*
+ * Função: mapaQuartosDefinir
+ * Objetivo: Associar um número de quarto à sua posição na tabela
+ * Parâmetros: numero - número do quarto (> 0)
+ *             posicao - posição do quarto em tabelaQuartos
+ * Retorno: void
+ */
+void mapaQuartosDefinir(int numero, int posicao)
+{
+    int pagina = numero / QUARTOS_POR_PAGINA;
+
+    // Aumenta o vetor de páginas se o número estiver além do fim
+    if (pagina >= totalPaginasQuartos)
+    {
+        int novoTotal = pagina + 1;
+        int **novas = realloc(paginasQuartos, (size_t)novoTotal * sizeof(int *));
+        if (!novas)
+        {
+            printf("Erro: memoria insuficiente.\n");
+            exit(1);
+        }
+        for (int i = totalPaginasQuartos; i < novoTotal; i++)
+            novas[i] = NULL;  // Páginas ainda não usadas
+        paginasQuartos = novas;
+        totalPaginasQuartos = novoTotal;
+    }
+
+    if (!paginasQuartos[pagina])
+    {
+        paginasQuartos[pagina] = calloc(QUARTOS_POR_PAGINA, sizeof(int));
+        if (!paginasQuartos[pagina])
+        {
+            printf("Erro: memoria insuficiente.\n");
+            exit(1);
+        }
+    }
+
+    // Guarda posicao + 1 para que 0 signifique "quarto inexistente"
+    paginasQuartos[pagina][numero % QUARTOS_POR_PAGINA] = posicao + 1;
+}
+
+/*
+ * Função: mapaQuartosBuscar
+ * Objetivo: Obter a posição de um quarto na tabela pelo número
+ * Parâmetros: numero - número do quarto
+ * Retorno: int - posição em tabelaQuartos, ou -1 se não existir
+ */
+int mapaQuartosBuscar(int numero)
+{
+    if (numero <= 0)
+        return -1;
+
+    int pagina = numero / QUARTOS_POR_PAGINA;
+    if (pagina >= totalPaginasQuartos || !paginasQuartos[pagina])
+        return -1;
+
+    return paginasQuartos[pagina][numero % QUARTOS_POR_PAGINA] - 1;
+}
+
+// ============================================================
+// NOMES SEM DIFERENÇA DE MAIÚSCULAS E ACENTOS
+// ============================================================
+
+/*
+ * Para que "silva" encontre "Silva" e "joao" encontre "João", cada nome é
+ * guardado também numa coluna "dobrada": minúsculas, sem acentos, em
+ * posições de TAMANHO_DOBRADO bytes completadas com zeros. A pesquisa dobra
+ * o texto buscado do mesmo jeito e compara só com essa coluna.
+ * Acentos são reconhecidos em UTF-8 (C3 xx) e em Latin-1 (um byte).
+ */
+#define TAMANHO_DOBRADO 64   // Posição de cada nome dobrado (nome tem até 49 bytes)
+#define MAX_NOME 49          // Maior nome possível (campo de 50 bytes com \0)
+
+#if defined(__SSE2__)
+#include <emmintrin.h>       // SSE2 (presente em todo processador x86-64)
+#endif
+
+// Letra sem acento para os códigos Latin-1 0xC0-0xFF (\0 = manter o caractere)
+const char letrasSemAcento[64] =
+    "aaaaaaaceeeeiiiidnooooo\0ouuuuy\0s"
+    "aaaaaaaceeeeiiiidnooooo\0ouuuuy\0y";
+
+char (*nomesDobradosClientes)[TAMANHO_DOBRADO] = NULL;     // Um nome dobrado por cliente
+int capacidadeDobradosClientes = 0;
+char (*nomesDobradosFuncionarios)[TAMANHO_DOBRADO] = NULL; // Um nome dobrado por funcionário
+int capacidadeDobradosFuncionarios = 0;
+
+/*
+ * Função: dobrarTexto
+ * Objetivo: Converter um texto para minúsculas sem acentos
+ * Parâmetros: origem - texto original
+ *             tamanhoOrigem - limite de bytes lidos da origem
+ *             destino - texto dobrado (completado com zeros)
+ *             tamanhoDestino - tamanho do destino
+ * Retorno: int - tamanho do texto dobrado
+ */
+int dobrarTexto(const char *origem, size_t tamanhoOrigem, char *destino, size_t tamanhoDestino)
+{
+    size_t i = 0, n = 0;
+    memset(destino, 0, tamanhoDestino);
+
+    while (i < tamanhoOrigem && origem[i] != '\0' && n + 2 < tamanhoDestino)
+    {
+        unsigned char c = (unsigned char)origem[i];
+        unsigned char seguinte = i + 1 < tamanhoOrigem ? (unsigned char)origem[i + 1] : 0;
+
+        if (c >= 'A' && c <= 'Z')
+            destino[n++] = (char)(c + ('a' - 'A'));
+        else if (c == 0xC3 && seguinte >= 0x80 && seguinte <= 0xBF)
+        {
+            // UTF-8: C3 80..BF corresponde a Latin-1 C0..FF
+            char letra = letrasSemAcento[seguinte - 0x80];
+            if (letra)
+                destino[n++] = letra;
+            else
+            {
+                destino[n++] = (char)c;
+                destino[n++] = (char)seguinte;
+            }
+            i++;
+        }
+        else if (c >= 0xC0 && letrasSemAcento[c - 0xC0])
+            destino[n++] = letrasSemAcento[c - 0xC0];  // Latin-1
+        else
+            destino[n++] = (char)c;
+        i++;
+    }
+    return (int)n;
+}
+
+/*
+ * Função: contemDobrado
+ * Objetivo: Verificar se um nome dobrado contém o texto buscado (dobrado)
+ *           Com SSE2, compara 16 posições de uma vez com o primeiro e o
+ *           último caractere da busca e só confere por inteiro as posições
+ *           em que os dois coincidem
+ * Parâmetros: nome - nome dobrado (posição de TAMANHO_DOBRADO bytes)
+ *             busca - texto buscado, já dobrado
+ *             tamanho - tamanho da busca (1 a MAX_NOME)
+ * Retorno: int - 1 se contém, 0 caso contrário
+ */
+int contemDobrado(const char *nome, const char *busca, int tamanho)
+{
+#if defined(__SSE2__)
+    __m128i primeiro = _mm_set1_epi8(busca[0]);
+    __m128i ultimo = _mm_set1_epi8(busca[tamanho - 1]);
+    int maiorInicio = MAX_NOME - tamanho;  // Última posição em que a busca cabe
+
+    for (int k = 0; k <= maiorInicio; k += 16)
+    {
+        // A segunda leitura pode passar da posição do nome; a coluna tem
+        // uma posição extra no fim para isso e os bits de fora são ignorados
+        __m128i blocoInicio = _mm_loadu_si128((const __m128i *)(nome + k));
+        __m128i blocoFim = _mm_loadu_si128((const __m128i *)(nome + k + tamanho - 1));
+        unsigned int mascara = (unsigned int)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(blocoInicio, primeiro), _mm_cmpeq_epi8(blocoFim, ultimo)));
+
+        while (mascara)
+        {
+            int p = k + __builtin_ctz(mascara);
+            if (p > maiorInicio)
+                break;
+            if (tamanho <= 2 || memcmp(nome + p + 1, busca + 1, (size_t)tamanho - 2) == 0)
+                return 1;
+            mascara &= mascara - 1;  // Próxima posição candidata
+        }
+    }
+    return 0;
+#else
+    for (int p = 0; p + tamanho <= MAX_NOME && nome[p] != '\0'; p++)
+        if (nome[p] == busca[0] && memcmp(nome + p, busca, (size_t)tamanho) == 0)
+            return 1;
+    return 0;
+#endif
+}
+
+/*
+ * Função: definirNomeDobrado
+ * Objetivo: Guardar o nome dobrado de um registro na coluna
+ *           A coluna sempre tem uma posição a mais, lida por contemDobrado
+ * Parâmetros: coluna - ponteiro para a coluna (pode ser realocada)
+ *             capacidade - capacidade da coluna
+ *             posicao - posição do registro
+ *             nome - nome original
+ *             tamanhoNome - tamanho do campo nome
+ * Retorno: void
+ */
+void definirNomeDobrado(char (**coluna)[TAMANHO_DOBRADO], int *capacidade, int posicao,
+                        const char *nome, size_t tamanhoNome)
+{
+    *coluna = garantirCapacidade(*coluna, capacidade, posicao + 2, TAMANHO_DOBRADO);
+    dobrarTexto(nome, tamanhoNome, (*coluna)[posicao], TAMANHO_DOBRADO);
+    memset((*coluna)[posicao + 1], 0, TAMANHO_DOBRADO);
+}
+
+// ============================================================
+// ÍNDICE DE TRIGRAMAS PARA PESQUISA POR PARTE DO NOME
+// ============================================================
+
+/*
+ * Cada nome dobrado é quebrado em trigramas (sequências de 3 bytes
+ * consecutivos) e, para cada trigrama, o índice guarda a lista crescente das
+ * posições dos registros que o contêm. Uma pesquisa por parte do nome
+ * intersecta as listas dos trigramas do texto buscado, começando pela menor,
+ * e só confirma com contemDobrado os poucos candidatos que sobram. Textos com
+ * menos de 3 bytes não têm trigramas e continuam sendo pesquisados por
+ * varredura da coluna de nomes dobrados.
+ */
+typedef struct
+{
+    int *posicoes;    // Posições dos registros, em ordem crescente
+    int quantidade;   // Posições usadas
+    int capacidade;   // Posições alocadas
+} ListaTrigrama;
+
+typedef struct
+{
+    unsigned int *chaves;   // Trigrama em cada posição (0 = posição vazia)
+    ListaTrigrama *listas;  // Lista de registros de cada trigrama
+    int capacidade;         // Quantidade de posições (sempre potência de 2)
+    int quantidade;         // Quantidade de trigramas distintos
+} IndiceTrigramas;
+
+IndiceTrigramas trigramasClientes = {NULL, NULL, 0, 0};
+IndiceTrigramas trigramasFuncionarios = {NULL, NULL, 0, 0};
+
+// Um buffer por thread: no modo servidor várias pesquisas rodam ao mesmo tempo
+LOCAL_DA_THREAD int *resultadosNome = NULL;  // Posições encontradas na última pesquisa por nome
+LOCAL_DA_THREAD int capacidadeResultados = 0;
+
+/*
+ * Função: chaveTrigrama
+ * Objetivo: Montar a chave de 24 bits de um trigrama
+ * Parâmetros: texto - ponteiro para os 3 bytes do trigrama
+ * Retorno: unsigned int - chave (nunca 0, pois o primeiro byte não é \0)
+ */
+unsigned int chaveTrigrama(const char *texto)
+{
+    return ((unsigned int)(unsigned char)texto[0] << 16) |
+           ((unsigned int)(unsigned char)texto[1] << 8) |
+           (unsigned int)(unsigned char)texto[2];
+}
+
+/*
+ * Função: trigramaLocalizar
+ * Objetivo: Encontrar a posição de um trigrama no índice (ou a posição
+ *           vazia onde ele seria inserido)
+ * Parâmetros: indice - índice a consultar (com capacidade > 0)
+ *             chave - trigrama procurado
+ * Retorno: int - posição na tabela do índice
+ */
+int trigramaLocalizar(const IndiceTrigramas *indice, unsigned int chave)
+{
+    int mascara = indice->capacidade - 1;
+    int i = hashCodigo((int)chave, mascara);
+    while (indice->chaves[i] != 0 && indice->chaves[i] != chave)
+        i = (i + 1) & mascara;  // Sondagem linear
+    return i;
+}
+
+/*
+ * Função: trigramaLista
+ * Objetivo: Obter a lista de posições de um trigrama, criando-a se preciso
+ *           Dobra o índice quando a ocupação passa de 50%
+ * Parâmetros: indice - índice a alterar
+ *             chave - trigrama
+ * Retorno: ListaTrigrama* - lista do trigrama
+ */
+ListaTrigrama *trigramaLista(IndiceTrigramas *indice, unsigned int chave)
+{
+    if ((indice->quantidade + 1) * 2 > indice->capacidade)
+    {
+        // Reconstrói com o dobro de posições, movendo as listas existentes
+        IndiceTrigramas novo;
+        novo.capacidade = indice->capacidade > 0 ? indice->capacidade * 2 : 4096;
+        novo.quantidade = indice->quantidade;
+        novo.chaves = calloc((size_t)novo.capacidade, sizeof(unsigned int));
+        novo.listas = malloc((size_t)novo.capacidade * sizeof(ListaTrigrama));
+        if (!novo.chaves || !novo.listas)
+        {
+            printf("Erro: memoria insuficiente.\n");
+            exit(1);
+        }
+        for (int i = 0; i < indice->capacidade; i++)
+            if (indice->chaves[i] != 0)
+            {
+                int p = trigramaLocalizar(&novo, indice->chaves[i]);
+                novo.chaves[p] = indice->chaves[i];
+                novo.listas[p] = indice->listas[i];
+            }
+
+        free(indice->chaves);
+        free(indice->listas);
+        *indice = novo;
+    }
+
+    int p = trigramaLocalizar(indice, chave);
+    if (indice->chaves[p] == 0)
+    {
+        indice->chaves[p] = chave;
+        indice->listas[p].posicoes = NULL;
+        indice->listas[p].quantidade = 0;
+        indice->listas[p].capacidade = 0;
+        indice->quantidade++;
+    }
+    return &indice->listas[p];
+}
+
+/*
+ * Função: trigramasIndexar
+ * Objetivo: Acrescentar um registro às listas de todos os trigramas do nome
+ *           As posições chegam em ordem crescente, então as listas
+ *           continuam ordenadas sem nenhuma reordenação
+ * Parâmetros: indice - índice a alterar
+ *             nome - nome do registro
+ *             tamanhoNome - tamanho do campo nome (limite de leitura)
+ *             posicao - posição do registro na tabela
+ * Retorno: void
+ */
+void trigramasIndexar(IndiceTrigramas *indice, const char *nome, size_t tamanhoNome, int posicao)
+{
+    const char *fim = memchr(nome, '\0', tamanhoNome);
+    int tamanho = fim ? (int)(fim - nome) : (int)tamanhoNome;
+
+    for (int i = 0; i + 3 <= tamanho; i++)
+    {
+        ListaTrigrama *lista = trigramaLista(indice, chaveTrigrama(nome + i));
+        if (lista->quantidade > 0 && lista->posicoes[lista->quantidade - 1] == posicao)
+            continue;  // Trigrama repetido no mesmo nome
+
+        if (lista->quantidade == lista->capacidade)
+        {
+            int nova = lista->capacidade > 0 ? lista->capacidade * 2 : 4;
+            int *posicoes = realloc(lista->posicoes, (size_t)nova * sizeof(int));
+            if (!posicoes)
+            {
+                printf("Erro: memoria insuficiente.\n");
+                exit(1);
+            }
+            lista->posicoes = posicoes;
+            lista->capacidade = nova;
+        }
+        lista->posicoes[lista->quantidade++] = posicao;
+    }
+}
+
+/*
+ * Função: listaContem
+ * Objetivo: Verificar se uma lista de trigrama contém uma posição
+ *           (busca binária, a lista é crescente)
+ * Parâmetros: lista - lista a consultar
+ *             posicao - posição procurada
+ * Retorno: int - 1 se contém, 0 caso contrário
+ */
+int listaContem(const ListaTrigrama *lista, int posicao)
+{
+    int inicio = 0, fim = lista->quantidade - 1;
+    while (inicio <= fim)
+    {
+        int meio = inicio + (fim - inicio) / 2;
+        if (lista->posicoes[meio] == posicao)
+            return 1;
+        if (lista->posicoes[meio] < posicao)
+            inicio = meio + 1;
+        else
+            fim = meio - 1;
+    }
+    return 0;
+}
+
+/*
+ * Função: candidatosTrigramas
+ * Objetivo: Intersectar as listas dos trigramas do texto buscado
+ *           O resultado fica em resultadosNome, em ordem crescente
+ * Parâmetros: indice - índice a consultar
+ *             busca - texto buscado (ao menos 3 bytes)
+ * Retorno: int - quantidade de candidatos
+ */
+int candidatosTrigramas(const IndiceTrigramas *indice, const char *busca)
+{
+    int tamanho = (int)strlen(busca);
+    if (indice->capacidade == 0)
+        return 0;
+
+    // Localiza a menor lista: ela limita o número de candidatos
+    const ListaTrigrama *menor = NULL;
+    for (int i = 0; i + 3 <= tamanho; i++)
+    {
+        int p = trigramaLocalizar(indice, chaveTrigrama(busca + i));
+        if (indice->chaves[p] == 0)
+            return 0;  // Trigrama que nenhum nome contém
+        if (!menor || indice->listas[p].quantidade < menor->quantidade)
+            menor = &indice->listas[p];
+    }
+
+    resultadosNome = garantirCapacidade(resultadosNome, &capacidadeResultados,
+                                        menor->quantidade, sizeof(int));
+    memcpy(resultadosNome, menor->posicoes, (size_t)menor->quantidade * sizeof(int));
+    int total = menor->quantidade;
+
+    // Filtra os candidatos pelas demais listas
+    for (int i = 0; i + 3 <= tamanho && total > 0; i++)
+    {
+        const ListaTrigrama *lista = &indice->listas[trigramaLocalizar(indice, chaveTrigrama(busca + i))];
+        if (lista == menor)
+            continue;
+        int restantes = 0;
+        for (int j = 0; j < total; j++)
+            if (listaContem(lista, resultadosNome[j]))
+                resultadosNome[restantes++] = resultadosNome[j];
+        total = restantes;
+    }
+    return total;
+}
+
+/*
+ * Função: pesquisarNomesDobrados
+ * Objetivo: Encontrar os registros cujo nome contém um texto, sem
+ *           diferenciar maiúsculas, minúsculas e acentos
+ * Parâmetros: indice - índice de trigramas da entidade
+ *             nomes - coluna de nomes dobrados da entidade
+ *             total - quantidade de registros
+ *             busca - texto buscado (original)
+ * Retorno: int - quantidade encontrada (posições em resultadosNome,
+ *          em ordem de cadastro)
+ */
+int pesquisarNomesDobrados(const IndiceTrigramas *indice, char (*nomes)[TAMANHO_DOBRADO],
+                           int total, const char *busca)
+{
+    char buscaDobrada[TAMANHO_DOBRADO];
+    int tamanho = dobrarTexto(busca, strlen(busca), buscaDobrada, sizeof(buscaDobrada));
+    if (tamanho > MAX_NOME)
+        return 0;  // Maior que qualquer nome
+
+    int encontrados = 0;
+    if (tamanho < 3)
+    {
+        // Sem trigramas: varredura completa da coluna
+        for (int i = 0; i < total; i++)
+            if (tamanho == 0 || contemDobrado(nomes[i], buscaDobrada, tamanho))
+            {
+                resultadosNome = garantirCapacidade(resultadosNome, &capacidadeResultados,
+                                                    encontrados + 1, sizeof(int));
+                resultadosNome[encontrados++] = i;
+            }
+        return encontrados;
+    }
+
+    // Candidatos têm todos os trigramas; contemDobrado confirma a ordem deles
+    int candidatos = candidatosTrigramas(indice, buscaDobrada);
+    for (int i = 0; i < candidatos; i++)
+        if (contemDobrado(nomes[resultadosNome[i]], buscaDobrada, tamanho))
+            resultadosNome[encontrados++] = resultadosNome[i];
+    return encontrados;
+}
+
+/*
+ * Função: pesquisarNomesClientes
+ * Objetivo: Encontrar os clientes cujo nome contém um texto
+ * Parâmetros: busca - texto buscado
+ * Retorno: int - quantidade encontrada (posições em resultadosNome)
+ */
+int pesquisarNomesClientes(const char *busca)
+{
+    return pesquisarNomesDobrados(&trigramasClientes, nomesDobradosClientes, totalClientes, busca);
+}
+
+/*
+ * Função: pesquisarNomesFuncionarios
+ * Objetivo: Encontrar os funcionários cujo nome contém um texto
+ * Parâmetros: busca - texto buscado
+ * Retorno: int - quantidade encontrada (posições em resultadosNome)
+ */
+int pesquisarNomesFuncionarios(const char *busca)
+{
+    return pesquisarNomesDobrados(&trigramasFuncionarios, nomesDobradosFuncionarios,
+                                  totalFuncionarios, busca);
+}
+
+// ============================================================
+// DIAS SERIAIS (ARITMÉTICA DE DATAS EM TEMPO CONSTANTE)
+// ============================================================
+
+/*
+ * Um dia serial é a quantidade de dias desde 01/01/1970. Com ele, contar
+ * diárias é uma subtração e comparar períodos são comparações de inteiros,
+ * sem percorrer o calendário mês a mês. As estadias em memória guardam as
+ * datas assim (ver ColunasEstadias); Data só é usada para ler e exibir.
+ *
+ * O cálculo conta os anos a partir de março, de modo que o dia extra do
+ * ano bissexto fica no fim do "ano" e a posição de cada mês é fixa.
+ */
+
+// Dias entre 1º de março e o 1º dia de cada mês (janeiro a dezembro)
+const short diasDesdeMarco[12] = {306, 337, 0, 31, 61, 92, 122, 153, 184, 214, 245, 275};
+
+/*
+ * Função: diaSerial
+ * Objetivo: Converter uma data no número de dias desde 01/01/1970
+ *           (calendário gregoriano, cálculo direto sem laços)
+ * Parâmetros: d - data a converter (válida)
+ * Retorno: int - dia serial
+ */
+int diaSerial(Data d)
+{
+    int ano = d.mes <= 2 ? d.ano - 1 : d.ano;        // Ano começando em março
+    int era = (ano >= 0 ? ano : ano - 399) / 400;     // Ciclos de 400 anos
+    int anoDaEra = ano - era * 400;                                          // 0..399
+    int diaDoAno = diasDesdeMarco[d.mes - 1] + d.dia - 1;                    // 0..365
+    int diaDaEra = anoDaEra * 365 + anoDaEra / 4 - anoDaEra / 100 + diaDoAno;  // 0..146096
+    return era * 146097 + diaDaEra - 719468;
+}
+
+/*
+ * Função: dataDoDiaSerial
+ * Objetivo: Converter um dia serial de volta em data (para exibição)
+ * Parâmetros: serial - dias desde 01/01/1970
+ * Retorno: Data - data correspondente
+ */
+Data dataDoDiaSerial(int serial)
+{
+    int z = serial + 719468;
+    int era = (z >= 0 ? z : z - 146096) / 146097;
+    int diaDaEra = z - era * 146097;                                                     // 0..146096
+    int anoDaEra = (diaDaEra - diaDaEra / 1460 + diaDaEra / 36524 - diaDaEra / 146096) / 365;  // 0..399
+    int diaDoAno = diaDaEra - (365 * anoDaEra + anoDaEra / 4 - anoDaEra / 100);           // 0..365
+    int mesDesdeMarco = (5 * diaDoAno + 2) / 153;                                         // 0..11
+
+    Data d;
+    d.dia = diaDoAno - (153 * mesDesdeMarco + 2) / 5 + 1;
+    d.mes = mesDesdeMarco < 10 ? mesDesdeMarco + 3 : mesDesdeMarco - 9;
+    d.ano = anoDaEra + era * 400 + (d.mes <= 2);
+    return d;
+}
+
+/*
+ * Função: diaSerialHoje
+ * Objetivo: Obter o dia serial da data atual (relógio local)
+ * Parâmetros: -
+ * Retorno: int - dia serial de hoje
+ */
+int diaSerialHoje()
+{
+    time_t agora = time(NULL);
+    struct tm local;
+#ifdef _WIN32
+    local = *localtime(&agora);  // No Windows o resultado é por thread
+#else
+    localtime_r(&agora, &local);
+#endif
+    Data hoje = {local.tm_mday, local.tm_mon + 1, local.tm_year + 1900};
+    return diaSerial(hoje);
+}
+
+// ============================================================
+// ARQUIVO DO HISTÓRICO (ESTADIAS FINALIZADAS COMPACTADAS)
+// ============================================================
+
+/*
+ * O histórico (ARQ_HISTORICO) só recebe estadias finalizadas, em lotes, e
+ * nunca as altera; por isso não precisa de registros de tamanho fixo. Depois
+ * do cabeçalho do arquivo (tipo REGISTRO_HISTORICO) vêm blocos de até
+ * REGISTROS_POR_BLOCO estadias, cada um com TAMANHO_CABECALHO_HISTORICO bytes
+ * de cabeçalho:
+ *      0 CRC32C dos bytes 4-31 e dos dados   4 estadias no bloco
+ *      8 bytes de dados                    12 menor entrada (dia serial)
+ *     16 maior saída (dia serial)          20 menor código de cliente
+ *     24 maior código de cliente           28 reservado (zero)
+ * seguidos dos dados, completados com zeros até múltiplo de 8.
+ *
+ * Cada estadia vira seis varints (7 bits por byte, zigue-zague para
+ * negativos), quase todos de um byte: código e entrada como diferença para
+ * a estadia anterior do bloco, cliente, quarto, duração (saída - entrada) e
+ * diárias como diferença para a duração. O histórico de 200 mil estadias
+ * do benchmark ocupa 9,7 bytes por estadia, cabeçalhos incluídos, em vez
+ * de 48. As faixas do cabeçalho deixam consultas por período ou cliente
+ * pularem blocos inteiros sem decodificá-los (consultarHistorico).
+ *
+ * Cada compactação acrescenta blocos novos depois do último, sem regravar
+ * nenhum; o total do cabeçalho do arquivo é gravado por último e diz até
+ * onde os blocos valem.
+ */
+#define TAMANHO_CABECALHO_HISTORICO 32
+#define MAXIMO_BYTES_ESTADIA 30   // Seis varints de até 5 bytes
+#define MAXIMO_BLOCO_HISTORICO (TAMANHO_CABECALHO_HISTORICO + REGISTROS_POR_BLOCO * MAXIMO_BYTES_ESTADIA + 8)
+
+/*
+ * Cabeçalho de um bloco do histórico já decodificado
+ */
+typedef struct
+{
+    int registros;       // Estadias no bloco
+    int bytes;           // Bytes de dados (sem o preenchimento)
+    int menorEntrada;    // Faixa de datas das estadias (dias seriais)
+    int maiorSaida;
+    int menorCliente;    // Faixa de códigos de cliente
+    int maiorCliente;
+    long proximo;        // Deslocamento do bloco seguinte
+} BlocoHistorico;
+
+/*
+ * Funções: escreverVarint / lerVarint
+ * Objetivo: Gravar e ler um inteiro em zigue-zague com 7 bits por byte
+ *           (0, -1, 1, -2... viram 0, 1, 2, 3... e ocupam um byte até 63)
+ */
+unsigned char *escreverVarint(unsigned char *p, int valor)
+{
+    unsigned int u = ((unsigned int)valor << 1) ^ (valor < 0 ? 0xFFFFFFFFu : 0);
+    while (u >= 0x80)
+    {
+        *p++ = (unsigned char)(u | 0x80);
+        u >>= 7;
+    }
+    *p++ = (unsigned char)u;
+    return p;
+}
+
+const unsigned char *lerVarint(const unsigned char *p, const unsigned char *fim, int *valor)
+{
+    unsigned int u = 0;
+    for (int deslocamento = 0; p < fim && deslocamento < 35; deslocamento += 7)
+    {
+        unsigned char byte = *p++;
+        u |= (unsigned int)(byte & 0x7F) << deslocamento;
+        if (!(byte & 0x80))
+        {
+            *valor = (int)(u >> 1) ^ -(int)(u & 1);
+            return p;
+        }
+    }
+    return NULL;  // Varint cortado ou longo demais: dados danificados
+}
+
+/*
+ * Função: codificarBlocoHistorico
+ * Objetivo: Montar um bloco do histórico (cabeçalho, dados e preenchimento)
+ * Parâmetros: estadias - estadias finalizadas (datas válidas)
+ *             quantidade - 1 a REGISTROS_POR_BLOCO
+ *             destino - MAXIMO_BLOCO_HISTORICO bytes
+ * Retorno: int - tamanho do bloco em bytes
+ */
+int codificarBlocoHistorico(const Estadia *estadias, int quantidade, unsigned char *destino)
+{
+    unsigned char *p = destino + TAMANHO_CABECALHO_HISTORICO;
+    int codigoAnterior = 0, entradaAnterior = 0;
+    int menorEntrada = 0, maiorSaida = 0, menorCliente = 0, maiorCliente = 0;
+    for (int i = 0; i < quantidade; i++)
+    {
+        const Estadia *e = &estadias[i];
+        int entrada = diaSerial(e->dataEntrada);
+        int saida = diaSerial(e->dataSaida);
+        p = escreverVarint(p, (int)((unsigned int)e->codigoEstadia - (unsigned int)codigoAnterior));
+        p = escreverVarint(p, e->codigoCliente);
+        p = escreverVarint(p, e->numeroQuarto);
+        p = escreverVarint(p, entrada - entradaAnterior);
+        p = escreverVarint(p, saida - entrada);
+        p = escreverVarint(p, e->quantidadeDiarias - (saida - entrada));
+        codigoAnterior = e->codigoEstadia;
+        entradaAnterior = entrada;
+
+        if (i == 0 || entrada < menorEntrada)
+            menorEntrada = entrada;
+        if (i == 0 || saida > maiorSaida)
+            maiorSaida = saida;
+        if (i == 0 || e->codigoCliente < menorCliente)
+            menorCliente = e->codigoCliente;
+        if (i == 0 || e->codigoCliente > maiorCliente)
+            maiorCliente = e->codigoCliente;
+    }
+    int bytes = (int)(p - destino) - TAMANHO_CABECALHO_HISTORICO;
+    while ((p - destino) % 8 != 0)
+        *p++ = 0;
+
+    memset(destino, 0, TAMANHO_CABECALHO_HISTORICO);
+    escreverPalavra(destino + 4, (unsigned int)quantidade);
+    escreverPalavra(destino + 8, (unsigned int)bytes);
+    escreverPalavra(destino + 12, (unsigned int)menorEntrada);
+    escreverPalavra(destino + 16, (unsigned int)maiorSaida);
+    escreverPalavra(destino + 20, (unsigned int)menorCliente);
+    escreverPalavra(destino + 24, (unsigned int)maiorCliente);
+    unsigned int soma = continuarCrc32c(0, destino + 4, TAMANHO_CABECALHO_HISTORICO - 4);
+    escreverPalavra(destino, continuarCrc32c(soma, destino + TAMANHO_CABECALHO_HISTORICO, (size_t)bytes));
+    return (int)(p - destino);
+}
+
+/*
+ * Função: lerBlocoHistorico
+ * Objetivo: Ler o cabeçalho de um bloco do histórico e conferir se o bloco
+ *           cabe no arquivo
+ * Parâmetros: cabecalho - TAMANHO_CABECALHO_HISTORICO bytes do bloco
+ *             deslocamento - posição do bloco no arquivo
+ *             tamanhoArquivo - bytes do arquivo
+ *             b - cabeçalho lido
+ * Retorno: int - 1 se o cabeçalho é coerente
+ */
+int lerBlocoHistorico(const unsigned char *cabecalho, long deslocamento, size_t tamanhoArquivo,
+                      BlocoHistorico *b)
+{
+    b->registros = (int)lerPalavra(cabecalho + 4);
+    b->bytes = (int)lerPalavra(cabecalho + 8);
+    b->menorEntrada = (int)lerPalavra(cabecalho + 12);
+    b->maiorSaida = (int)lerPalavra(cabecalho + 16);
+    b->menorCliente = (int)lerPalavra(cabecalho + 20);
+    b->maiorCliente = (int)lerPalavra(cabecalho + 24);
+    b->proximo = deslocamento + TAMANHO_CABECALHO_HISTORICO + (b->bytes + 7) / 8 * 8;
+    return b->registros > 0 && b->registros <= REGISTROS_POR_BLOCO &&
+           b->bytes > 0 && b->bytes <= REGISTROS_POR_BLOCO * MAXIMO_BYTES_ESTADIA &&
+           (size_t)deslocamento + TAMANHO_CABECALHO_HISTORICO + (size_t)b->bytes <= tamanhoArquivo;
+}
+
+/*
+ * Função: blocoHistoricoConfere
+ * Objetivo: Conferir o CRC32C de um bloco do histórico
+ * Parâmetros: bloco - início do bloco (cabeçalho seguido dos dados)
+ *             b - cabeçalho lido por lerBlocoHistorico
+ * Retorno: int - 1 se o bloco está íntegro
+ */
+int blocoHistoricoConfere(const unsigned char *bloco, const BlocoHistorico *b)
+{
+    unsigned int soma = continuarCrc32c(0, bloco + 4, TAMANHO_CABECALHO_HISTORICO - 4);
+    soma = continuarCrc32c(soma, bloco + TAMANHO_CABECALHO_HISTORICO, (size_t)b->bytes);
+    return lerPalavra(bloco) == soma;
+}
+
+/*
+ * Função: decodificarBlocoHistorico
+ * Objetivo: Reconstruir as estadias de um bloco do histórico
+ * Parâmetros: bloco - início do bloco
+ *             b - cabeçalho lido por lerBlocoHistorico
+ *             destino - espaço para b->registros estadias
+ * Retorno: int - 1 se decodificou, 0 se os dados estão danificados
+ */
+int decodificarBlocoHistorico(const unsigned char *bloco, const BlocoHistorico *b, Estadia *destino)
+{
+    const unsigned char *p = bloco + TAMANHO_CABECALHO_HISTORICO;
+    const unsigned char *fim = p + b->bytes;
+    int codigo = 0, entrada = 0;
+    for (int i = 0; i < b->registros; i++)
+    {
+        int campos[6];
+        for (int c = 0; c < 6 && p; c++)
+            p = lerVarint(p, fim, &campos[c]);
+        if (!p)
+            return 0;
+
+        codigo = (int)((unsigned int)codigo + (unsigned int)campos[0]);
+        entrada += campos[3];
+        Estadia *e = &destino[i];
+        memset(e, 0, sizeof(*e));
+        e->codigoEstadia = codigo;
+        e->codigoCliente = campos[1];
+        e->numeroQuarto = campos[2];
+        e->dataEntrada = dataDoDiaSerial(entrada);
+        e->dataSaida = dataDoDiaSerial(entrada + campos[4]);
+        e->quantidadeDiarias = campos[4] + campos[5];
+        e->estadiaAtiva = 0;
+    }
+    return p == fim;
+}
+
+/*
+ * Função: historicoDanificado
+ * Objetivo: Encerrar o programa quando a estrutura do histórico está
+ *           danificada (sem o tamanho de um bloco não há como achar o seguinte)
+ */
+void historicoDanificado(const char *nome, int registro)
+{
+    printf("Erro: %s danificado a partir do registro %d.\n", nome, registro + 1);
+    exit(1);
+}
+
+/*
+ * Função: lerHistorico
+ * Objetivo: Decodificar as estadias do histórico a partir de um índice
+ * Parâmetros: nome - nome do arquivo
+ *             primeiro - índice da primeira estadia a ler
+ *             quantidade - ponteiro para a quantidade lida
+ *             conferir - 1 para conferir o CRC32C dos blocos lidos
+ * Retorno: Estadia* - vetor alocado com as estadias (NULL se não há nenhuma)
+ */
+Estadia *lerHistorico(const char *nome, int primeiro, int *quantidade, int conferir)
+{
+    *quantidade = 0;
+    size_t bytes;
+    const unsigned char *mapa = mapearArquivo(nome, &bytes);
+    if (!mapa)
+        return NULL;
+
+    CabecalhoArquivo cabecalho;
+    decodificarCabecalho(nome, mapa, bytes, REGISTRO_HISTORICO, &cabecalho);
+    if (primeiro >= cabecalho.total)
+    {
+        desmapearArquivo(mapa, bytes);
+        return NULL;
+    }
+
+    Estadia *vetor = malloc((size_t)(cabecalho.total - primeiro) * sizeof(Estadia));
+    Estadia bloco[REGISTROS_POR_BLOCO];
+    if (!vetor)
+    {
+        printf("Erro: memoria insuficiente.\n");
+        exit(1);
+    }
+    long deslocamento = TAMANHO_CABECALHO;
+    for (int indice = 0; indice < cabecalho.total;)
+    {
+        BlocoHistorico b;
+        if ((size_t)deslocamento + TAMANHO_CABECALHO_HISTORICO > bytes ||
+            !lerBlocoHistorico(mapa + deslocamento, deslocamento, bytes, &b))
+            historicoDanificado(nome, indice);
+
+        if (indice + b.registros > primeiro)
+        {
+            // Só os blocos a partir de primeiro são decodificados
+            if (conferir && !blocoHistoricoConfere(mapa + deslocamento, &b))
+                fprintf(stderr, "Aviso: %s, registros %d a %d: soma de verificacao nao confere "
+                                "(arquivo danificado).\n",
+                        nome, indice + 1, indice + b.registros);
+            if (!decodificarBlocoHistorico(mapa + deslocamento, &b, bloco))
+                historicoDanificado(nome, indice);
+            for (int i = 0; i < b.registros && indice + i < cabecalho.total; i++)
+                if (indice + i >= primeiro)
+                    vetor[indice + i - primeiro] = bloco[i];
+        }
+        indice += b.registros;
+        deslocamento = b.proximo;
+    }
+    desmapearArquivo(mapa, bytes);
+    *quantidade = cabecalho.total - primeiro;
+    return vetor;
+}
+
+/*
+ * Função: gravarHistorico
+ * Objetivo: Gravar estadias finalizadas no histórico, em blocos novos
+ * Parâmetros: nome - nome do arquivo (criado se não existir)
+ *             estadias, quantidade - estadias a gravar
+ *             inicio - índice da primeira estadia gravada: -1 acrescenta no
+ *                      fim, 0 recria o arquivo; estadias a partir de inicio
+ *                      deixam de existir
+ *             sincronizar - 1 para forçar a gravação no disco
+ * Retorno: int - 1 se gravou, 0 em caso de erro
+ */
+int gravarHistorico(const char *nome, const Estadia *estadias, int quantidade, int inicio, int sincronizar)
+{
+    FILE *arq = inicio == 0 ? NULL : fopen(nome, "r+b");  // Leitura/escrita sem truncar
+    if (!arq)
+        arq = fopen(nome, "w+b");
+    if (!arq)
+        return 0;
+
+    CabecalhoArquivo cabecalho = {REGISTRO_HISTORICO, 0, 1, {0}};
+    unsigned char *bloco = malloc(MAXIMO_BLOCO_HISTORICO);
+    size_t lidos = fread(bloco, 1, TAMANHO_CABECALHO, arq);
+    if (lidos > 0)
+        decodificarCabecalho(nome, bloco, lidos, REGISTRO_HISTORICO, &cabecalho);
+    if (inicio < 0 || inicio > cabecalho.total)
+        inicio = cabecalho.total;
+
+    // Anda pelos cabeçalhos dos blocos até o que contém inicio; se inicio
+    // cair no meio de um bloco, as estadias anteriores dele são regravadas
+    Estadia *todas = NULL;
+    int anteriores = 0, indice = 0, ok = 1;
+    long deslocamento = TAMANHO_CABECALHO;
+    while (indice < inicio && ok)
+    {
+        BlocoHistorico b;
+        ok = fseek(arq, deslocamento, SEEK_SET) == 0 &&
+             fread(bloco, TAMANHO_CABECALHO_HISTORICO, 1, arq) == 1 &&
+             lerBlocoHistorico(bloco, deslocamento, (size_t)-1, &b) &&
+             fread(bloco + TAMANHO_CABECALHO_HISTORICO, (size_t)b.bytes, 1, arq) == 1;
+        if (!ok)
+            break;
+        if (indice + b.registros > inicio)
+        {
+            anteriores = inicio - indice;
+            todas = malloc((size_t)(b.registros + quantidade) * sizeof(Estadia));
+            ok = todas && decodificarBlocoHistorico(bloco, &b, todas);
+            if (ok)
+                memcpy(todas + anteriores, estadias, (size_t)quantidade * sizeof(Estadia));
+            estadias = todas;
+            quantidade += anteriores;
+            break;
+        }
+        indice += b.registros;
+        deslocamento = b.proximo;
+    }
+    cabecalho.total = indice;
+
+    ok = ok && fseek(arq, deslocamento, SEEK_SET) == 0;
+    for (int i = 0; i < quantidade && ok; i += REGISTROS_POR_BLOCO)
+    {
+        int noBloco = quantidade - i < REGISTROS_POR_BLOCO ? quantidade - i : REGISTROS_POR_BLOCO;
+        int tamanho = codificarBlocoHistorico(estadias + i, noBloco, bloco);
+        ok = fwrite(bloco, (size_t)tamanho, 1, arq) == 1;
+        for (int j = i; j < i + noBloco; j++)
+            if (estadias[j].codigoEstadia >= cabecalho.proximoCodigo)
+                cabecalho.proximoCodigo = estadias[j].codigoEstadia + 1;
+        cabecalho.total += noBloco;
+    }
+
+    // Cabeçalho do arquivo por último: até aqui, os blocos novos não valem
+    codificarCabecalho(&cabecalho, bloco);
+    ok = ok && fseek(arq, 0, SEEK_SET) == 0 && fwrite(bloco, TAMANHO_CABECALHO, 1, arq) == 1 &&
+         fflush(arq) == 0;
+    if (sincronizar)
+        sincronizarArquivo(arq);
+    free(bloco);
+    free(todas);
+    return fclose(arq) == 0 && ok;
+}
+
+/*
+ * Função: historicoNoFormatoAntigo
+ * Objetivo: Verificar se o histórico foi gravado por uma versão anterior
+ *           (sem cabeçalho ou com registros de tamanho fixo)
+ * Parâmetros: -
+ * Retorno: int - 1 se precisa ser convertido
+ */
+int historicoNoFormatoAntigo()
+{
+    FILE *arq = fopen(ARQ_HISTORICO, "rb");
+    if (!arq)
+        return 0;
+    unsigned char inicio[16];
+    size_t lidos = fread(inicio, 1, sizeof(inicio), arq);
+    fclose(arq);
+    if (lidos == 0)
+        return 0;
+    return !temAssinatura(inicio, lidos) ||
+           (lidos == sizeof(inicio) && lerPalavra(inicio + 12) == REGISTRO_ESTADIA);
+}
+
+/*
+ * Função: lerHistoricoAntigo
+ * Objetivo: Ler um histórico de versões anteriores (structs sem cabeçalho
+ *           ou blocos de registros de tamanho fixo)
+ * Parâmetros: registros - ponteiro para a quantidade lida
+ * Retorno: Estadia* - vetor alocado (NULL se não há nenhuma)
+ */
+Estadia *lerHistoricoAntigo(int *registros)
+{
+    Estadia *estadias = lerArquivoAntigo(ARQ_HISTORICO, REGISTRO_ESTADIA, registros);
+    if (!estadias)
+        estadias = lerRegistros(ARQ_HISTORICO, REGISTRO_ESTADIA, 0, registros, 0);  // Blocos fixos
+    return estadias;
+}
+
+/*
+ * Função: converterHistoricoAntigo
+ * Objetivo: Regravar um histórico de versões anteriores no formato compactado
+ *           Chamada com a trava exclusiva dos dados
+ * Parâmetros: -
+ * Retorno: int - 1 se o histórico foi convertido
+ */
+int converterHistoricoAntigo()
+{
+    if (!historicoNoFormatoAntigo())
+        return 0;  // Outro processo pode ter convertido
+
+    int registros;
+    Estadia *estadias = lerHistoricoAntigo(&registros);
+
+    char temporario[64];
+    snprintf(temporario, sizeof(temporario), "%s.convertendo", ARQ_HISTORICO);
+    int ok = gravarHistorico(temporario, estadias, registros, 0, 1) &&
+             substituirArquivo(temporario, ARQ_HISTORICO) == 0;
+    free(estadias);
+    if (!ok)
+    {
+        printf("Erro: nao foi possivel converter %s para o formato atual.\n", ARQ_HISTORICO);
+        exit(1);
+    }
+    fprintf(stderr, "%s convertido para o formato compactado (%d registros).\n", ARQ_HISTORICO, registros);
+    return 1;
+}
+
+// ============================================================
+// VISÕES DE LEITURA (SNAPSHOTS)
+// ============================================================
+
+/*
+ * Relatórios longos (relatório de ocupação, listagem de estadias) leem as
+ * estadias por uma visão: um retrato do momento em que começaram, que não
+ * muda enquanto são lidos e que não trava as alterações. Isso funciona
+ * porque, depois de inserida, uma estadia só muda de situação:
+ *  - estadias novas vão para o fim; a visão guarda o total e ignora as
+ *    posições seguintes;
+ *  - cada encerramento recebe uma versão (versaoEncerramentos); a visão
+ *    guarda a versão em que começou e trata como ativas as estadias
+ *    encerradas depois dela (ver estadiaAtivaNaVisao);
+ *  - vetores que crescem enquanto há visões abertas não são realocados no
+ *    lugar: o vetor antigo fica retirado, ainda válido para as visões que o
+ *    usam, e só é liberado quando a última visão fecha.
+ *
+ * travaDados protege tabelas, índices e diário entre as threads do modo
+ * servidor; a visão a segura só enquanto é aberta.
+ */
+pthread_rwlock_t travaDados = PTHREAD_RWLOCK_INITIALIZER;  // Tabelas, índices e diário
+pthread_mutex_t travaVisoes = PTHREAD_MUTEX_INITIALIZER;   // Protege os três campos abaixo
+int visoesAtivas = 0;            // Visões abertas no momento
+void **vetoresRetirados = NULL;  // Vetores substituídos com visões abertas
+int totalRetirados = 0;
+int capacidadeRetirados = 0;
+
+/*
+ * Função: crescerVetor
+ * Objetivo: Realocar um vetor lido por visões para um tamanho maior
+ *           Sem visões abertas é um realloc; com visões abertas o conteúdo
+ *           é copiado para um vetor novo e o antigo fica retirado
+ * Parâmetros: vetor - vetor atual (pode ser NULL)
+ *             usados - bytes a preservar
+ *             novoTamanho - novo tamanho em bytes
+ * Retorno: void* - vetor novo (encerra o programa se faltar memória)
+ */
+void *crescerVetor(void *vetor, size_t usados, size_t novoTamanho)
+{
+    pthread_mutex_lock(&travaVisoes);
+    void *novo;
+    if (visoesAtivas == 0 || !vetor)
+        novo = realloc(vetor, novoTamanho);
+    else
+    {
+        novo = malloc(novoTamanho);
+        vetoresRetirados = garantirCapacidade(vetoresRetirados, &capacidadeRetirados,
+                                              totalRetirados + 1, sizeof(void *));
+        if (novo)
+        {
+            memcpy(novo, vetor, usados);
+            vetoresRetirados[totalRetirados++] = vetor;
+        }
+    }
+    pthread_mutex_unlock(&travaVisoes);
+
+    if (!novo)
+    {
+        printf("Erro: memoria insuficiente.\n");
+        exit(1);
+    }
+    return novo;
+}
+
+/*
+ * Função: garantirCapacidadeVisivel
+ * Objetivo: Igual a garantirCapacidade, para vetores lidos por visões
+ * Parâmetros: vetor - vetor atual (pode ser NULL)
+ *             capacidade - ponteiro para a capacidade atual (atualizada)
+ *             necessario - quantidade mínima de itens a comportar
+ *             tamanho - tamanho de cada item em bytes
+ * Retorno: void* - vetor (possivelmente outro)
+ */
+void *garantirCapacidadeVisivel(void *vetor, int *capacidade, int necessario, size_t tamanho)
+{
+    if (necessario <= *capacidade)
+        return vetor;
+
+    int nova = *capacidade > 0 ? *capacidade : 64;
+    while (nova < necessario)
+        nova *= 2;
+
+    vetor = crescerVetor(vetor, (size_t)*capacidade * tamanho, (size_t)nova * tamanho);
+    *capacidade = nova;
+    return vetor;
+}
+
+// ============================================================
+// ESTADIAS EM COLUNAS (CONSULTAS DE AGREGAÇÃO)
+// ============================================================
+
+/*
+ * Consultas que filtram por cliente e somam diárias leem só dois ou três
+ * campos de cada estadia. Para não percorrer as estruturas inteiras, cada
+ * campo usado nessas consultas também fica num vetor próprio, na mesma
+ * posição da estadia em tabelaEstadias. As datas ficam como número serial
+ * de dias, o que torna comparações de período simples subtrações.
+ *
+ * As estadias de um mesmo cliente formam uma lista encadeada pela coluna
+ * proximaDoCliente, em ordem de cadastro, que começa em
+ * primeiraEstadiaCliente. O histórico de um hóspede é lido em tempo
+ * proporcional às estadias dele, e não ao total do hotel.
+ */
+typedef struct
+{
+    int *codigoCliente;        // Cliente de cada estadia
+    int *numeroQuarto;         // Quarto de cada estadia
+    int *diaEntrada;           // Entrada em dias seriais (ver diaSerial)
+    int *diaSaida;             // Saída em dias seriais
+    int *quantidadeDiarias;    // Diárias de cada estadia
+    int *proximaDoCliente;     // Próxima estadia do mesmo cliente (-1 = última)
+    int *posicaoQuarto;        // Posição do quarto em tabelaQuartos (-1 = inexistente)
+    int *registroQuente;       // Registro da estadia em ARQ_ESTADIAS (-1 = no histórico)
+    unsigned int *versaoEncerramento;  // Versão do encerramento (0 = encerrada na carga ou ativa)
+    unsigned char *estadiaAtiva;  // 1 = ativa, 0 = finalizada (situação atual)
+    int capacidade;            // Posições alocadas em cada vetor
+} ColunasEstadias;
+
+ColunasEstadias colunasEstadias = {NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, 0};
+unsigned int versaoEncerramentos = 0;  // Versão do último encerramento feito nesta execução
+int estadiasAtivas = 0;          // Estadias ativas em memória
+int registrosQuentes = 0;        // Registros em ARQ_ESTADIAS (gravados ou a gravar)
+int registrosHistorico = 0;      // Registros de ARQ_HISTORICO já lidos
+int finalizadasNoQuente = 0;     // Estadias finalizadas que ainda estão em ARQ_ESTADIAS
+
+/*
+ * Função: garantirColunasEstadias
+ * Objetivo: Garantir espaço nas colunas para uma quantidade de estadias
+ * Parâmetros: necessario - quantidade mínima de estadias
+ * Retorno: void
+ */
+void garantirColunasEstadias(int necessario)
+{
+    if (necessario <= colunasEstadias.capacidade)
+        return;
+
+    int nova = colunasEstadias.capacidade > 0 ? colunasEstadias.capacidade : 64;
+    while (nova < necessario)
+        nova *= 2;
+
+    // As colunas são lidas por visões: crescem sem invalidar os vetores antigos
+    size_t antiga = (size_t)colunasEstadias.capacidade;
+    int **colunas[] = {&colunasEstadias.codigoCliente, &colunasEstadias.numeroQuarto,
+                       &colunasEstadias.diaEntrada, &colunasEstadias.diaSaida,
+                       &colunasEstadias.quantidadeDiarias, &colunasEstadias.proximaDoCliente,
+                       &colunasEstadias.posicaoQuarto, &colunasEstadias.registroQuente};
+    for (int i = 0; i < 8; i++)
+        *colunas[i] = crescerVetor(*colunas[i], antiga * sizeof(int), (size_t)nova * sizeof(int));
+    colunasEstadias.versaoEncerramento = crescerVetor(colunasEstadias.versaoEncerramento,
+                                                      antiga * sizeof(unsigned int),
+                                                      (size_t)nova * sizeof(unsigned int));
+    colunasEstadias.estadiaAtiva = crescerVetor(colunasEstadias.estadiaAtiva, antiga, (size_t)nova);
+    colunasEstadias.capacidade = nova;
+}
+
+/*
+ * Função: definirColunasEstadia
+ * Objetivo: Copiar os campos de uma estadia para as colunas e ligá-la ao
+ *           fim da lista de estadias do cliente
+ *           Chamada uma única vez por posição, sempre em ordem crescente
+ * Parâmetros: posicao - posição da estadia em tabelaEstadias
+ *             e - estadia
+ *             registro - registro em ARQ_ESTADIAS (-1 = no histórico)
+ * Retorno: void
+ */
+void definirColunasEstadia(int posicao, const Estadia *e, int registro)
+{
+    garantirColunasEstadias(posicao + 1);
+    colunasEstadias.codigoCliente[posicao] = e->codigoCliente;
+    colunasEstadias.numeroQuarto[posicao] = e->numeroQuarto;
+    colunasEstadias.diaEntrada[posicao] = diaSerial(e->dataEntrada);
+    colunasEstadias.diaSaida[posicao] = diaSerial(e->dataSaida);
+    colunasEstadias.quantidadeDiarias[posicao] = e->quantidadeDiarias;
+    colunasEstadias.posicaoQuarto[posicao] = mapaQuartosBuscar(e->numeroQuarto);
+    colunasEstadias.registroQuente[posicao] = registro;
+    colunasEstadias.versaoEncerramento[posicao] = 0;
+    colunasEstadias.estadiaAtiva[posicao] = e->estadiaAtiva != 0;
+    colunasEstadias.proximaDoCliente[posicao] = -1;
+    estadiasAtivas += e->estadiaAtiva != 0;
+    finalizadasNoQuente += registro >= 0 && !e->estadiaAtiva;
+
+    int ultima = indiceBuscar(&ultimaEstadiaCliente, e->codigoCliente);
+    if (ultima >= 0)
+        colunasEstadias.proximaDoCliente[ultima] = posicao;
+    else
+        indiceInserir(&primeiraEstadiaCliente, e->codigoCliente, posicao);
+    indiceInserir(&ultimaEstadiaCliente, e->codigoCliente, posicao);
+}
+
+/*
+ * Função: contarEstadiasAtivas
+ * Objetivo: Informar quantas estadias estão ativas (contador mantido nas
+ *           inserções e encerramentos, sem percorrer o histórico)
+ * Parâmetros: -
+ * Retorno: int - quantidade de estadias ativas
+ */
+int contarEstadiasAtivas()
+{
+    return estadiasAtivas;
+}
+
+/*
+ * Visão das estadias num momento (ver VISÕES DE LEITURA). Os ponteiros são
+ * os vetores vigentes na abertura; continuam válidos até fecharVisao mesmo
+ * que as tabelas cresçam. Os quartos são poucos e são copiados.
+ */
+typedef struct
+{
+    unsigned int versao;       // Encerramentos visíveis: os de versão <= esta
+    int totalEstadias;         // Estadias visíveis: posições 0..totalEstadias-1
+    const Estadia *estadias;   // Linhas das estadias (não mudam depois de inseridas)
+    const int *diaEntrada;     // Colunas usadas pelos relatórios
+    const int *diaSaida;
+    const int *posicaoQuarto;
+    const unsigned int *versaoEncerramento;
+    const unsigned char *estadiaAtiva;
+    int totalQuartos;          // Quartos no momento da abertura
+    Quarto *quartos;           // Cópia dos quartos
+} VisaoEstadias;
+
+/*
+ * Função: abrirVisao
+ * Objetivo: Abrir uma visão das estadias e quartos no momento atual
+ *           Não chamar com travaDados já segura pela mesma thread
+ * Parâmetros: v - visão a preencher
+ * Retorno: void
+ */
+void abrirVisao(VisaoEstadias *v)
+{
+    pthread_rwlock_rdlock(&travaDados);  // Nenhuma alteração pela metade
+    pthread_mutex_lock(&travaVisoes);
+    visoesAtivas++;
+    pthread_mutex_unlock(&travaVisoes);
+
+    v->versao = versaoEncerramentos;
+    v->totalEstadias = totalEstadias;
+    v->estadias = tabelaEstadias;
+    v->diaEntrada = colunasEstadias.diaEntrada;
+    v->diaSaida = colunasEstadias.diaSaida;
+    v->posicaoQuarto = colunasEstadias.posicaoQuarto;
+    v->versaoEncerramento = colunasEstadias.versaoEncerramento;
+    v->estadiaAtiva = colunasEstadias.estadiaAtiva;
+    v->totalQuartos = totalQuartos;
+    v->quartos = malloc((size_t)(totalQuartos > 0 ? totalQuartos : 1) * sizeof(Quarto));
+    if (!v->quartos)
+    {
+        printf("Erro: memoria insuficiente.\n");
+        exit(1);
+    }
+    if (totalQuartos > 0)
+        memcpy(v->quartos, tabelaQuartos, (size_t)totalQuartos * sizeof(Quarto));
+    pthread_rwlock_unlock(&travaDados);
+}
+
+/*
+ * Função: fecharVisao
+ * Objetivo: Fechar uma visão; a última a fechar libera os vetores retirados
+ * Parâmetros: v - visão aberta por abrirVisao
+ * Retorno: void
+ */
+void fecharVisao(VisaoEstadias *v)
+{
+    free(v->quartos);
+    v->quartos = NULL;
+
+    pthread_mutex_lock(&travaVisoes);
+    if (--visoesAtivas == 0)
+    {
+        for (int i = 0; i < totalRetirados; i++)
+            free(vetoresRetirados[i]);
+        totalRetirados = 0;
+    }
+    pthread_mutex_unlock(&travaVisoes);
+}
+
+/*
+ * Função: estadiaAtivaNaVisao
+ * Objetivo: Dizer se uma estadia estava ativa no momento da visão
+ *           A situação é lida antes da versão: marcarEstadiaFinalizada
+ *           grava a versão antes de zerar a situação
+ * Parâmetros: v - visão
+ *             posicao - posição da estadia (menor que v->totalEstadias)
+ * Retorno: int - 1 se ativa, 0 se finalizada
+ */
+int estadiaAtivaNaVisao(const VisaoEstadias *v, int posicao)
+{
+    if (__atomic_load_n(&v->estadiaAtiva[posicao], __ATOMIC_ACQUIRE))
+        return 1;
+    return __atomic_load_n(&v->versaoEncerramento[posicao], __ATOMIC_RELAXED) > v->versao;
+}
+
+/*
+ * Função: estadiaNaVisao
+ * Objetivo: Ler uma estadia como ela estava no momento da visão
+ * Parâmetros: v - visão
+ *             posicao - posição da estadia (menor que v->totalEstadias)
+ * Retorno: Estadia - cópia da estadia com a situação da visão
+ */
+Estadia estadiaNaVisao(const VisaoEstadias *v, int posicao)
+{
+    Estadia e = v->estadias[posicao];
+    e.estadiaAtiva = estadiaAtivaNaVisao(v, posicao);
+    return e;
+}
+
+/*
+ * Função: estadiaAtual
+ * Objetivo: Ler uma estadia com a situação atual (a linha em tabelaEstadias
+ *           guarda a situação da inserção; encerramentos mudam só a coluna)
+ * Parâmetros: posicao - posição da estadia em tabelaEstadias
+ * Retorno: Estadia - cópia da estadia
+ */
+Estadia estadiaAtual(int posicao)
+{
+    Estadia e = tabelaEstadias[posicao];
+    e.estadiaAtiva = colunasEstadias.estadiaAtiva[posicao];
+    return e;
+}
+
+// ============================================================
+// AGENDA DE OCUPAÇÃO DOS QUARTOS (DISPONIBILIDADE POR PERÍODO)
+// ============================================================
+
+/*
+ * Cada quarto tem a lista dos períodos [entrada, saída) das suas estadias
+ * ativas (hospedagens em curso e reservas futuras), em dias seriais e
+ * ordenada pela entrada. Como dois períodos ativos de um mesmo quarto
+ * nunca se sobrepõem, as saídas ficam na mesma ordem e verificar se o
+ * quarto está livre num período é uma busca binária.
+ *
+ * O campo estaOcupado de Quarto passa a ser derivado: 1 se hoje está
+ * dentro de algum período da agenda (entrada <= hoje < saída). Reservas
+ * futuras não ocupam o quarto. Como o valor muda com o calendário, quem
+ * mostra o status o calcula na hora (quartoOcupadoNoDia); o campo na
+ * memória e no arquivo só guarda o valor da última alteração do quarto.
+ */
+typedef struct
+{
+    int *entradas;    // Dia serial de entrada de cada estadia ativa
+    int *saidas;      // Dia serial de saída (o quarto fica livre neste dia)
+    int *estadias;    // Posição da estadia em tabelaEstadias
+    int quantidade;   // Estadias ativas do quarto
+    int capacidade;   // Posições alocadas
+} AgendaQuarto;
+
+AgendaQuarto *agendasQuartos = NULL;  // Uma agenda por quarto (mesma posição de tabelaQuartos)
+int capacidadeAgendas = 0;
+
+/*
+ * Função: agendaNovoQuarto
+ * Objetivo: Criar a agenda vazia de um quarto recém-inserido
+ * Parâmetros: posicao - posição do quarto em tabelaQuartos
+ * Retorno: void
+ */
+void agendaNovoQuarto(int posicao)
+{
+    agendasQuartos = garantirCapacidade(agendasQuartos, &capacidadeAgendas,
+                                        posicao + 1, sizeof(AgendaQuarto));
+    memset(&agendasQuartos[posicao], 0, sizeof(AgendaQuarto));
+}
+
+/*
+ * Função: agendaPrimeiraSaidaApos
+ * Objetivo: Localizar, na agenda, o primeiro período que termina depois de um dia
+ * Parâmetros: agenda - agenda do quarto
+ *             dia - dia serial
+ * Retorno: int - índice do período (quantidade se nenhum termina depois)
+ */
+int agendaPrimeiraSaidaApos(const AgendaQuarto *agenda, int dia)
+{
+    int inicio = 0, fim = agenda->quantidade;
+    while (inicio < fim)
+    {
+        int meio = inicio + (fim - inicio) / 2;
+        if (agenda->saidas[meio] <= dia)
+            inicio = meio + 1;
+        else
+            fim = meio;
+    }
+    return inicio;
+}
+
+/*
+ * Função: quartoLivreNoPeriodo
+ * Objetivo: Verificar se um quarto não tem estadia ativa no período
+ * Parâmetros: posicao - posição do quarto em tabelaQuartos
+ *             entrada, saida - período em dias seriais (saída exclusiva)
+ * Retorno: int - 1 se livre, 0 se há conflito
+ */
+int quartoLivreNoPeriodo(int posicao, int entrada, int saida)
+{
+    const AgendaQuarto *agenda = &agendasQuartos[posicao];
+    int i = agendaPrimeiraSaidaApos(agenda, entrada);
+    return i == agenda->quantidade || agenda->entradas[i] >= saida;
+}
+
+/*
+ * Função: quartoOcupadoNoDia
+ * Objetivo: Verificar se um quarto tem hóspede num dia (estadia ativa com
+ *           entrada <= dia < saída)
+ * Parâmetros: posicao - posição do quarto em tabelaQuartos
+ *             dia - dia serial
+ * Retorno: int - 1 se ocupado, 0 se livre
+ */
+int quartoOcupadoNoDia(int posicao, int dia)
+{
+    const AgendaQuarto *agenda = &agendasQuartos[posicao];
+    int i = agendaPrimeiraSaidaApos(agenda, dia);
+    return i < agenda->quantidade && agenda->entradas[i] <= dia;
+}
+
+/*
+ * Função: quartoNoDia
+ * Objetivo: Copiar um quarto com o status de ocupação de um dia (para exibir)
+ * Parâmetros: posicao - posição do quarto em tabelaQuartos
+ *             dia - dia serial (em geral, hoje)
+ * Retorno: Quarto - cópia com estaOcupado calculado pela agenda
+ */
+Quarto quartoNoDia(int posicao, int dia)
+{
+    Quarto q = tabelaQuartos[posicao];
+    q.estaOcupado = quartoOcupadoNoDia(posicao, dia);
+    return q;
+}
+
+/*
+ * Função: quartoDisponivel
+ * Objetivo: Verificar se um quarto comporta os hóspedes e está livre
+ * Parâmetros: posicao - posição do quarto em tabelaQuartos
+ *             hospedes - quantidade de hóspedes
+ *             entrada, saida - período em dias seriais (saída exclusiva)
+ * Retorno: int - 1 se disponível, 0 caso contrário
+ */
+int quartoDisponivel(int posicao, int hospedes, int entrada, int saida)
+{
+    if (tabelaQuartos[posicao].capacidade < hospedes)
+        return 0;
+    return quartoLivreNoPeriodo(posicao, entrada, saida);
+}
+
+/*
+ * Função: agendaInserir
+ * Objetivo: Acrescentar uma estadia ativa à agenda do seu quarto e
+ *           atualizar o status de hoje do quarto na memória
+ * Parâmetros: posicaoEstadia - posição da estadia em tabelaEstadias
+ * Retorno: void
+ */
+void agendaInserir(int posicaoEstadia)
+{
+    int posicao = mapaQuartosBuscar(colunasEstadias.numeroQuarto[posicaoEstadia]);
+    if (posicao < 0)
+        return;
+
+    AgendaQuarto *agenda = &agendasQuartos[posicao];
+    if (agenda->quantidade == agenda->capacidade)
+    {
+        int nova = agenda->capacidade > 0 ? agenda->capacidade * 2 : 4;
+        int *entradas = realloc(agenda->entradas, (size_t)nova * sizeof(int));
+        int *saidas = entradas ? realloc(agenda->saidas, (size_t)nova * sizeof(int)) : NULL;
+        int *estadias = saidas ? realloc(agenda->estadias, (size_t)nova * sizeof(int)) : NULL;
+        if (!estadias)
+        {
+            printf("Erro: memoria insuficiente.\n");
+            exit(1);
+        }
+        agenda->entradas = entradas;
+        agenda->saidas = saidas;
+        agenda->estadias = estadias;
+        agenda->capacidade = nova;
+    }
+
+    // Desloca os períodos posteriores para manter a ordem por entrada
+    int entrada = colunasEstadias.diaEntrada[posicaoEstadia];
+    int i = agenda->quantidade;
+    while (i > 0 && agenda->entradas[i - 1] > entrada)
+    {
+        agenda->entradas[i] = agenda->entradas[i - 1];
+        agenda->saidas[i] = agenda->saidas[i - 1];
+        agenda->estadias[i] = agenda->estadias[i - 1];
+        i--;
+    }
+    agenda->entradas[i] = entrada;
+    agenda->saidas[i] = colunasEstadias.diaSaida[posicaoEstadia];
+    agenda->estadias[i] = posicaoEstadia;
+    agenda->quantidade++;
+
+    tabelaQuartos[posicao].estaOcupado = quartoOcupadoNoDia(posicao, diaSerialHoje());
+}
+
+/*
+ * Função: agendaRemover
+ * Objetivo: Retirar uma estadia da agenda do seu quarto e atualizar o
+ *           estado derivado do quarto na memória
+ * Parâmetros: posicaoEstadia - posição da estadia em tabelaEstadias
+ * Retorno: void
+ */
+void agendaRemover(int posicaoEstadia)
+{
+    int posicao = mapaQuartosBuscar(colunasEstadias.numeroQuarto[posicaoEstadia]);
+    if (posicao < 0)
+        return;
+
+    AgendaQuarto *agenda = &agendasQuartos[posicao];
+    for (int i = agendaPrimeiraSaidaApos(agenda, colunasEstadias.diaEntrada[posicaoEstadia]);
+         i < agenda->quantidade; i++)
+        if (agenda->estadias[i] == posicaoEstadia)
+        {
+            int restantes = agenda->quantidade - i - 1;
+            memmove(&agenda->entradas[i], &agenda->entradas[i + 1], (size_t)restantes * sizeof(int));
+            memmove(&agenda->saidas[i], &agenda->saidas[i + 1], (size_t)restantes * sizeof(int));
+            memmove(&agenda->estadias[i], &agenda->estadias[i + 1], (size_t)restantes * sizeof(int));
+            agenda->quantidade--;
+            break;
+        }
+
+    tabelaQuartos[posicao].estaOcupado = quartoOcupadoNoDia(posicao, diaSerialHoje());
+}
+
+/*
+ * Função: quartoOcupadoHoje
+ * Objetivo: Consultar, pela agenda, se um quarto tem hóspede hoje
+ * Parâmetros: numero - número do quarto
+ * Retorno: int - 1 se há estadia em curso hoje, 0 caso contrário
+ */
+int quartoOcupadoHoje(int numero)
+{
+    int posicao = mapaQuartosBuscar(numero);
+    return posicao >= 0 && quartoOcupadoNoDia(posicao, diaSerialHoje());
+}
+
+// ============================================================
+// LIVRO DE FIDELIDADE (SALDO DE PONTOS POR CLIENTE)
+// ============================================================
+
+/*
+ * Cada cliente tem um saldo com o total de estadias, diárias, estadias
+ * ativas, pontos acumulados e pontos resgatados, na mesma posição do
+ * cliente em tabelaClientes. O saldo é atualizado a cada nova estadia e a
+ * cada encerramento, então consultar pontos não depende do histórico.
+ *
+ * O livro é gravado em ARQ_FIDELIDADE nos checkpoints, quando a memória e
+ * os arquivos de dados coincidem. O cabeçalho registra quantos clientes,
+ * estadias e estadias ativas existiam na gravação; se não bater com os
+ * dados carregados (queda entre checkpoints) o livro é recalculado a partir
+ * das estadias, preservando os pontos resgatados.
+ *
+ * Resgates (resgatarPontos) passam pelo diário como as demais alterações
+ * e, por não serem deduzíveis das estadias, regravam o livro assim que
+ * confirmados. Os outros processos percebem a mudança pela soma do
+ * cabeçalho e trazem os resgates do arquivo (acompanharResgates).
+ * Enquanto o livro não for gravado o checkpoint mantém o diário, a única
+ * outra cópia dos resgates.
+ */
+#define PONTOS_POR_DIARIA 10
+
+const char *ARQ_FIDELIDADE = "fidelidade.bin";
+const char *ARQ_FIDELIDADE_NOVO = "fidelidade.novo";  // Livro novo em gravação
+
+/*
+ * Cabeçalho do livro gravado por versões anteriores (struct como estava na
+ * memória, seguida dos saldos); lido só para recuperar os resgates
+ */
+typedef struct
+{
+    int clientes;          // Clientes cobertos pelo livro
+    int estadias;          // Estadias contabilizadas
+    int estadiasAtivas;    // Estadias ativas na gravação
+    unsigned int soma;     // Soma de verificação dos saldos
+} CabecalhoFidelidade;
+
+SaldoFidelidade *saldosFidelidade = NULL;  // Um saldo por cliente (mesma posição)
+int capacidadeSaldos = 0;
+int fidelidadeAlterada = 0;                // Livro difere do arquivo
+unsigned int somaFidelidadeConhecida = 0;  // Soma do livro na última leitura/gravação
+
+/*
+ * Função: somaVerificacao
+ * Objetivo: Calcular a soma de verificação (FNV-1a) de um bloco de bytes
+ * Parâmetros: dados - bytes a verificar
+ *             tamanho - quantidade de bytes
+ * Retorno: unsigned int - soma calculada
+ */
+unsigned int somaVerificacao(const void *dados, size_t tamanho)
+{
+    const unsigned char *bytes = dados;
+    unsigned int h = 2166136261u;
+    for (size_t i = 0; i < tamanho; i++)
+    {
+        h ^= bytes[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/*
+ * Função: fidelidadeNovoCliente
+ * Objetivo: Criar o saldo zerado de um cliente recém-inserido
+ * Parâmetros: posicao - posição do cliente em tabelaClientes
+ *             codigoCliente - código do cliente
+ * Retorno: void
+ */
+void fidelidadeNovoCliente(int posicao, int codigoCliente)
+{
+    saldosFidelidade = garantirCapacidade(saldosFidelidade, &capacidadeSaldos,
+                                          posicao + 1, sizeof(SaldoFidelidade));
+    memset(&saldosFidelidade[posicao], 0, sizeof(SaldoFidelidade));
+    saldosFidelidade[posicao].codigoCliente = codigoCliente;
+    fidelidadeAlterada = 1;
+}
+
+/*
+ * Função: fidelidadeRegistrarEstadia
+ * Objetivo: Somar uma estadia ao saldo do cliente dela
+ * Parâmetros: e - estadia registrada
+ * Retorno: void
+ */
+void fidelidadeRegistrarEstadia(const Estadia *e)
+{
+    int posicao = indiceBuscar(&indiceClientes, e->codigoCliente);
+    if (posicao < 0)
+        return;
+
+    SaldoFidelidade *s = &saldosFidelidade[posicao];
+    s->totalEstadias++;
+    s->totalDiarias += e->quantidadeDiarias;
+    s->pontos += e->quantidadeDiarias * PONTOS_POR_DIARIA;
+    if (e->estadiaAtiva)
+        s->estadiasAtivas++;
+    fidelidadeAlterada = 1;
+}
+
+/*
+ * Função: calcularSaldos
+ * Objetivo: Recalcular todos os saldos a partir das estadias em memória
+ *           (sem pontos resgatados, que não são deduzíveis das estadias)
+ * Parâmetros: saldos - vetor com um saldo por cliente, a preencher
+ * Retorno: void
+ */
+void calcularSaldos(SaldoFidelidade *saldos)
+{
+    for (int i = 0; i < totalClientes; i++)
+    {
+        memset(&saldos[i], 0, sizeof(SaldoFidelidade));
+        saldos[i].codigoCliente = tabelaClientes[i].codigoCliente;
+    }
+
+    for (int i = 0; i < totalEstadias; i++)
+    {
+        int posicao = indiceBuscar(&indiceClientes, colunasEstadias.codigoCliente[i]);
+        if (posicao < 0)
+            continue;
+        saldos[posicao].totalEstadias++;
+        saldos[posicao].totalDiarias += colunasEstadias.quantidadeDiarias[i];
+        saldos[posicao].pontos += colunasEstadias.quantidadeDiarias[i] * PONTOS_POR_DIARIA;
+        saldos[posicao].estadiasAtivas += colunasEstadias.estadiaAtiva[i];
+    }
+}
+
+/*
+ * Função: somaSaldos
+ * Objetivo: CRC32C dos saldos como ficam no arquivo; vai no cabeçalho do
+ *           livro para os outros processos perceberem uma mudança lendo
+ *           só o cabeçalho (acompanharResgates)
+ * Parâmetros: -
+ * Retorno: unsigned int - soma dos saldos de todos os clientes
+ */
+unsigned int somaSaldos()
+{
+    unsigned char bytes[TAMANHO_MAXIMO_REGISTRO];
+    unsigned int soma = 0;
+    for (int i = 0; i < totalClientes; i++)
+    {
+        codificarRegistro(REGISTRO_FIDELIDADE, &saldosFidelidade[i], bytes);
+        soma = continuarCrc32c(soma, bytes, (size_t)tamanhoNoDisco(REGISTRO_FIDELIDADE));
+    }
+    return soma;
+}
+
+/*
+ * Função: salvarFidelidade
+ * Objetivo: Gravar o livro de fidelidade (chamada nos checkpoints)
+ *           Só grava se algum saldo mudou desde a última gravação. O livro
+ *           novo é gravado à parte e só então toma o lugar do antigo: uma
+ *           queda no meio nunca deixa o arquivo truncado
+ *           Palavras próprias do cabeçalho: estadias e estadias ativas
+ *           contabilizadas e a soma dos saldos (somaSaldos)
+ * Parâmetros: -
+ * Retorno: int - 1 se o livro em disco está em dia, 0 se a gravação falhou
+ */
+int salvarFidelidade()
+{
+    if (!fidelidadeAlterada || somenteLeitura)
+        return 1;
+
+    CabecalhoArquivo modelo = {REGISTRO_FIDELIDADE, 0, 1,
+                               {totalEstadias, contarEstadiasAtivas(), (int)somaSaldos()}};
+    if (!gravarTrocando(ARQ_FIDELIDADE, ARQ_FIDELIDADE_NOVO, &modelo, saldosFidelidade, totalClientes))
+    {
+        printf("Erro: nao foi possivel gravar %s.\n", ARQ_FIDELIDADE);
+        return 0;  // O livro antigo fica intacto e fidelidadeAlterada continua 1
+    }
+    fidelidadeAlterada = 0;
+    somaFidelidadeConhecida = (unsigned int)modelo.complemento[2];
+    return 1;
+}
+
+/*
+ * Função: lerLivroAntigo
+ * Objetivo: Ler os saldos de um livro gravado por versões anteriores
+ *           (CabecalhoFidelidade e saldos como structs da memória)
+ * Parâmetros: quantidade - ponteiro para a quantidade de saldos lidos
+ * Retorno: SaldoFidelidade* - vetor alocado (NULL se não há livro antigo)
+ */
+SaldoFidelidade *lerLivroAntigo(int *quantidade)
+{
+    *quantidade = 0;
+    FILE *arq = fopen(ARQ_FIDELIDADE, "rb");
+    if (!arq)
+        return NULL;
+
+    CabecalhoFidelidade cab;
+    SaldoFidelidade s, *saldos = NULL;
+    int capacidade = 0;
+    if (fread(&cab, sizeof(cab), 1, arq) == 1 &&
+        !temAssinatura((const unsigned char *)&cab, sizeof(cab)))
+    {
+        while (fread(&s, sizeof(s), 1, arq) == 1)
+        {
+            saldos = garantirCapacidade(saldos, &capacidade, *quantidade + 1, sizeof(SaldoFidelidade));
+            saldos[(*quantidade)++] = s;
+        }
+    }
+    fclose(arq);
+    return saldos;
+}
+
+/*
+ * Função: recuperarResgates
+ * Objetivo: Trazer do arquivo do livro os pontos resgatados de cada
+ *           cliente (pelo código); resgates só aumentam, então fica o
+ *           maior valor entre a memória e o arquivo
+ *           Um livro de versão anterior também é lido, para a conversão
+ *           não perder os resgates
+ * Parâmetros: -
+ * Retorno: void
+ */
+void recuperarResgates()
+{
+    CabecalhoArquivo cab;
+    int lidos;
+    SaldoFidelidade *saldos = lerArquivoRecriavel(ARQ_FIDELIDADE, REGISTRO_FIDELIDADE, &cab, &lidos);
+    if (saldos)
+        somaFidelidadeConhecida = (unsigned int)cab.complemento[2];
+    else
+        saldos = lerLivroAntigo(&lidos);
+
+    for (int i = 0; i < lidos; i++)
+    {
+        int posicao = indiceBuscar(&indiceClientes, saldos[i].codigoCliente);
+        if (posicao >= 0 && saldos[i].pontosResgatados > saldosFidelidade[posicao].pontosResgatados)
+        {
+            saldosFidelidade[posicao].pontosResgatados = saldos[i].pontosResgatados;
+            fidelidadeAlterada = 1;
+        }
+    }
+    free(saldos);
+}
+
+/*
+ * Função: acompanharResgates
+ * Objetivo: Trazer os resgates gravados por outros processos: só relê o
+ *           livro se a soma do cabeçalho mudou desde a última leitura
+ * Parâmetros: -
+ * Retorno: void
+ */
+void acompanharResgates()
+{
+    FILE *arq = fopen(ARQ_FIDELIDADE, "rb");
+    if (!arq)
+        return;
+    unsigned char bytes[TAMANHO_CABECALHO];
+    size_t lidos = fread(bytes, 1, sizeof(bytes), arq);
+    fclose(arq);
+
+    CabecalhoArquivo cab;
+    if (conferirCabecalho(bytes, lidos, REGISTRO_FIDELIDADE, &cab) == 0 &&
+        (unsigned int)cab.complemento[2] != somaFidelidadeConhecida)
+        recuperarResgates();
+}
+
+/*
+ * Função: reconstruirFidelidade
+ * Objetivo: Recalcular o livro a partir das estadias, mantendo os pontos
+ *           resgatados que estiverem no arquivo
+ * Parâmetros: -
+ * Retorno: int - 1 se o livro recalculado foi gravado
+ */
+int reconstruirFidelidade()
+{
+    saldosFidelidade = garantirCapacidade(saldosFidelidade, &capacidadeSaldos,
+                                          totalClientes, sizeof(SaldoFidelidade));
+    calcularSaldos(saldosFidelidade);
+
+    // Resgates só existem no arquivo: recupera cada um pelo código do cliente
+    recuperarResgates();
+
+    fidelidadeAlterada = 1;
+    return salvarFidelidade();
+}
+
+/*
+ * Função: carregarFidelidade
+ * Objetivo: Ler o livro de fidelidade, ou recalculá-lo se estiver ausente,
+ *           corrompido ou desatualizado em relação aos dados carregados
+ * Parâmetros: -
+ * Retorno: void
+ */
+void carregarFidelidade()
+{
+    saldosFidelidade = garantirCapacidade(saldosFidelidade, &capacidadeSaldos,
+                                          totalClientes, sizeof(SaldoFidelidade));
+
+    CabecalhoArquivo cab;
+    int lidos;
+    SaldoFidelidade *saldos = lerArquivoRecriavel(ARQ_FIDELIDADE, REGISTRO_FIDELIDADE, &cab, &lidos);
+    int valido = saldos && lidos == totalClientes && cab.complemento[0] == totalEstadias &&
+                 cab.complemento[1] == contarEstadiasAtivas();  // Encerramentos não gravados mudam este total
+    if (valido)
+    {
+        memcpy(saldosFidelidade, saldos, (size_t)totalClientes * sizeof(SaldoFidelidade));
+        somaFidelidadeConhecida = (unsigned int)cab.complemento[2];
+    }
+    free(saldos);
+
+    if (!valido)
+        reconstruirFidelidade();  // Também converte um livro de versão anterior
+}
+
+/*
+ * Função: verificarFidelidade
+ * Objetivo: Comparar o livro com um recálculo completo a partir das estadias
+ * Parâmetros: saida - destino das divergências encontradas
+ * Retorno: int - quantidade de clientes com saldo divergente
+ */
+int verificarFidelidade(FILE *saida)
+{
+    SaldoFidelidade *recalculados = malloc((size_t)(totalClientes > 0 ? totalClientes : 1) *
+                                           sizeof(SaldoFidelidade));
+    if (!recalculados)
+    {
+        printf("Erro: memoria insuficiente.\n");
+        exit(1);
+    }
+    calcularSaldos(recalculados);
+
+    int divergentes = 0;
+    for (int i = 0; i < totalClientes; i++)
+    {
+        const SaldoFidelidade *livro = &saldosFidelidade[i], *real = &recalculados[i];
+        if (livro->codigoCliente != real->codigoCliente || livro->totalEstadias != real->totalEstadias ||
+            livro->totalDiarias != real->totalDiarias || livro->estadiasAtivas != real->estadiasAtivas ||
+            livro->pontos != real->pontos)
+        {
+            fprintf(saida, "%d\t%d/%d estadias\t%d/%d diarias\t%d/%d pontos\n",
+                    real->codigoCliente, livro->totalEstadias, real->totalEstadias,
+                    livro->totalDiarias, real->totalDiarias, livro->pontos, real->pontos);
+            divergentes++;
+        }
+    }
+    free(recalculados);
+    return divergentes;
+}
+
+/*
+ * Função: saldoCliente
+ * Objetivo: Obter o saldo de fidelidade de um cliente
+ * Parâmetros: codigoCliente - código do cliente
+ * Retorno: const SaldoFidelidade* - saldo, ou NULL se o cliente não existe
+ */
+const SaldoFidelidade *saldoCliente(int codigoCliente)
+{
+    int posicao = indiceBuscar(&indiceClientes, codigoCliente);
+    return posicao >= 0 ? &saldosFidelidade[posicao] : NULL;
+}
+
+/*
+ * Função: marcarEstadiaFinalizada
+ * Objetivo: Marcar uma estadia como finalizada na memória (coluna com nova
+ *           versão, agenda do quarto e saldo do cliente); não faz nada se
+ *           ela já estava finalizada
+ * Parâmetros: posicao - posição da estadia em tabelaEstadias
+ * Retorno: void
+ */
+void marcarEstadiaFinalizada(int posicao)
+{
+    if (!colunasEstadias.estadiaAtiva[posicao])
+        return;
+
+    // Visões abertas antes desta versão continuam vendo a estadia ativa
+    __atomic_store_n(&colunasEstadias.versaoEncerramento[posicao], ++versaoEncerramentos,
+                     __ATOMIC_RELAXED);
+    __atomic_store_n(&colunasEstadias.estadiaAtiva[posicao], 0, __ATOMIC_RELEASE);
+    estadiasAtivas--;
+    if (colunasEstadias.registroQuente[posicao] >= 0)
+        finalizadasNoQuente++;  // Candidata à próxima compactação
+    agendaRemover(posicao);  // Libera o período na agenda do quarto
+
+    int cliente = indiceBuscar(&indiceClientes, colunasEstadias.codigoCliente[posicao]);
+    if (cliente >= 0)
+    {
+        saldosFidelidade[cliente].estadiasAtivas--;
+        fidelidadeAlterada = 1;
+    }
+}
+
+/*
+ * Função: construirIndices
+ * Objetivo: Montar os índices em memória a partir das tabelas carregadas
+ * Parâmetros: -
+ * Retorno: void
+ */
+void construirIndices()
+{
+    for (int i = 0; i < totalClientes; i++)
+    {
+        indiceInserir(&indiceClientes, tabelaClientes[i].codigoCliente, i);
+        definirNomeDobrado(&nomesDobradosClientes, &capacidadeDobradosClientes, i,
+                           tabelaClientes[i].nome, sizeof(tabelaClientes[i].nome));
+        trigramasIndexar(&trigramasClientes, nomesDobradosClientes[i], TAMANHO_DOBRADO, i);
+    }
+
+    for (int i = 0; i < totalFuncionarios; i++)
+    {
+        definirNomeDobrado(&nomesDobradosFuncionarios, &capacidadeDobradosFuncionarios, i,
+                           tabelaFuncionarios[i].nome, sizeof(tabelaFuncionarios[i].nome));
+        trigramasIndexar(&trigramasFuncionarios, nomesDobradosFuncionarios[i], TAMANHO_DOBRADO, i);
+    }
+
+    for (int i = 0; i < totalQuartos; i++)
+    {
+        mapaQuartosDefinir(tabelaQuartos[i].numeroQuarto, i);
+        agendaNovoQuarto(i);
+        tabelaQuartos[i].estaOcupado = 0;  // Derivado da agenda, refeito abaixo
+    }
+
+    for (int i = 0; i < totalEstadias; i++)
+    {
+        indiceInserir(&indiceEstadias, tabelaEstadias[i].codigoEstadia, i);
+        // O histórico vem antes das estadias de ARQ_ESTADIAS (ver carregarEstadias)
+        int registro = i < registrosHistorico ? -1 : i - registrosHistorico;
+        definirColunasEstadia(i, &tabelaEstadias[i], registro);
+        if (tabelaEstadias[i].estadiaAtiva)
+            agendaInserir(i);
+    }
+}
+
+/*
+ * Função: inserirClienteTabela
+ * Objetivo: Acrescentar um cliente à tabela em memória e aos índices
+ * Parâmetros: c - cliente a inserir
+ * Retorno: void
+ */
+void inserirClienteTabela(Cliente c)
+{
+    tabelaClientes = garantirCapacidade(tabelaClientes, &capacidadeClientes,
+                                        totalClientes + 1, sizeof(Cliente));
+    indiceInserir(&indiceClientes, c.codigoCliente, totalClientes);
+    definirNomeDobrado(&nomesDobradosClientes, &capacidadeDobradosClientes, totalClientes,
+                       c.nome, sizeof(c.nome));
+    trigramasIndexar(&trigramasClientes, nomesDobradosClientes[totalClientes], TAMANHO_DOBRADO, totalClientes);
+    fidelidadeNovoCliente(totalClientes, c.codigoCliente);
+    tabelaClientes[totalClientes++] = c;
+}
+
+/*
+ * Função: inserirFuncionarioTabela
+ * Objetivo: Acrescentar um funcionário à tabela em memória e ao índice de nomes
+ * Parâmetros: f - funcionário a inserir
+ * Retorno: void
+ */
+void inserirFuncionarioTabela(Funcionario f)
+{
+    tabelaFuncionarios = garantirCapacidade(tabelaFuncionarios, &capacidadeFuncionarios,
+                                            totalFuncionarios + 1, sizeof(Funcionario));
+    definirNomeDobrado(&nomesDobradosFuncionarios, &capacidadeDobradosFuncionarios, totalFuncionarios,
+                       f.nome, sizeof(f.nome));
+    trigramasIndexar(&trigramasFuncionarios, nomesDobradosFuncionarios[totalFuncionarios],
+                     TAMANHO_DOBRADO, totalFuncionarios);
+    tabelaFuncionarios[totalFuncionarios++] = f;
+}
+
+/*
+ * Função: inserirQuartoTabela
+ * Objetivo: Acrescentar um quarto à tabela em memória, ao mapa por número
+ *           e criar sua agenda
+ * Parâmetros: q - quarto a inserir
+ * Retorno: void
+ */
+void inserirQuartoTabela(Quarto q)
+{
+    tabelaQuartos = garantirCapacidade(tabelaQuartos, &capacidadeQuartos,
+                                       totalQuartos + 1, sizeof(Quarto));
+    mapaQuartosDefinir(q.numeroQuarto, totalQuartos);
+    agendaNovoQuarto(totalQuartos);
+    tabelaQuartos[totalQuartos++] = q;
+}
+
+/*
+ * Função: inserirEstadiaTabela
+ * Objetivo: Acrescentar uma estadia à tabela em memória, ao índice, às
+ *           colunas e, se ativa, à agenda do quarto
+ *           A estadia fica com o próximo registro de ARQ_ESTADIAS, onde
+ *           será gravada na mesma ordem em que entra na memória
+ * Parâmetros: e - estadia a inserir
+ * Retorno: void
+ */
+void inserirEstadiaTabela(Estadia e)
+{
+    tabelaEstadias = garantirCapacidadeVisivel(tabelaEstadias, &capacidadeEstadias,
+                                               totalEstadias + 1, sizeof(Estadia));
+    indiceInserir(&indiceEstadias, e.codigoEstadia, totalEstadias);
+    definirColunasEstadia(totalEstadias, &e, registrosQuentes++);
+    fidelidadeRegistrarEstadia(&e);
+    if (e.estadiaAtiva)
+        agendaInserir(totalEstadias);
+    tabelaEstadias[totalEstadias++] = e;
+}
+
+// ============================================================
+// SEGMENTOS DE ESTADIAS (QUENTE E HISTÓRICO)
+// ============================================================
+
+/*
+ * As estadias ficam em dois arquivos:
+ *   ARQ_ESTADIAS  - segmento quente: estadias ativas (hospedagens e
+ *                   reservas) e as finalizadas desde a última compactação;
+ *                   novas estadias vão para o fim e encerramentos são
+ *                   gravados no lugar
+ *   ARQ_HISTORICO - segmento frio: estadias finalizadas, compactadas em
+ *                   blocos; só recebe blocos no fim e nunca os altera
+ * Na memória o histórico vem primeiro, seguido do segmento quente, e a
+ * coluna registroQuente diz onde cada estadia está em ARQ_ESTADIAS.
+ * Encerramentos e a leitura do que outros processos gravaram só tocam o
+ * segmento quente, que fica pequeno.
+ *
+ * Quando as finalizadas no segmento quente passam de LIMITE_COMPACTACAO e
+ * são pelo menos metade dele, o checkpoint do diário as move para o
+ * histórico (compactarEstadias). A troca é retomada de onde parou se o
+ * programa cair no meio (concluirCompactacao): ARQ_COMPACTACAO guarda onde
+ * as finalizadas entram no histórico, e ARQ_ESTADIAS_NOVO só deixa de
+ * existir quando o novo segmento quente substitui o antigo.
+ */
+#define LIMITE_COMPACTACAO 4096   // Finalizadas no segmento quente que disparam a compactação
+
+const char *ARQ_ESTADIAS_NOVO = "estadias.novo";        // Novo segmento quente em montagem
+const char *ARQ_COMPACTACAO = "compactacao.pendente";   // Compactação em andamento
+
+/*
+ * Função: sincronizarSegmentos
+ * Objetivo: Acertar as estadias em memória com os dois segmentos: estadias
+ *           gravadas por outros processos, encerramentos e o registro de
+ *           cada estadia em ARQ_ESTADIAS (que muda a cada compactação)
+ *           Chamada com a trava dos dados e sem operações pendentes
+ * Parâmetros: -
+ * Retorno: void
+ */
+void sincronizarSegmentos()
+{
+    // Histórico: só o que foi acrescentado desde a última leitura
+    int novos;
+    Estadia *historico = lerHistorico(ARQ_HISTORICO, registrosHistorico, &novos, 0);
+    for (int i = 0; i < novos; i++)
+    {
+        int posicao = indiceBuscar(&indiceEstadias, historico[i].codigoEstadia);
+        if (posicao < 0)
+        {
+            // Gravada e compactada por outro processo sem passar por esta memória
+            inserirEstadiaTabela(historico[i]);
+            posicao = totalEstadias - 1;
+        }
+        else
+            marcarEstadiaFinalizada(posicao);
+        colunasEstadias.registroQuente[posicao] = -1;
+    }
+    registrosHistorico += novos;
+    free(historico);
+
+    // Segmento quente: inteiro, pois pode ter sido trocado
+    int total, finalizadas = 0;
+    Estadia *quentes = lerRegistros(ARQ_ESTADIAS, REGISTRO_ESTADIA, 0, &total, 0);
+    for (int i = 0; i < total; i++)
+    {
+        int posicao = indiceBuscar(&indiceEstadias, quentes[i].codigoEstadia);
+        if (posicao < 0)
+        {
+            inserirEstadiaTabela(quentes[i]);
+            posicao = totalEstadias - 1;
+        }
+        else if (!quentes[i].estadiaAtiva)
+            marcarEstadiaFinalizada(posicao);
+        colunasEstadias.registroQuente[posicao] = i;
+        finalizadas += !quentes[i].estadiaAtiva;
+    }
+    free(quentes);
+    registrosQuentes = total;
+    finalizadasNoQuente = finalizadas;
+}
+
+/*
+ * Função: trocarSegmentoQuente
+ * Objetivo: Gravar as finalizadas de ARQ_ESTADIAS no histórico a partir de
+ *           um registro e trocar ARQ_ESTADIAS pelas ativas
+ *           Pode ser repetida: parte sempre do ARQ_ESTADIAS atual
+ * Parâmetros: inicio - índice, no histórico, da primeira finalizada
+ * Retorno: int - quantidade de estadias movidas para o histórico
+ */
+int trocarSegmentoQuente(int inicio)
+{
+    int total, movidas = 0;
+    Estadia *quentes = lerRegistros(ARQ_ESTADIAS, REGISTRO_ESTADIA, 0, &total, 0);
+
+    EscritaRegistros novo;
+    if (!abrirEscrita(&novo, ARQ_ESTADIAS_NOVO, REGISTRO_ESTADIA, 0))
+    {
+        printf("Erro: nao foi possivel compactar %s.\n", ARQ_ESTADIAS);
+        exit(1);  // ARQ_COMPACTACAO fica: a próxima execução retoma
+    }
+    int ok = 1;
+    for (int i = 0; i < total && ok; i++)
+    {
+        if (quentes[i].estadiaAtiva)
+            ok = escreverRegistro(&novo, &quentes[i]);
+        else
+            quentes[movidas++] = quentes[i];  // Finalizadas juntas no começo do vetor
+    }
+    // Histórico e segmento novo em disco antes de o antigo sumir
+    ok = gravarHistorico(ARQ_HISTORICO, quentes, movidas, inicio, 1) && ok;
+    ok = fecharEscrita(&novo, 1) && ok;
+    free(quentes);
+
+    if (!ok || substituirArquivo(ARQ_ESTADIAS_NOVO, ARQ_ESTADIAS) != 0)
+    {
+        printf("Erro: nao foi possivel substituir %s.\n", ARQ_ESTADIAS);
+        exit(1);
+    }
+    return movidas;
+}
+
+/*
+ * Função: concluirCompactacao
+ * Objetivo: Terminar uma compactação interrompida por uma queda
+ *           Chamada com a trava exclusiva dos dados
+ * Parâmetros: -
+ * Retorno: int - 1 se havia compactação a concluir
+ */
+int concluirCompactacao()
+{
+    int inicio;
+    FILE *pendente = fopen(ARQ_COMPACTACAO, "rb");
+    int registrada = pendente && fread(&inicio, sizeof(int), 1, pendente) == 1;
+    if (pendente)
+        fclose(pendente);
+
+    FILE *novo = fopen(ARQ_ESTADIAS_NOVO, "rb");
+    if (novo)
+        fclose(novo);
+
+    if (registrada && novo)
+        trocarSegmentoQuente(inicio);  // A troca não chegou a acontecer
+    else if (novo)
+        remove(ARQ_ESTADIAS_NOVO);     // Queda antes de o histórico ser tocado
+    if (pendente)
+        remove(ARQ_COMPACTACAO);
+    return pendente != NULL;
+}
+
+/*
+ * Função: historicoAntesDaTroca
+ * Objetivo: Para quem só lê, saber onde termina o histórico válido quando
+ *           uma compactação parou antes da troca do segmento quente (as
+ *           estadias depois desse ponto ainda estão em ARQ_ESTADIAS)
+ * Parâmetros: -
+ * Retorno: int - registros válidos do histórico, ou -1 se não há troca pendente
+ */
+int historicoAntesDaTroca()
+{
+    int inicio;
+    FILE *pendente = fopen(ARQ_COMPACTACAO, "rb");
+    int registrada = pendente && fread(&inicio, sizeof(int), 1, pendente) == 1;
+    if (pendente)
+        fclose(pendente);
+
+    FILE *novo = fopen(ARQ_ESTADIAS_NOVO, "rb");
+    if (novo)
+        fclose(novo);
+    return registrada && novo ? inicio : -1;
+}
+
+/*
+ * Função: compactarEstadias
+ * Objetivo: Mover as estadias finalizadas do segmento quente para o
+ *           histórico e acertar a memória
+ *           Chamada com a trava exclusiva e os arquivos em dia com a memória
+ * Parâmetros: -
+ * Retorno: int - quantidade de estadias movidas
+ */
+int compactarEstadias()
+{
+    concluirCompactacao();
+    if (finalizadasNoQuente == 0)
+        return 0;
+
+    // ARQ_ESTADIAS_NOVO existe antes do registro: sua ausência com o
+    // registro presente quer dizer que a troca já foi feita
+    FILE *novo = fopen(ARQ_ESTADIAS_NOVO, "wb");
+    FILE *pendente = fopen(ARQ_COMPACTACAO, "wb");
+    if (!novo || !pendente)
+    {
+        if (novo)
+            fclose(novo);
+        if (pendente)
+            fclose(pendente);
+        remove(ARQ_COMPACTACAO);
+        remove(ARQ_ESTADIAS_NOVO);
+        return 0;  // Sem escrita no diretório: segue sem compactar
+    }
+    sincronizarArquivo(novo);
+    fclose(novo);
+    CabecalhoArquivo historico;
+    lerCabecalhoArquivo(ARQ_HISTORICO, REGISTRO_HISTORICO, &historico);
+    int inicio = historico.total;
+    fwrite(&inicio, sizeof(int), 1, pendente);
+    sincronizarArquivo(pendente);
+    fclose(pendente);
+
+    int movidas = trocarSegmentoQuente(inicio);
+    remove(ARQ_COMPACTACAO);
+
+    sincronizarSegmentos();  // Novos registros de cada estadia no segmento quente
+    return movidas;
+}
+
+/*
+ * Função: carregarEstadias
+ * Objetivo: Carregar o histórico e, em seguida, o segmento quente
+ * Parâmetros: -
+ * Retorno: void
+ */
+void carregarEstadias()
+{
+    if (somenteLeitura && historicoNoFormatoAntigo())
+        tabelaEstadias = lerHistoricoAntigo(&totalEstadias);  // Convertido só na memória
+    else
+        tabelaEstadias = lerHistorico(ARQ_HISTORICO, 0, &totalEstadias, 1);
+    if (somenteLeitura)
+    {
+        int validos = historicoAntesDaTroca();
+        if (validos >= 0 && validos < totalEstadias)
+            totalEstadias = validos;  // O resto ainda está no segmento quente
+    }
+    capacidadeEstadias = totalEstadias;
+    registrosHistorico = totalEstadias;
+
+    int capacidadeQuentes;
+    Estadia *quentes = carregarArquivo(ARQ_ESTADIAS, REGISTRO_ESTADIA, &registrosQuentes, &capacidadeQuentes);
+    if (registrosQuentes > 0)
+    {
+        tabelaEstadias = garantirCapacidade(tabelaEstadias, &capacidadeEstadias,
+                                            totalEstadias + registrosQuentes, sizeof(Estadia));
+        memcpy(tabelaEstadias + totalEstadias, quentes, (size_t)registrosQuentes * sizeof(Estadia));
+        totalEstadias += registrosQuentes;
+    }
+    free(quentes);
+}
+
+/*
+ * Função: converterArquivosAntigos
+ * Objetivo: Converter para o formato atual os arquivos de dados gravados por
+ *           versões anteriores do programa
+ *           A conversão é feita com a trava exclusiva, uma vez só
+ * Parâmetros: -
+ * Retorno: void
+ */
+void converterArquivosAntigos()
+{
+    const char *nomes[] = {ARQ_CLIENTES, ARQ_FUNCIONARIOS, ARQ_QUARTOS, ARQ_ESTADIAS};
+    const int tipos[] = {REGISTRO_CLIENTE, REGISTRO_FUNCIONARIO, REGISTRO_QUARTO, REGISTRO_ESTADIA};
+
+    // Confere sem travar: no caso comum nada precisa ser convertido
+    int antigos = historicoNoFormatoAntigo();
+    for (int i = 0; i < 4; i++)
+    {
+        FILE *arq = fopen(nomes[i], "rb");
+        if (!arq)
+            continue;
+        unsigned char inicio[8];
+        size_t lidos = fread(inicio, 1, sizeof(inicio), arq);
+        fclose(arq);
+        antigos += lidos > 0 && !temAssinatura(inicio, lidos);
+    }
+    if (antigos == 0)
+        return;
+
+    travarDados(TRAVA_EXCLUSIVA);
+    int convertidos = converterHistoricoAntigo();
+    for (int i = 0; i < 4; i++)
+        convertidos += converterArquivoAntigo(nomes[i], tipos[i]);  // Outro processo pode ter convertido
+    if (convertidos > 0)
+        gravarGeracao(lerGeracao() + 1);
+    travarDados(TRAVA_LIVRE);
+}
+
+/*
+ * Função: carregarDados
+ * Objetivo: Carregar os quatro arquivos de dados para as tabelas em memória
+ *           Chamada uma vez no início do programa
+ * Parâmetros: -
+ * Retorno: void
+ */
+void carregarDados()
+{
+    prepararCrc32c();
+    if (!somenteLeitura)
+        converterArquivosAntigos();
+
+    // Compactação interrompida por uma queda: termina antes de ler
+    // (quem só lê a contorna na memória, em carregarEstadias)
+    FILE *pendente = somenteLeitura ? NULL : fopen(ARQ_COMPACTACAO, "rb");
+    if (pendente)
+    {
+        fclose(pendente);
+        travarDados(TRAVA_EXCLUSIVA);
+        if (concluirCompactacao())
+            gravarGeracao(lerGeracao() + 1);  // Processos em execução releem os segmentos
+        travarDados(TRAVA_LIVRE);
+    }
+
+    // Trava compartilhada: outros processos podem ler junto, mas nenhum
+    // grava enquanto os arquivos são lidos
+    travarDados(TRAVA_COMPARTILHADA);
+    geracaoConhecida = lerGeracao();
+    tabelaClientes = carregarArquivo(ARQ_CLIENTES, REGISTRO_CLIENTE,
+                                     &totalClientes, &capacidadeClientes);
+    tabelaFuncionarios = carregarArquivo(ARQ_FUNCIONARIOS, REGISTRO_FUNCIONARIO,
+                                         &totalFuncionarios, &capacidadeFuncionarios);
+    tabelaQuartos = carregarArquivo(ARQ_QUARTOS, REGISTRO_QUARTO,
+                                    &totalQuartos, &capacidadeQuartos);
+    carregarEstadias();
+    travarDados(TRAVA_LIVRE);
+    construirIndices();
+    carregarFidelidade();
+}
+
+// ============================================================
+// ALTERAÇÕES FEITAS POR OUTROS PROCESSOS
+// ============================================================
+
+/*
+ * Cada processo mantém suas tabelas em memória. Antes de alterar os dados
+ * ele toma a trava exclusiva e traz para a memória o que os outros
+ * processos gravaram desde a última vez (registros acrescentados ao fim
+ * dos arquivos e estadias encerradas); só então valida e grava a sua
+ * alteração, que vai para o fim dos arquivos na mesma ordem em que entra
+ * na memória. A trava é solta quando o grupo do diário é confirmado
+ * (liberarAlteracao), somando um à geração dos dados, e nunca fica com o
+ * processo enquanto ele espera pelo usuário ou pela entrada
+ * (liberarAntesDeEsperar).
+ *
+ * Consultas não travam nada além do instante de conferir a geração
+ * (atualizarDados), então listagens e relatórios de uma recepção nunca
+ * esperam pelos check-ins das outras.
+ */
+int processoAlterando = 0;  // 1 enquanto este processo tem a trava exclusiva
+
+/*
+ * Função: acompanharArquivos
+ * Objetivo: Trazer para a memória as alterações gravadas por outros
+ *           processos, se a geração dos dados mudou
+ *           Chamada com a trava dos dados (compartilhada ou exclusiva)
+ * Parâmetros: -
+ * Retorno: void
+ */
+void acompanharArquivos()
+{
+    unsigned int geracao = lerGeracao();
+    if (geracao == geracaoConhecida)
+        return;
+
+    int novos;
+    Cliente *clientes = lerRegistros(ARQ_CLIENTES, REGISTRO_CLIENTE, totalClientes, &novos, 0);
+    for (int i = 0; i < novos; i++)
+        inserirClienteTabela(clientes[i]);
+    free(clientes);
+
+    Funcionario *funcionarios = lerRegistros(ARQ_FUNCIONARIOS, REGISTRO_FUNCIONARIO,
+                                             totalFuncionarios, &novos, 0);
+    for (int i = 0; i < novos; i++)
+        inserirFuncionarioTabela(funcionarios[i]);
+    free(funcionarios);
+
+    // Quartos antes das estadias: a agenda de uma estadia nova precisa do quarto
+    Quarto *quartos = lerRegistros(ARQ_QUARTOS, REGISTRO_QUARTO, totalQuartos, &novos, 0);
+    for (int i = 0; i < novos; i++)
+        inserirQuartoTabela(quartos[i]);
+    free(quartos);
+
+    // Estadias novas, encerramentos e compactações: só o segmento quente
+    // é lido inteiro
+    sincronizarSegmentos();
+    acompanharResgates();
+
+    geracaoConhecida = geracao;
+}
+
+/*
+ * Função: atualizarDados
+ * Objetivo: Antes de uma consulta, trazer para a memória o que outros
+ *           processos gravaram (só lê: usa a trava compartilhada)
+ *           Se outro processo estiver no meio de uma alteração, a consulta
+ *           segue com a memória atual em vez de esperar
+ * Parâmetros: -
+ * Retorno: void
+ */
+void atualizarDados()
+{
+    if (processoAlterando)
+        return;  // Com a trava exclusiva a memória já está em dia
+
+    if (!travarByte(BYTE_TRAVA_DADOS, TRAVA_COMPARTILHADA, 0))
+        return;
+    acompanharArquivos();
+    travarDados(TRAVA_LIVRE);
+}
+
+/*
+ * Função: travarAlteracao
+ * Objetivo: Tomar a trava exclusiva dos dados (esperando os outros
+ *           processos) e pôr a memória em dia antes de uma alteração
+ *           Não faz nada se este processo já tem a trava
+ * Parâmetros: -
+ * Retorno: void
+ */
+void travarAlteracao()
+{
+    if (processoAlterando)
+        return;
+
+    travarDados(TRAVA_EXCLUSIVA);
+    processoAlterando = 1;
+    acompanharArquivos();
+}
+
+// ============================================================
+// FUNÇÃO AUXILIAR PARA LIMPAR BUFFER DE ENTRADA
+// ============================================================
+
+/*
+ * Função: limparEntrada
+ * Objetivo: Limpar o buffer de entrada do teclado para evitar problemas
+ *           com funções como scanf e fgets
+ * Parâmetros: -
+ * Retorno: void
+ */
+void limparEntrada()
+{
+    int c;  // Variável para armazenar cada caractere
+    // Lê e descarta todos os caracteres até encontrar \n ou EOF
+    while ((c = getchar()) != '\n' && c != EOF)
+    {
+        // Loop vazio - apenas consome os caracteres
+    }
+}
+
+// ============================================================
+// FUNÇÕES PARA CÁLCULO DE DIÁRIAS (VALIDAÇÃO DE DATAS)
+// ============================================================
+
+/*
+ * Função: diasFevereiro
+ * Objetivo: Determinar quantos dias tem fevereiro em um determinado ano
+ *           Considera anos bissextos
+ * Parâmetros: ano - ano a ser verificado
+ * Retorno: int - 29 se for bissexto, 28 se não for
+ */
+int diasFevereiro(int ano)
+{
+    int bissexto = 0;  // Flag para indicar se é ano bissexto
+
+    // Verifica se é ano bissexto (divisível por 4)
+    if (ano % 4 == 0)
+    {
+        // Exceção: se for divisível por 100, só é bissexto se for divisível por 400
+        if (ano % 100 != 0 || ano % 400 == 0)
+            bissexto = 1;  // É bissexto
+    }
+    
+    // Retorna quantidade de dias conforme o ano
+    if (bissexto == 1)
+        return 29;  // Fevereiro em ano bissexto
+    else
+        return 28;  // Fevereiro em ano não bissexto
+}
+
+/*
+ * Função: diasNoMes
+ * Objetivo: Retornar o número de dias em um determinado mês/ano
+ * Parâmetros: mes - mês (1-12)
+ *             ano - ano para verificar fevereiro
+ * Retorno: int - número de dias no mês
+ */
+int diasNoMes(int mes, int ano)
+{
+    // Switch para determinar dias conforme o mês
+    switch (mes)
+    {
+    case 2:  // Fevereiro - depende do ano
+        return diasFevereiro(ano);
+    case 4:   // Abril
+    case 6:   // Junho
+    case 9:   // Setembro
+    case 11:  // Novembro
+        return 30;  // Meses com 30 dias
+    default:  // Todos os outros meses
+        return 31;  // Meses com 31 dias
+    }
+}
+
+// ============================================================
+// FUNÇÃO DE VALIDAÇÃO DE DATA
+// ============================================================
+
+/*
+ * Função: validarData
+ * Objetivo: Verificar se uma data é válida
+ * Parâmetros: d - estrutura Data contendo dia, mês e ano
+ * Retorno: int - 1 se válida, 0 se inválida
+ */
+int validarData(Data d) {
+    // Validar ano (consideramos de 1900 a 2100 como válido)
+    if (d.ano < 1900 || d.ano > 2100) {
+        return 0;  // Ano fora do intervalo permitido
+    }
+    
+    // Validar mês (deve estar entre 1 e 12)
+    if (d.mes < 1 || d.mes > 12) {
+        return 0;  // Mês inválido
+    }
+    
+    // Validar dia baseado no mês e ano
+    int diasNoMesValido = diasNoMes(d.mes, d.ano);  // Obtém dias do mês
+    if (d.dia < 1 || d.dia > diasNoMesValido) {
+        return 0;  // Dia inválido para o mês/ano
+    }
+    
+    return 1;  // Data válida
+}
+
+// ============================================================
+// FUNÇÃO AUXILIAR PARA LER DATA COM VALIDAÇÃO
+// ============================================================
+
+/*
+ * Função: lerData
+ * Objetivo: Ler uma data do usuário com validação e mensagens de erro
+ * Parâmetros: mensagem - texto a ser exibido para o usuário
+ *             data - ponteiro para estrutura Data onde armazenar o resultado
+ * Retorno: int - 1 se leitura bem sucedida, 0 se falhou após 3 tentativas
+ */
+int lerData(const char *mensagem, Data *data) {
+    int tentativas = 0;  // Contador de tentativas falhas
+    
+    // Permite até 3 tentativas
+    while (tentativas < 3) {
+        printf("%s (DD MM AAAA): ", mensagem);
+        
+        // Ler os três valores (dia, mês, ano)
+        if (scanf("%d %d %d", &data->dia, &data->mes, &data->ano) != 3) {
+            printf("Formato invalido! Digite dia, mes e ano separados por espacos.\n");
+            limparEntrada();  // Limpa buffer para próxima tentativa
+            tentativas++;
+            continue;
+        }
+        
+        // Validar a data usando a função validarData
+        if (!validarData(*data)) {
+            printf("Data invalida! Verifique se o dia, mes e ano estao corretos.\n");
+            printf("Exemplo: 25 12 2024 para 25 de dezembro de 2024.\n");
+            tentativas++;
+            continue;
+        }
+        
+        return 1; // Data válida lida com sucesso
+    }
+    
+    // Se chegou aqui, falhou após 3 tentativas
+    printf("Muitas tentativas invalidas. Voltando ao menu.\n");
+    return 0; // Falha na leitura
+}
+
+// ============================================================
+// FUNÇÕES PARA GERAR CÓDIGOS AUTOMÁTICOS
+// ============================================================
+
+/*
+ * Função: salvarSequencias
+ * Objetivo: Gravar os contadores de códigos no arquivo de sequências
+ *           (um único registro REGISTRO_SEQUENCIAS); a cópia nova vai ao
+ *           disco e toma o lugar da anterior antes de o código reservado
+ *           ser usado
+ * Parâmetros: -
+ * Retorno: int - 1 se os contadores estão no disco, 0 em caso de erro
+ */
+int salvarSequencias()
+{
+    CabecalhoArquivo modelo = {REGISTRO_SEQUENCIAS, 0, 1, {0}};
+    return gravarTrocando(ARQ_SEQUENCIAS, ARQ_SEQUENCIAS_NOVO, &modelo, &sequencias, 1);
+}
+
+/*
+ * Função: lerSequenciasGravadas
+ * Objetivo: Ler os contadores do arquivo de sequências
+ *           Aceita também o arquivo de versões anteriores (a struct da
+ *           memória gravada crua)
+ * Parâmetros: s - contadores lidos
+ * Retorno: int - 1 se leu, 2 se leu um arquivo de versão anterior,
+ *          0 se não há contadores gravados
+ */
+int lerSequenciasGravadas(Sequencias *s)
+{
+    CabecalhoArquivo cab;
+    int lidos;
+    Sequencias *gravadas = lerArquivoRecriavel(ARQ_SEQUENCIAS, REGISTRO_SEQUENCIAS, &cab, &lidos);
+    if (gravadas)
+    {
+        int ok = lidos == 1;
+        if (ok)
+            *s = gravadas[0];
+        free(gravadas);
+        return ok;
+    }
+
+    FILE *arq = fopen(ARQ_SEQUENCIAS, "rb");
+    if (!arq)
+        return 0;
+    unsigned char bytes[sizeof(Sequencias) + 1];
+    size_t tamanho = fread(bytes, 1, sizeof(bytes), arq);
+    fclose(arq);
+    if (tamanho != sizeof(Sequencias))  // Só a struct, sem assinatura
+        return 0;
+    memcpy(s, bytes, sizeof(Sequencias));
+    return 2;
+}
+
+/*
+ * Função: sequenciasDosArquivos
+ * Objetivo: Ler o próximo código de cada entidade no cabeçalho do seu
+ *           arquivo (maior código gravado + 1, sem varrer os registros)
+ *           As estadias ficam com o maior entre o segmento quente e o
+ *           histórico: a compactação deixa no quente só as ativas
+ * Parâmetros: s - contadores a preencher
+ * Retorno: void
+ */
+void sequenciasDosArquivos(Sequencias *s)
+{
+    CabecalhoArquivo clientes, funcionarios, historico, quentes;
+    lerCabecalhoArquivo(ARQ_CLIENTES, REGISTRO_CLIENTE, &clientes);
+    lerCabecalhoArquivo(ARQ_FUNCIONARIOS, REGISTRO_FUNCIONARIO, &funcionarios);
+    lerCabecalhoArquivo(ARQ_HISTORICO, REGISTRO_HISTORICO, &historico);
+    lerCabecalhoArquivo(ARQ_ESTADIAS, REGISTRO_ESTADIA, &quentes);
+
+    s->proximoCliente = clientes.proximoCodigo;
+    s->proximoFuncionario = funcionarios.proximoCodigo;
+    s->proximoEstadia = historico.proximoCodigo > quentes.proximoCodigo
+                            ? historico.proximoCodigo
+                            : quentes.proximoCodigo;
+}
+
+/*
+ * Função: atualizarSequencias
+ * Objetivo: Trazer para a memória os contadores gravados por outros
+ *           processos (fica com o maior de cada contador)
+ *           Chamada com a trava exclusiva dos dados
+ * Parâmetros: -
+ * Retorno: void
+ */
+void atualizarSequencias()
+{
+    Sequencias gravadas;
+    if (!lerSequenciasGravadas(&gravadas))
+        return;
+    if (gravadas.proximoCliente > sequencias.proximoCliente)
+        sequencias.proximoCliente = gravadas.proximoCliente;
+    if (gravadas.proximoFuncionario > sequencias.proximoFuncionario)
+        sequencias.proximoFuncionario = gravadas.proximoFuncionario;
+    if (gravadas.proximoEstadia > sequencias.proximoEstadia)
+        sequencias.proximoEstadia = gravadas.proximoEstadia;
+}
+
+/*
+ * Função: carregarSequencias
+ * Objetivo: Ler os contadores persistidos e conferir com os cabeçalhos dos
+ *           arquivos de dados, ficando com o maior de cada contador
+ *           (o arquivo de sequências pode ter ficado para trás numa queda;
+ *           o último registro da tabela não serve, porque as estadias
+ *           finalizadas saem do segmento quente). Se o arquivo não existir
+ *           ou não conferir, valem os cabeçalhos; um arquivo de versão
+ *           anterior é regravado no formato comum
+ * Parâmetros: -
+ * Retorno: void
+ */
+void carregarSequencias()
+{
+    int lido = lerSequenciasGravadas(&sequencias);
+
+    Sequencias arquivos;
+    sequenciasDosArquivos(&arquivos);
+    int corrigido = lido != 1;  // Arquivo ausente ou de versão anterior
+    if (!lido || arquivos.proximoCliente > sequencias.proximoCliente)
+    {
+        sequencias.proximoCliente = arquivos.proximoCliente;
+        corrigido = 1;
+    }
+    if (!lido || arquivos.proximoFuncionario > sequencias.proximoFuncionario)
+    {
+        sequencias.proximoFuncionario = arquivos.proximoFuncionario;
+        corrigido = 1;
+    }
+    if (!lido || arquivos.proximoEstadia > sequencias.proximoEstadia)
+    {
+        sequencias.proximoEstadia = arquivos.proximoEstadia;
+        corrigido = 1;
+    }
+
+    if (corrigido)
+    {
+        // Outro processo pode estar reservando códigos: grava com a trava
+        // exclusiva, sem voltar atrás nos contadores que ele gravou
+        if (!processoAlterando)
+            travarDados(TRAVA_EXCLUSIVA);
+        atualizarSequencias();
+        if (!salvarSequencias())
+            printf("Aviso: nao foi possivel gravar %s.\n", ARQ_SEQUENCIAS);
+        if (!processoAlterando)
+            travarDados(TRAVA_LIVRE);
+    }
+}
+
+/*
+ * Função: reservarCodigo
+ * Objetivo: Reservar o próximo valor de um contador de forma atômica entre
+ *           processos: com a trava exclusiva, lê o arquivo de sequências,
+ *           incrementa e grava
+ *           A trava continua com o processo até a alteração ser confirmada
+ * Parâmetros: contador - campo de sequencias a incrementar
+ * Retorno: int - código reservado
+ */
+int reservarCodigo(int *contador)
+{
+    travarAlteracao();
+    atualizarSequencias();
+    int codigo = (*contador)++;
+    if (!salvarSequencias())
+    {
+        // Sem o contador no disco outro processo poderia reservar o mesmo código
+        printf("Erro: nao foi possivel gravar %s.\n", ARQ_SEQUENCIAS);
+        exit(1);
+    }
+    return codigo;
+}
+
+/*
+ * Função: gerarCodigoCliente
+ * Objetivo: Gerar um código único para novo cliente
+ *           Usa o contador persistido: o código é reservado (contador gravado)
+ *           antes do registro, então uma falha gera no máximo uma lacuna
+ * Parâmetros: -
+ * Retorno: int - próximo código disponível
+ */
+int gerarCodigoCliente()
+{
+    return reservarCodigo(&sequencias.proximoCliente);
+}
+
+/*
+ * Função: gerarCodigoFuncionario
+ * Objetivo: Gerar código único para novo funcionário
+ * Parâmetros: -
+ * Retorno: int - próximo código disponível
+ */
+int gerarCodigoFuncionario()
+{
+    return reservarCodigo(&sequencias.proximoFuncionario);
+}
+
+/*
+ * Função: gerarCodigoEstadia
+ * Objetivo: Gerar código único para nova estadia
+ * Parâmetros: -
+ * Retorno: int - próximo código disponível
+ */
+int gerarCodigoEstadia()
+{
+    return reservarCodigo(&sequencias.proximoEstadia);
+}
+
+// ============================================================
+// FUNÇÃO PARA MARCAR QUARTO COMO OCUPADO OU LIVRE
+// ============================================================
+
+/*
+ * Função: quartoOcupado
+ * Objetivo: Alterar status de ocupação de um quarto
+ * Parâmetros: numero - número do quarto
+ *             ocupado - novo status (1 = ocupado, 0 = livre)
+ * Retorno: void
+ * 
+ * Nota: Regrava só o registro do quarto e a soma do seu bloco. Uma queda
+ *       entre as duas gravações deixa o bloco sem conferir, mas a função é
+ *       chamada ao aplicar operações já confirmadas no diário, que as refaz
+ *       na próxima execução.
+ */
+void quartoOcupado(int numero, int ocupado)
+{
+    // Localiza o quarto diretamente pelo número e atualiza status
+    int posicao = mapaQuartosBuscar(numero);
+    if (posicao < 0)
+        return;
+    tabelaQuartos[posicao].estaOcupado = ocupado;
+
+    // Grava somente o registro alterado, no lugar
+    gravarRegistro(ARQ_QUARTOS, REGISTRO_QUARTO, posicao, &tabelaQuartos[posicao]);
+}
+
+// ============================================================
+// DIÁRIO DE OPERAÇÕES (WRITE-AHEAD LOG)
+// ============================================================
+
+/*
+ * Toda alteração (cadastros, nova estadia, encerramento) é primeiro
+ * acrescentada ao diário ARQ_DIARIO e aplicada às tabelas em memória.
+ * Os arquivos de dados só recebem a alteração depois que o diário foi
+ * sincronizado com o disco (confirmarDiario), então após uma queda basta
+ * reaplicar o diário sobre os arquivos (reproduzirDiario).
+ *
+ * Confirmação em grupo: o fsync do diário pode ser compartilhado por
+ * várias operações. A variável de ambiente HOTEL_GRUPO_COMMIT define
+ * quantas operações formam um grupo (padrão 1 = cada operação é durável
+ * ao retornar) e HOTEL_GRUPO_COMMIT_MS limita, em milissegundos, quanto
+ * tempo a primeira operação do grupo pode esperar pela confirmação.
+ * Os grupos só se formam no modo lote e no servidor, com comandos que
+ * chegam seguidos: antes de esperar por mais entrada o processo confirma
+ * o grupo aberto, e só então as respostas "ok" saem. No menu cada
+ * operação é confirmada antes da mensagem de sucesso.
+ *
+ * Periodicamente (checkpoint) os arquivos de dados são sincronizados e o
+ * diário é esvaziado, limitando o tempo de reprodução na inicialização.
+ *
+ * Cada processo em execução tem o seu próprio diário (ARQ_DIARIO para o
+ * primeiro, "diario.<i>.log" para os demais), cuja posse é a trava do
+ * byte correspondente em ARQ_TRAVA. Na inicialização, os diários sem dono
+ * (de processos que caíram) são reproduzidos e esvaziados.
+ *
+ * O diário usa as mesmas regras dos arquivos de dados (little-endian,
+ * campo a campo), então independe do compilador e do processador:
+ *   cabeçalho do arquivo (TAMANHO_CABECALHO_DIARIO bytes)
+ *      0 assinatura "HOTELDG\0"   8 versão do formato   12 REGISTRO_DIARIO
+ *   cada operação
+ *      0 tipo (OP_*)   4 bytes de dados   8 CRC32C dos bytes 0-7 e dos dados
+ *     12 dados: cadastros e estadias como no arquivo (codificarRegistro);
+ *        encerramento: estadia 0, quarto 4; resgate: cliente 0, total 4
+ * Um diário sem cabeçalho foi gravado por uma versão anterior, com as
+ * structs como estavam na memória; a reprodução ainda o lê
+ * (reproduzirDiarioAntigo), pois foi gravado na mesma máquina.
+ */
+#define OP_CLIENTE      1   // Cadastro de cliente
+#define OP_FUNCIONARIO  2   // Cadastro de funcionário
+#define OP_QUARTO       3   // Cadastro de quarto
+#define OP_ESTADIA      4   // Nova estadia (grava estadia e ocupa quarto)
+#define OP_ENCERRAMENTO 5   // Encerramento (finaliza estadia e libera quarto)
+#define OP_RESGATE      6   // Resgate de pontos de fidelidade
+
+#define LIMITE_CHECKPOINT 10000  // Operações no diário antes de um checkpoint
+#define TAMANHO_CABECALHO_DIARIO 16
+#define TAMANHO_CABECALHO_OPERACAO 12
+
+/*
+ * Estrutura com os dados de um encerramento de estadia
+ */
+typedef struct
+{
+    int codigoEstadia;  // Estadia sendo encerrada
+    int numeroQuarto;   // Quarto a ser liberado
+} Encerramento;
+
+/*
+ * Estrutura com os dados de um resgate de pontos
+ * Guarda o total resgatado após a operação (e não a diferença), então
+ * reaplicar o mesmo registro não desconta os pontos duas vezes
+ */
+typedef struct
+{
+    int codigoCliente;     // Cliente que resgatou
+    int pontosResgatados;  // Total resgatado pelo cliente após este resgate
+} Resgate;
+
+/*
+ * Estrutura de uma operação registrada no diário
+ */
+typedef struct
+{
+    int tipo;  // OP_*
+    union
+    {
+        Cliente cliente;
+        Funcionario funcionario;
+        Quarto quarto;
+        Estadia estadia;
+        Encerramento encerramento;
+        Resgate resgate;
+    } dados;
+} Operacao;
+
+/*
+ * Cabeçalho gravado antes dos dados de cada operação nos diários de
+ * versões anteriores (struct gravada como está na memória)
+ */
+typedef struct
+{
+    int tipo;           // OP_*
+    int tamanho;        // Bytes de dados que seguem o cabeçalho
+    unsigned int soma;  // Soma de verificação (detecta registro incompleto)
+} CabecalhoDiario;
+
+FILE *diario = NULL;                 // Diário aberto para acréscimo
+Operacao *operacoesPendentes = NULL; // Operações do grupo ainda não confirmado
+int totalPendentes = 0;
+int capacidadePendentes = 0;
+int grupoCommit = 1;                 // Operações por fsync do diário
+long long esperaMaximaMs = 0;        // Espera máxima de um grupo (0 = sem limite)
+long long inicioGrupoMs = 0;         // Momento da primeira operação do grupo
+int operacoesNoDiario = 0;           // Operações desde o último checkpoint
+char nomeDiario[32] = "";            // Diário deste processo
+
+/*
+ * Função: agoraMs
+ * Objetivo: Obter o instante atual em milissegundos
+ * Parâmetros: -
+ * Retorno: long long - milissegundos desde a época
+ */
+long long agoraMs()
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*
+ * Função: agoraNs
+ * Objetivo: Obter o instante atual em nanossegundos (medição de latência)
+ * Parâmetros: -
+ * Retorno: long long - nanossegundos desde a época
+ */
+long long agoraNs()
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/*
+ * Função: tamanhoOperacao
+ * Objetivo: Informar quantos bytes ocupam os dados de uma operação na
+ *           memória (e nos diários de versões anteriores)
+ * Parâmetros: tipo - tipo da operação (OP_*)
+ * Retorno: int - tamanho dos dados, ou 0 se o tipo for desconhecido
+ */
+int tamanhoOperacao(int tipo)
+{
+    switch (tipo)
+    {
+    case OP_CLIENTE:
+        return (int)sizeof(Cliente);
+    case OP_FUNCIONARIO:
+        return (int)sizeof(Funcionario);
+    case OP_QUARTO:
+        return (int)sizeof(Quarto);
+    case OP_ESTADIA:
+        return (int)sizeof(Estadia);
+    case OP_ENCERRAMENTO:
+        return (int)sizeof(Encerramento);
+    case OP_RESGATE:
+        return (int)sizeof(Resgate);
+    default:
+        return 0;
+    }
+}
+
+/*
+ * Função: registroDaOperacao
+ * Objetivo: Tipo de registro do arquivo de dados que uma operação grava
+ * Parâmetros: tipo - tipo da operação (OP_*)
+ * Retorno: int - REGISTRO_*, ou 0 se a operação não grava um registro inteiro
+ */
+int registroDaOperacao(int tipo)
+{
+    switch (tipo)
+    {
+    case OP_CLIENTE:     return REGISTRO_CLIENTE;
+    case OP_FUNCIONARIO: return REGISTRO_FUNCIONARIO;
+    case OP_QUARTO:      return REGISTRO_QUARTO;
+    case OP_ESTADIA:     return REGISTRO_ESTADIA;
+    default:             return 0;
+    }
+}
+
+/*
+ * Função: tamanhoNoDiario
+ * Objetivo: Informar quantos bytes de dados uma operação grava no diário
+ * Parâmetros: tipo - tipo da operação (OP_*)
+ * Retorno: int - tamanho dos dados, ou 0 se o tipo for desconhecido
+ */
+int tamanhoNoDiario(int tipo)
+{
+    if (registroDaOperacao(tipo))
+        return tamanhoNoDisco(registroDaOperacao(tipo));
+    if (tipo == OP_ENCERRAMENTO || tipo == OP_RESGATE)
+        return 8;
+    return 0;
+}
+
+/*
+ * Função: codificarOperacao
+ * Objetivo: Montar o registro de uma operação no diário (cabeçalho e dados)
+ * Parâmetros: op - operação
+ *             destino - TAMANHO_CABECALHO_OPERACAO + TAMANHO_MAXIMO_REGISTRO bytes
+ * Retorno: int - bytes montados
+ */
+int codificarOperacao(const Operacao *op, unsigned char *destino)
+{
+    unsigned char *dados = destino + TAMANHO_CABECALHO_OPERACAO;
+    int tamanho = tamanhoNoDiario(op->tipo);
+
+    if (registroDaOperacao(op->tipo))
+        codificarRegistro(registroDaOperacao(op->tipo), &op->dados, dados);
+    else if (op->tipo == OP_ENCERRAMENTO)
+    {
+        escreverPalavra(dados, (unsigned int)op->dados.encerramento.codigoEstadia);
+        escreverPalavra(dados + 4, (unsigned int)op->dados.encerramento.numeroQuarto);
+    }
+    else  // OP_RESGATE
+    {
+        escreverPalavra(dados, (unsigned int)op->dados.resgate.codigoCliente);
+        escreverPalavra(dados + 4, (unsigned int)op->dados.resgate.pontosResgatados);
+    }
+
+    escreverPalavra(destino, (unsigned int)op->tipo);
+    escreverPalavra(destino + 4, (unsigned int)tamanho);
+    unsigned int soma = continuarCrc32c(0, destino, 8);
+    escreverPalavra(destino + 8, continuarCrc32c(soma, dados, (size_t)tamanho));
+    return TAMANHO_CABECALHO_OPERACAO + tamanho;
+}
+
+/*
+ * Função: decodificarOperacao
+ * Objetivo: Ler os dados de uma operação do diário (inverso de codificarOperacao)
+ * Parâmetros: tipo - tipo da operação (OP_*)
+ *             dados - tamanhoNoDiario(tipo) bytes
+ *             op - operação lida
+ * Retorno: void
+ */
+void decodificarOperacao(int tipo, const unsigned char *dados, Operacao *op)
+{
+    memset(op, 0, sizeof(Operacao));
+    op->tipo = tipo;
+    if (registroDaOperacao(tipo))
+        decodificarRegistro(registroDaOperacao(tipo), dados, &op->dados);
+    else if (tipo == OP_ENCERRAMENTO)
+    {
+        op->dados.encerramento.codigoEstadia = (int)lerPalavra(dados);
+        op->dados.encerramento.numeroQuarto = (int)lerPalavra(dados + 4);
+    }
+    else  // OP_RESGATE
+    {
+        op->dados.resgate.codigoCliente = (int)lerPalavra(dados);
+        op->dados.resgate.pontosResgatados = (int)lerPalavra(dados + 4);
+    }
+}
+
+/*
+ * Função: aplicarEncerramento
+ * Objetivo: Marcar estadia como finalizada e atualizar o quarto, na memória
+ *           e no arquivo (gravação no lugar de cada registro)
+ *           Pode ser repetida sem efeito colateral
+ * Parâmetros: enc - estadia e quarto envolvidos
+ * Retorno: void
+ */
+void aplicarEncerramento(Encerramento enc)
+{
+    int posicao = indiceBuscar(&indiceEstadias, enc.codigoEstadia);
+    if (posicao >= 0 && colunasEstadias.registroQuente[posicao] >= 0)
+    {
+        // Estadias ativas estão sempre no segmento quente; as do histórico
+        // já estão finalizadas no arquivo
+        marcarEstadiaFinalizada(posicao);
+        Estadia finalizada = estadiaAtual(posicao);
+        gravarRegistro(ARQ_ESTADIAS, REGISTRO_ESTADIA, colunasEstadias.registroQuente[posicao], &finalizada);
+    }
+    // Status de hoje pela agenda: outra estadia pode estar em curso
+    quartoOcupado(enc.numeroQuarto, quartoOcupadoHoje(enc.numeroQuarto));
+}
+
+/*
+ * Função: aplicarNosArquivos
+ * Objetivo: Levar aos arquivos de dados uma operação já gravada no diário
+ * Parâmetros: op - operação a aplicar
+ * Retorno: void
+ */
+void aplicarNosArquivos(const Operacao *op)
+{
+    switch (op->tipo)
+    {
+    case OP_CLIENTE:
+        gravarNoFim(ARQ_CLIENTES, REGISTRO_CLIENTE, &op->dados.cliente);
+        break;
+    case OP_FUNCIONARIO:
+        gravarNoFim(ARQ_FUNCIONARIOS, REGISTRO_FUNCIONARIO, &op->dados.funcionario);
+        break;
+    case OP_QUARTO:
+        gravarNoFim(ARQ_QUARTOS, REGISTRO_QUARTO, &op->dados.quarto);
+        break;
+    case OP_ESTADIA:
+        gravarNoFim(ARQ_ESTADIAS, REGISTRO_ESTADIA, &op->dados.estadia);
+        // Reserva futura não ocupa o quarto hoje
+        quartoOcupado(op->dados.estadia.numeroQuarto, quartoOcupadoHoje(op->dados.estadia.numeroQuarto));
+        break;
+    case OP_ENCERRAMENTO:
+        aplicarEncerramento(op->dados.encerramento);
+        break;
+    case OP_RESGATE:
+        // Resgates não se deduzem das estadias: o livro é o registro. Se a
+        // gravação falhar o resgate continua no diário, que o checkpoint
+        // não esvazia enquanto o livro não for gravado
+        salvarFidelidade();
+        break;
+    }
+}
+
+/*
+ * Função: sincronizarDados
+ * Objetivo: Forçar a gravação em disco dos quatro arquivos de dados
+ * Parâmetros: -
+ * Retorno: void
+ */
+void sincronizarDados()
+{
+    const char *arquivos[] = {ARQ_CLIENTES, ARQ_FUNCIONARIOS, ARQ_QUARTOS, ARQ_ESTADIAS};
+    for (int i = 0; i < 4; i++)
+    {
+        FILE *arq = fopen(arquivos[i], "r+b");
+        if (arq)
+        {
+            sincronizarArquivo(arq);
+            fclose(arq);
+        }
+    }
+}
+
+/*
+ * Função: liberarAlteracao
+ * Objetivo: Soltar a trava exclusiva dos dados, avisando os outros
+ *           processos (nova geração) de que os arquivos mudaram
+ *           A trava fica retida enquanto houver operações não confirmadas
+ * Parâmetros: -
+ * Retorno: void
+ */
+void liberarAlteracao()
+{
+    if (!processoAlterando || totalPendentes > 0)
+        return;
+
+    geracaoConhecida++;
+    gravarGeracao(geracaoConhecida);
+    travarDados(TRAVA_LIVRE);
+    processoAlterando = 0;
+}
+
+/*
+ * Função: nomeDoDiario
+ * Objetivo: Montar o nome do arquivo do diário de uma posição
+ * Parâmetros: posicao - posição do diário (0 a MAX_DIARIOS - 1)
+ *             nome - destino do nome
+ *             tamanho - tamanho do destino
+ * Retorno: void
+ */
+void nomeDoDiario(int posicao, char *nome, size_t tamanho)
+{
+    if (posicao == 0)
+        snprintf(nome, tamanho, "%s", ARQ_DIARIO);  // Nome de sempre para um único processo
+    else
+        snprintf(nome, tamanho, "diario.%d.log", posicao);
+}
+
+/*
+ * Função: falhaNoDiario
+ * Objetivo: Encerrar o programa quando o diário não pode ser aberto,
+ *           gravado ou sincronizado: sem ele nenhuma alteração pode ser
+ *           confirmada. Sai com _Exit para que nem as respostas do grupo
+ *           aberto (ainda no buffer) nem o checkpoint de encerrarDiario
+ *           rodem; o que estiver inteiro no diário é reaplicado na
+ *           próxima execução
+ * Parâmetros: acao - o que falhou ("gravar", "sincronizar"...)
+ * Retorno: void (não retorna)
+ */
+void falhaNoDiario(const char *acao)
+{
+    fprintf(stderr, "Erro: falha ao %s o diario %s; encerrando sem confirmar as ultimas alteracoes.\n",
+            acao, nomeDiario);
+    _Exit(1);
+}
+
+/*
+ * Função: checkpointDiario
+ * Objetivo: Sincronizar os arquivos de dados, compactar as estadias se
+ *           necessário e esvaziar o diário
+ *           (todas as operações do diário já estão nos arquivos)
+ * Parâmetros: -
+ * Retorno: void
+ */
+void checkpointDiario()
+{
+    sincronizarDados();
+    if (finalizadasNoQuente >= LIMITE_COMPACTACAO && 2 * finalizadasNoQuente >= registrosQuentes)
+        compactarEstadias();  // Finalizadas já são maioria no segmento quente
+    // Arquivos coincidem com a memória: momento de gravar o livro. Sem
+    // ele em disco o diário é a única cópia dos resgates e não é esvaziado
+    if (!salvarFidelidade())
+        return;
+
+    if (diario)
+        fclose(diario);
+    diario = fopen(nomeDiario, "wb");  // Recria o diário vazio, só com o cabeçalho
+    unsigned char cabecalho[TAMANHO_CABECALHO_DIARIO] = {0};
+    memcpy(cabecalho, FORMATO_ASSINATURA, 8);
+    escreverPalavra(cabecalho + 8, FORMATO_VERSAO);
+    escreverPalavra(cabecalho + 12, REGISTRO_DIARIO);
+    if (!diario || fwrite(cabecalho, sizeof(cabecalho), 1, diario) != 1 || fflush(diario) != 0)
+        falhaNoDiario("recriar");
+    operacoesNoDiario = 0;
+}
+
+/*
+ * Função: confirmarDiario
+ * Objetivo: Confirmar o grupo atual: um único fsync do diário torna todas
+ *           as operações pendentes duráveis, que então são aplicadas aos
+ *           arquivos de dados
+ * Parâmetros: -
+ * Retorno: void
+ */
+void confirmarDiario()
+{
+    if (totalPendentes == 0)
+        return;
+
+    if (!sincronizarArquivo(diario))  // Ponto de durabilidade do grupo
+        falhaNoDiario("sincronizar");
+
+    for (int i = 0; i < totalPendentes; i++)
+        aplicarNosArquivos(&operacoesPendentes[i]);
+
+    operacoesNoDiario += totalPendentes;
+    totalPendentes = 0;
+
+    if (operacoesNoDiario >= LIMITE_CHECKPOINT)
+        checkpointDiario();
+    liberarAlteracao();  // Arquivos em dia: outros processos podem alterar
+}
+
+/*
+ * Função: liberarAntesDeEsperar
+ * Objetivo: Antes de esperar pelo usuário ou por mais entrada, confirmar o
+ *           grupo aberto e soltar a trava exclusiva, para uma recepção
+ *           parada nunca segurar as outras
+ *           (confirmarDiario sem nada pendente não solta a trava tomada
+ *           por uma validação que não chegou a gravar)
+ * Parâmetros: -
+ * Retorno: void
+ */
+void liberarAntesDeEsperar()
+{
+    confirmarDiario();
+    liberarAlteracao();
+}
+
+/*
+ * Função: registrarOperacao
+ * Objetivo: Acrescentar uma operação ao diário e ao grupo pendente
+ *           Confirma o grupo quando ele atinge o tamanho ou a espera máxima
+ * Parâmetros: tipo - tipo da operação (OP_*)
+ *             dados - dados da operação (registro correspondente ao tipo)
+ * Retorno: void
+ */
+void registrarOperacao(int tipo, const void *dados)
+{
+    travarAlteracao();  // Em geral já obtida por quem validou a operação
+
+    Operacao op;
+    op.tipo = tipo;
+    memcpy(&op.dados, dados, (size_t)tamanhoOperacao(tipo));
+
+    unsigned char registro[TAMANHO_CABECALHO_OPERACAO + TAMANHO_MAXIMO_REGISTRO];
+    if (!diario ||
+        fwrite(registro, (size_t)codificarOperacao(&op, registro), 1, diario) != 1 ||
+        fflush(diario) != 0)  // Entrega ao sistema; o fsync é feito pelo grupo
+        falhaNoDiario("gravar");
+
+    if (totalPendentes == 0)
+        inicioGrupoMs = agoraMs();
+    operacoesPendentes = garantirCapacidade(operacoesPendentes, &capacidadePendentes,
+                                            totalPendentes + 1, sizeof(Operacao));
+    operacoesPendentes[totalPendentes++] = op;
+
+    if (totalPendentes >= grupoCommit ||
+        (esperaMaximaMs > 0 && agoraMs() - inicioGrupoMs >= esperaMaximaMs))
+        confirmarDiario();
+}
+
+/*
+ * Função: reaplicarOperacao
+ * Objetivo: Reaplicar uma operação lida do diário na inicialização
+ *           Inserções já presentes nos arquivos são ignoradas; atualizações
+ *           de status são sempre refeitas (na ordem do diário)
+ * Parâmetros: op - operação lida do diário
+ * Retorno: void
+ */
+void reaplicarOperacao(const Operacao *op)
+{
+    switch (op->tipo)
+    {
+    case OP_CLIENTE:
+        if (indiceBuscar(&indiceClientes, op->dados.cliente.codigoCliente) >= 0)
+            return;
+        inserirClienteTabela(op->dados.cliente);
+        break;
+    case OP_FUNCIONARIO:
+        for (int i = totalFuncionarios - 1; i >= 0; i--)
+            if (tabelaFuncionarios[i].codigoFuncionario == op->dados.funcionario.codigoFuncionario)
+                return;  // Já está no arquivo (em geral entre os últimos)
+        inserirFuncionarioTabela(op->dados.funcionario);
+        break;
+    case OP_QUARTO:
+        if (mapaQuartosBuscar(op->dados.quarto.numeroQuarto) >= 0)
+            return;
+        inserirQuartoTabela(op->dados.quarto);
+        break;
+    case OP_ESTADIA:
+        if (indiceBuscar(&indiceEstadias, op->dados.estadia.codigoEstadia) >= 0)
+        {
+            // Estadia já gravada; o status do quarto pode não ter sido
+            quartoOcupado(op->dados.estadia.numeroQuarto,
+                          quartoOcupadoHoje(op->dados.estadia.numeroQuarto));
+            return;
+        }
+        inserirEstadiaTabela(op->dados.estadia);
+        break;
+    case OP_RESGATE:
+    {
+        int posicao = indiceBuscar(&indiceClientes, op->dados.resgate.codigoCliente);
+        if (posicao < 0)
+            return;
+        SaldoFidelidade *s = &saldosFidelidade[posicao];
+        if (op->dados.resgate.pontosResgatados > s->pontosResgatados)
+            s->pontosResgatados = op->dados.resgate.pontosResgatados;
+        fidelidadeAlterada = 1;
+        break;
+    }
+    }
+    aplicarNosArquivos(op);
+}
+
+/*
+ * Função: encerrarDiario
+ * Objetivo: Confirmar operações pendentes e fazer o checkpoint final
+ *           Registrada com atexit para valer em qualquer saída do programa
+ * Parâmetros: -
+ * Retorno: void
+ */
+void encerrarDiario()
+{
+    confirmarDiario();
+    travarAlteracao();  // O checkpoint grava o livro de fidelidade
+    checkpointDiario();
+    liberarAlteracao();
+    if (diario)
+    {
+        fclose(diario);
+        diario = NULL;
+    }
+}
+
+/*
+ * Função: reproduzirDiarioAntigo
+ * Objetivo: Reaplicar as operações de um diário de versão anterior
+ *           (cabeçalho e dados gravados como structs da memória)
+ * Parâmetros: arq - diário aberto, posicionado no início
+ * Retorno: void
+ */
+void reproduzirDiarioAntigo(FILE *arq)
+{
+    CabecalhoDiario cab;
+    Operacao op;
+    // Lê até o fim ou até o primeiro registro incompleto/corrompido
+    while (fread(&cab, sizeof(CabecalhoDiario), 1, arq) == 1)
+    {
+        if (cab.tamanho != tamanhoOperacao(cab.tipo) || cab.tamanho == 0)
+            break;
+        if (fread(&op.dados, (size_t)cab.tamanho, 1, arq) != 1)
+            break;
+        if (somaVerificacao(&op.dados, (size_t)cab.tamanho) != cab.soma)
+            break;
+
+        op.tipo = cab.tipo;
+        reaplicarOperacao(&op);
+    }
+}
+
+/*
+ * Função: reproduzirDiarioArquivo
+ * Objetivo: Reaplicar as operações de um arquivo de diário
+ *           Encerra o programa se o diário for de outra versão do formato:
+ *           descartá-lo perderia operações já confirmadas
+ * Parâmetros: nome - arquivo do diário
+ * Retorno: void
+ */
+void reproduzirDiarioArquivo(const char *nome)
+{
+    FILE *arq = fopen(nome, "rb");
+    if (!arq)
+        return;
+
+    unsigned char cabecalho[TAMANHO_CABECALHO_DIARIO];
+    size_t lidos = fread(cabecalho, 1, sizeof(cabecalho), arq);
+    if (!temAssinatura(cabecalho, lidos))
+    {
+        rewind(arq);
+        reproduzirDiarioAntigo(arq);
+        fclose(arq);
+        return;
+    }
+    if (lidos < sizeof(cabecalho))
+    {
+        fclose(arq);  // Queda ao recriar o diário: não há operações
+        return;
+    }
+    if (lerPalavra(cabecalho + 8) != FORMATO_VERSAO || lerPalavra(cabecalho + 12) != REGISTRO_DIARIO)
+    {
+        printf("Erro: %s e de outra versao do formato ou esta danificado.\n", nome);
+        exit(1);
+    }
+
+    unsigned char registro[TAMANHO_CABECALHO_OPERACAO + TAMANHO_MAXIMO_REGISTRO];
+    unsigned char *dados = registro + TAMANHO_CABECALHO_OPERACAO;
+    Operacao op;
+    // Lê até o fim ou até o primeiro registro incompleto/corrompido
+    while (fread(registro, TAMANHO_CABECALHO_OPERACAO, 1, arq) == 1)
+    {
+        int tipo = (int)lerPalavra(registro);
+        int tamanho = (int)lerPalavra(registro + 4);
+        if (tamanho != tamanhoNoDiario(tipo) || tamanho == 0)
+            break;
+        if (fread(dados, (size_t)tamanho, 1, arq) != 1)
+            break;
+        unsigned int soma = continuarCrc32c(0, registro, 8);
+        if (continuarCrc32c(soma, dados, (size_t)tamanho) != lerPalavra(registro + 8))
+            break;
+
+        decodificarOperacao(tipo, dados, &op);
+        reaplicarOperacao(&op);
+    }
+    fclose(arq);
+}
+
+/*
+ * Função: reproduzirDiario
+ * Objetivo: Na inicialização, reaplicar os diários sem dono sobre os
+ *           arquivos de dados, tomar posse de um diário livre, fazer o
+ *           checkpoint e abrir o diário
+ *           Só lendo (somenteLeitura), os diários sem dono são aplicados
+ *           só na memória e nenhum diário é criado ou esvaziado
+ *           Lê também a configuração da confirmação em grupo
+ * Parâmetros: -
+ * Retorno: void
+ */
+void reproduzirDiario()
+{
+    const char *valor = getenv("HOTEL_GRUPO_COMMIT");
+    if (valor && atoi(valor) > 0)
+        grupoCommit = atoi(valor);
+    valor = getenv("HOTEL_GRUPO_COMMIT_MS");
+    if (valor && atoi(valor) > 0)
+        esperaMaximaMs = atoi(valor);
+
+    if (somenteLeitura)
+    {
+        // Só na memória: os diários continuam para quem abrir o sistema depois
+        travarDados(TRAVA_COMPARTILHADA);
+        for (int i = 0; i < MAX_DIARIOS; i++)
+        {
+            if (!travarByte(BYTE_TRAVA_DADOS + 1 + i, TRAVA_EXCLUSIVA, 0))
+                continue;
+            char nome[32];
+            nomeDoDiario(i, nome, sizeof(nome));
+            reproduzirDiarioArquivo(nome);
+            travarByte(BYTE_TRAVA_DADOS + 1 + i, TRAVA_LIVRE, 0);
+        }
+        travarDados(TRAVA_LIVRE);
+        return;
+    }
+
+    travarAlteracao();  // Inclui o que outros processos gravaram após a carga
+
+    // Diário travado pertence a um processo em execução; os demais estão
+    // livres ou sobraram de uma queda
+    int proprio = -1;
+    for (int i = 0; i < MAX_DIARIOS; i++)
+    {
+        if (!travarByte(BYTE_TRAVA_DADOS + 1 + i, TRAVA_EXCLUSIVA, 0))
+            continue;
+        char nome[32];
+        nomeDoDiario(i, nome, sizeof(nome));
+        reproduzirDiarioArquivo(nome);
+
+        if (proprio < 0)
+        {
+            proprio = i;  // Fica com o primeiro livre
+            snprintf(nomeDiario, sizeof(nomeDiario), "%s", nome);
+        }
+        else
+        {
+            remove(nome);  // Já reaplicado
+            travarByte(BYTE_TRAVA_DADOS + 1 + i, TRAVA_LIVRE, 0);
+        }
+    }
+    if (proprio < 0)
+    {
+        printf("Erro: %d processos ja estao usando estes dados. Feche algum e tente novamente.\n",
+               MAX_DIARIOS);
+        exit(1);
+    }
+
+    checkpointDiario();  // Arquivos atualizados: diário pode ser esvaziado
+    liberarAlteracao();
+    if (diario)
+        fclose(diario);
+    atexit(encerrarDiario);
+    if (!(diario = fopen(nomeDiario, "ab")))
+        falhaNoDiario("abrir");
+}
+
+// ============================================================
+// FUNÇÕES PARA SALVAR DADOS EM ARQUIVOS
+// ============================================================
+
+/*
+ * Função: salvarClienteArquivo
+ * Objetivo: Salvar um cliente na tabela em memória e registrá-lo no diário
+ *           (o arquivo binário recebe o registro na confirmação do grupo)
+ * Parâmetros: c - estrutura Cliente a ser salva
+ * Retorno: void
+ */
+void salvarClienteArquivo(Cliente c)
+{
+    travarAlteracao();
+    inserirClienteTabela(c);
+    registrarOperacao(OP_CLIENTE, &c);
+}
+
+/*
+ * Função: salvarFuncionarioArquivo
+ * Objetivo: Salvar um funcionário na tabela e registrá-lo no diário
+ * Parâmetros: arquivo - estrutura Funcionario a ser salva
+ * Retorno: void
+ */
+void salvarFuncionarioArquivo(Funcionario arquivo)
+{
+    travarAlteracao();
+    inserirFuncionarioTabela(arquivo);
+    registrarOperacao(OP_FUNCIONARIO, &arquivo);
+}
+
+/*
+ * Função: salvarQuartoArquivo
+ * Objetivo: Salvar um quarto na tabela e registrá-lo no diário
+ *           O número é conferido de novo com a trava: outro processo pode
+ *           ter cadastrado o mesmo quarto depois da validação
+ * Parâmetros: q - estrutura Quarto a ser salva
+ * Retorno: int - 1 se salvou, 0 se o número já existe
+ */
+int salvarQuartoArquivo(Quarto q)
+{
+    travarAlteracao();
+    if (mapaQuartosBuscar(q.numeroQuarto) >= 0)
+    {
+        liberarAlteracao();
+        return 0;
+    }
+    inserirQuartoTabela(q);
+    registrarOperacao(OP_QUARTO, &q);
+    return 1;
+}
+
+/*
+ * Função: salvarEstadiaArquivo
+ * Objetivo: Salvar uma estadia e marcar seu quarto como ocupado, como uma
+ *           única operação do diário
+ *           O período é conferido de novo com a trava: outro processo pode
+ *           ter reservado o quarto depois da validação
+ * Parâmetros: e - estrutura Estadia a ser salva
+ * Retorno: int - 1 se salvou, 0 se o quarto não está mais livre no período
+ */
+int salvarEstadiaArquivo(Estadia e)
+{
+    travarAlteracao();
+    int posicao = mapaQuartosBuscar(e.numeroQuarto);
+    if (e.estadiaAtiva &&
+        (posicao < 0 || !quartoLivreNoPeriodo(posicao, diaSerial(e.dataEntrada), diaSerial(e.dataSaida))))
+    {
+        liberarAlteracao();
+        return 0;
+    }
+    inserirEstadiaTabela(e);  // Também reserva o período na agenda do quarto
+    registrarOperacao(OP_ESTADIA, &e);
+    return 1;
+}
+
+/*
+ * Função: resgatarPontos
+ * Objetivo: Trocar pontos de fidelidade de um cliente por um benefício,
+ *           descontando do saldo disponível (acumulados - resgatados)
+ *           O saldo é conferido com a trava: outra recepção pode ter
+ *           resgatado os mesmos pontos
+ * Parâmetros: codigoCliente - cliente que resgata
+ *             pontos - pontos a resgatar (positivo)
+ *             disponivel - recebe o saldo após a operação (pode ser NULL)
+ * Retorno: int - 1 se resgatou, 0 se o saldo não basta, -1 se o cliente
+ *          não existe
+ */
+int resgatarPontos(int codigoCliente, int pontos, int *disponivel)
+{
+    travarAlteracao();
+    int posicao = indiceBuscar(&indiceClientes, codigoCliente);
+    if (posicao < 0)
+    {
+        liberarAlteracao();
+        return -1;
+    }
+
+    SaldoFidelidade *s = &saldosFidelidade[posicao];
+    int saldo = s->pontos - s->pontosResgatados;
+    if (pontos <= 0 || pontos > saldo)
+    {
+        if (disponivel)
+            *disponivel = saldo;
+        liberarAlteracao();
+        return 0;
+    }
+
+    s->pontosResgatados += pontos;
+    fidelidadeAlterada = 1;
+    Resgate r = {codigoCliente, s->pontosResgatados};
+    registrarOperacao(OP_RESGATE, &r);
+    if (disponivel)
+        *disponivel = saldo - pontos;
+    return 1;
+}
+
+// ============================================================
+// FUNÇÃO PARA CÁLCULO DE DIAS ENTRE DATAS
+// ============================================================
+
+/*
+ * Função: diasEntreDatas
+ * Objetivo: Calcular o número de dias entre duas datas
+ *           Usado para calcular diárias de estadia
+ * Parâmetros: e - data de entrada
+ *             s - data de saída
+ * Retorno: int - número de dias, ou -1 se datas inválidas
+ */
+int diasEntreDatas(Data e, Data s)
+{
+    // Primeiro validar ambas as datas
+    if (!validarData(e) || !validarData(s)) {
+        return -1;  // Datas inválidas
+    }
+
+    // Diferença de dias seriais: tempo constante, sem percorrer os meses
+    int dias = diaSerial(s) - diaSerial(e);
+    if (dias <= 0)
+        return -1;  // Saída não é posterior à entrada
+
+    return dias;  // Retorna total de dias
+}
+
+// ============================================================
+// FUNÇÕES DE BUSCA EM ARQUIVOS
+// ============================================================
+
+/*
+ * Função: buscarCliente
+ * Objetivo: Buscar um cliente pelo código
+ * Parâmetros: codigo - código do cliente a buscar
+ *             resultado - ponteiro para armazenar cliente encontrado
+ * Retorno: int - 1 se encontrou, 0 se não encontrou
+ */
+int buscarCliente(int codigo, Cliente *resultado)
+{
+    // Consulta o índice hash: acesso direto à posição do cliente
+    int posicao = indiceBuscar(&indiceClientes, codigo);
+    if (posicao < 0)
+        return 0;  // Cliente não encontrado
+
+    *resultado = tabelaClientes[posicao];  // Copia cliente encontrado
+    return 1;  // Sucesso
+}
+
+/*
+ * Função: buscarQuarto
+ * Objetivo: Buscar um quarto pelo número
+ * Parâmetros: numero - número do quarto a buscar
+ *             resultado - ponteiro para armazenar quarto encontrado
+ * Retorno: int - 1 se encontrou, 0 se não encontrou
+ */
+int buscarQuarto(int numero, Quarto *resultado)
+{
+    // Acesso direto pela tabela de endereçamento por número
+    int posicao = mapaQuartosBuscar(numero);
+    if (posicao < 0)
+        return 0;
+
+    *resultado = tabelaQuartos[posicao];
+    return 1;
+}
+
+// ============================================================
+// FUNÇÕES PARA PESQUISA DE CLIENTES
+// ============================================================
+
+/*
+ * Função: pesquisarCliente
+ * Objetivo: Pesquisar cliente por código ou nome
+ *           Permite busca exata por código ou parcial por nome
+ * Parâmetros: -
+ * Retorno: void
+ */
+void pesquisarCliente()
+{
+    int opcao;  // Opção de busca (1=código, 2=nome)
+    printf("\n=== PESQUISAR CLIENTE ===\n");
+    printf("1 - Pesquisar por codigo\n");
+    printf("2 - Pesquisar por nome\n");
+    printf("Opcao: ");
+    scanf("%d", &opcao);
+    limparEntrada();  // Limpa buffer após scanf
+    
+    if (totalClientes == 0)
+    {
+        printf("Nenhum cliente cadastrado.\n");
+        return;
+    }
+    
+    int encontrou = 0;  // Flag para indicar se encontrou resultados
+    
+    // Busca por código
+    if (opcao == 1)
+    {
+        int codigo;
+        printf("Digite o codigo do cliente: ");
+        scanf("%d", &codigo);
+        limparEntrada();
+        
+        // Busca direta pelo índice de códigos
+        Cliente c;
+        if (buscarCliente(codigo, &c))
+        {
+            printf("\n=== CLIENTE ENCONTRADO ===\n");
+            printf("Codigo: %d\n", c.codigoCliente);
+            printf("Nome: %s\n", c.nome);
+            printf("Endereco: %s\n", c.endereco);
+            printf("Telefone: %s\n", c.telefone);
+            encontrou = 1;
+        }
+    }
+    // Busca por nome (parcial)
+    else if (opcao == 2)
+    {
+        char nomeBusca[50];
+        printf("Digite o nome (ou parte do nome) do cliente: ");
+        fgets(nomeBusca, 50, stdin);
+        nomeBusca[strcspn(nomeBusca, "\n")] = 0;  // Remove \n do final
+        
+        printf("\n=== RESULTADOS DA PESQUISA ===\n");
+        // Consulta o índice de trigramas (ignora maiúsculas e acentos)
+        int encontrados = pesquisarNomesClientes(nomeBusca);
+        for (int i = 0; i < encontrados; i++)
+        {
+            Cliente c = tabelaClientes[resultadosNome[i]];
+            printf("\nCodigo: %d\n", c.codigoCliente);
+            printf("Nome: %s\n", c.nome);
+            printf("Endereco: %s\n", c.endereco);
+            printf("Telefone: %s\n", c.telefone);
+            printf("-------------------\n");
+            encontrou = 1;
+        }
+    }
+    else
+    {
+        printf("Opcao invalida!\n");
+        return;
+    }
+    
+    // Mensagem se não encontrou - cliente
+    if (!encontrou)
+        printf("Cliente nao encontrado.\n");
+    
+    // Pausa para usuário ver resultados
+    printf("\nPressione ENTER para voltar ao menu...");
+    getchar();
+}
+
+/*
+ * Função: pesquisarFuncionario
+ * Objetivo: Pesquisar funcionário por código ou nome
+ *           Funcionamento similar a pesquisarCliente
+ * Parâmetros: -
+ * Retorno: void
+ */
+void pesquisarFuncionario()
+{
+    int opcao;
+    printf("\n=== PESQUISAR FUNCIONARIO ===\n");
+    printf("1 - Pesquisar por codigo\n");
+    printf("2 - Pesquisar por nome\n");
+    printf("Opcao: ");
+    scanf("%d", &opcao);
+    limparEntrada();
+    
+    if (totalFuncionarios == 0)
+    {
+        printf("Nenhum funcionario cadastrado.\n");
+        return;
+    }
+    
+    int encontrou = 0;
+    
+    if (opcao == 1)
+    {
+        int codigo;
+        printf("Digite o codigo do funcionario: ");
+        scanf("%d", &codigo);
+        limparEntrada();
+        
+        for (int i = 0; i < totalFuncionarios; i++)
+        {
+            Funcionario func = tabelaFuncionarios[i];
+            if (func.codigoFuncionario == codigo)
+            {
+                printf("\n=== FUNCIONARIO ENCONTRADO ===\n");
+                printf("Codigo: %d\n", func.codigoFuncionario);
+                printf("Nome: %s\n", func.nome);
+                printf("Telefone: %s\n", func.telefone);
+                printf("Cargo: %s\n", func.cargo);
+                printf("Salario: R$ %.2f\n", func.salario);
+                encontrou = 1;
+                break;
+            }
+        }
+    }
+    else if (opcao == 2)
+    {
+        char nomeBusca[50];
+        printf("Digite o nome (ou parte do nome) do funcionario: ");
+        fgets(nomeBusca, 50, stdin);
+        nomeBusca[strcspn(nomeBusca, "\n")] = 0;
+        
+        printf("\n=== RESULTADOS DA PESQUISA ===\n");
+        int encontrados = pesquisarNomesFuncionarios(nomeBusca);
+        for (int i = 0; i < encontrados; i++)
+        {
+            Funcionario func = tabelaFuncionarios[resultadosNome[i]];
+            printf("\nCodigo: %d\n", func.codigoFuncionario);
+            printf("Nome: %s\n", func.nome);
+            printf("Telefone: %s\n", func.telefone);
+            printf("Cargo: %s\n", func.cargo);
+            printf("Salario: R$ %.2f\n", func.salario);
+            printf("-------------------\n");
+            encontrou = 1;
+        }
+    }
+    else
+    {
+        printf("Opcao invalida!\n");
+        return;
+    }
+    
+    if (!encontrou)
+        printf("Funcionario nao encontrado.\n");
+    
+    printf("\nPressione ENTER para voltar ao menu...");
+    getchar();
+}
+
+// ============================================================
+// FUNÇÃO PARA MOSTRAR ESTADIAS DE UM CLIENTE
+// ============================================================
+
+/*
+ * Função: mostrarEstadiasCliente
+ * Objetivo: Mostrar todas as estadias de um cliente específico
+ *           Permite busca por código ou nome do cliente
+ * Parâmetros: -
+ * Retorno: void
+ */
+void mostrarEstadiasCliente()
+{
+    int opcao;
+    printf("\n=== PESQUISAR ESTADIAS POR CLIENTE ===\n");
+    printf("1 - Pesquisar por codigo do cliente\n");
+    printf("2 - Pesquisar por nome do cliente\n");
+    printf("Opcao: ");
+    scanf("%d", &opcao);
+    limparEntrada();
+    
+    int codigoCliente = -1;      // Código do cliente encontrado
+    char nomeCliente[50] = "";   // Nome do cliente
+    
+    // Busca por código
+    if (opcao == 1)
+    {
+        printf("Digite o codigo do cliente: ");
+        scanf("%d", &codigoCliente);
+        limparEntrada();
+        
+        // Verificar se o cliente existe
+        Cliente c;
+        if (!buscarCliente(codigoCliente, &c))
+        {
+            printf("Cliente nao encontrado.\n");
+            printf("\nPressione ENTER para voltar ao menu...");
+            getchar();
+            return;
+        }
+        strcpy(nomeCliente, c.nome);  // Armazena nome do cliente
+    }
+    // Busca por nome
+    else if (opcao == 2)
+    {
+        char nomeBusca[50];
+        printf("Digite o nome (ou parte do nome) do cliente: ");
+        fgets(nomeBusca, 50, stdin);
+        nomeBusca[strcspn(nomeBusca, "\n")] = 0;
+        
+        // Buscar cliente pelo nome na tabela
+        if (totalClientes == 0)
+        {
+            printf("Nenhum cliente cadastrado.\n");
+            printf("\nPressione ENTER para voltar ao menu...");
+            getchar();
+            return;
+        }
+        
+        int encontrados = 0;
+        int primeiro = -1;  // Posição do primeiro cliente encontrado
+        printf("\n=== CLIENTES ENCONTRADOS ===\n");
+        
+        // Lista todos os clientes que correspondem à busca
+        encontrados = pesquisarNomesClientes(nomeBusca);
+        for (int i = 0; i < encontrados; i++)
+            printf("%d - %s\n", tabelaClientes[resultadosNome[i]].codigoCliente,
+                   tabelaClientes[resultadosNome[i]].nome);
+        if (encontrados > 0)
+            primeiro = resultadosNome[0];
+        
+        // Se não encontrou nenhum cliente
+        if (encontrados == 0)
+        {
+            printf("Nenhum cliente encontrado com esse nome.\n");
+            printf("\nPressione ENTER para voltar ao menu...");
+            getchar();
+            return;
+        }
+        
+        // Se encontrou mais de um cliente, pede para escolher
+        if (encontrados > 1)
+        {
+            printf("\nDigite o codigo do cliente desejado: ");
+            scanf("%d", &codigoCliente);
+            limparEntrada();
+            
+            // Obter nome do cliente selecionado
+            Cliente clienteSelecionado;
+            if (buscarCliente(codigoCliente, &clienteSelecionado))
+            {
+                strcpy(nomeCliente, clienteSelecionado.nome);
+            }
+        }
+        else  // Se encontrou apenas um cliente
+        {
+            // Usa diretamente o único cliente encontrado
+            codigoCliente = tabelaClientes[primeiro].codigoCliente;
+            strcpy(nomeCliente, tabelaClientes[primeiro].nome);
+        }
+    }
+    else
+    {
+        printf("Opcao invalida!\n");
+        printf("\nPressione ENTER para voltar ao menu...");
+        getchar();
+        return;
+    }
+    
+    // Agora mostrar as estadias deste cliente
+    if (totalEstadias == 0)
+    {
+        printf("Nenhuma estadia registrada.\n");
+        printf("\nPressione ENTER para voltar ao menu...");
+        getchar();
+        return;
+    }
+    
+    int estadiasCliente = 0;  // Contador de estadias
+    int totalDiarias = 0;     // Acumulador de diárias
+    
+    printf("\n=== ESTADIAS DO CLIENTE: %s (Codigo: %d) ===\n", nomeCliente, codigoCliente);
+    printf("==============================================\n");
+    
+    // Percorre só a lista de estadias do cliente
+    for (int i = indiceBuscar(&primeiraEstadiaCliente, codigoCliente); i >= 0;
+         i = colunasEstadias.proximaDoCliente[i])
+    {
+        Estadia e = estadiaAtual(i);
+        printf("\nEstadia: %d\n", e.codigoEstadia);
+        printf("Quarto: %d\n", e.numeroQuarto);
+        printf("Entrada: %02d/%02d/%04d\n", e.dataEntrada.dia, e.dataEntrada.mes, e.dataEntrada.ano);
+        printf("Saida: %02d/%02d/%04d\n", e.dataSaida.dia, e.dataSaida.mes, e.dataSaida.ano);
+        printf("Diarias: %d\n", e.quantidadeDiarias);
+        printf("Status: %s\n", e.estadiaAtiva ? "ATIVA" : "FINALIZADA");
+        printf("-------------------\n");
+        
+        estadiasCliente++;
+        totalDiarias += e.quantidadeDiarias;
+    }
+    
+    // Mostra resumo
+    if (estadiasCliente == 0)
+    {
+        printf("Nenhuma estadia encontrada para este cliente.\n");
+    }
+    else
+    {
+        printf("\nRESUMO:\n");
+        printf("Total de estadias: %d\n", estadiasCliente);
+        printf("Total de diarias: %d\n", totalDiarias);
+        
+        // Pontos do livro de fidelidade, já descontados os resgates
+        const SaldoFidelidade *saldo = saldoCliente(codigoCliente);
+        if (saldo)
+        {
+            printf("Pontos de fidelidade: %d pontos\n", saldo->pontos - saldo->pontosResgatados);
+            if (saldo->pontosResgatados > 0)
+                printf("Pontos ja resgatados: %d pontos\n", saldo->pontosResgatados);
+        }
+    }
+    
+    printf("\nPressione ENTER para voltar ao menu...");
+    getchar();
+}
+
+// ============================================================
+// FUNÇÃO PARA CALCULAR PONTOS DE FIDELIDADE
+// ============================================================
+
+/*
+ * Função: calcularPontosFidelidade
+ * Objetivo: Calcular pontos de fidelidade de um cliente
+ *           Sistema: 10 pontos por diária hospedada
+ * Parâmetros: Nenhum
+ * Retorno: void
+ */
+void calcularPontosFidelidade()
+{
+    int opcao;
+    printf("\n=== CALCULAR PONTOS DE FIDELIDADE ===\n");
+    printf("1 - Calcular por codigo do cliente\n");
+    printf("2 - Calcular por nome do cliente\n");
+    printf("Opcao: ");
+    scanf("%d", &opcao);
+    limparEntrada();
+    
+    int codigoCliente = -1;
+    char nomeCliente[50] = "";
+    
+    // Processamento similar à função mostrarEstadiasCliente
+    if (opcao == 1)
+    {
+        printf("Digite o codigo do cliente: ");
+        scanf("%d", &codigoCliente);
+        limparEntrada();
+        
+        Cliente c;
+        if (!buscarCliente(codigoCliente, &c))
+        {
+            printf("Cliente nao encontrado.\n");
+            printf("\nPressione ENTER para voltar ao menu...");
+            getchar();
+            return;
+        }
+        strcpy(nomeCliente, c.nome);
+    }
+    else if (opcao == 2)
+    {
+        char nomeBusca[50];
+        printf("Digite o nome (ou parte do nome) do cliente: ");
+        fgets(nomeBusca, 50, stdin);
+        nomeBusca[strcspn(nomeBusca, "\n")] = 0;
+        
+        if (totalClientes == 0)
+        {
+            printf("Nenhum cliente cadastrado.\n");
+            printf("\nPressione ENTER para voltar ao menu...");
+            getchar();
+            return;
+        }
+        
+        int encontrados = 0;
+        int primeiro = -1;
+        printf("\n=== CLIENTES ENCONTRADOS ===\n");
+        
+        encontrados = pesquisarNomesClientes(nomeBusca);
+        for (int i = 0; i < encontrados; i++)
+            printf("%d - %s\n", tabelaClientes[resultadosNome[i]].codigoCliente,
+                   tabelaClientes[resultadosNome[i]].nome);
+        if (encontrados > 0)
+            primeiro = resultadosNome[0];
+        
+        if (encontrados == 0)
+        {
+            printf("Nenhum cliente encontrado com esse nome.\n");
             printf("\nPressione ENTER para voltar ao menu...");
             getchar();
             return;
         }
-        strcpy(nomeCliente, c.nome);  // Armazena nome do cliente
+        
+        if (encontrados > 1)
+        {
+            printf("\nDigite o codigo do cliente desejado: ");
+            scanf("%d", &codigoCliente);
+            limparEntrada();
+            
+            Cliente clienteSelecionado;
+            if (buscarCliente(codigoCliente, &clienteSelecionado))
+            {
+                strcpy(nomeCliente, clienteSelecionado.nome);
+            }
+        }
+        else
+        {
+            codigoCliente = tabelaClientes[primeiro].codigoCliente;
+            strcpy(nomeCliente, tabelaClientes[primeiro].nome);
+        }
+    }
+    else
+    {
+        printf("Opcao invalida!\n");
+        printf("\nPressione ENTER para voltar ao menu...");
+        getchar();
+        return;
+    }
+    
+    // Calcular pontos de fidelidade
+    if (totalEstadias == 0)
+    {
+        printf("Nenhuma estadia registrada.\n");
+        printf("\nPressione ENTER para voltar ao menu...");
+        getchar();
+        return;
+    }
+    
+    // Saldo mantido a cada estadia: consulta direta, sem percorrer o histórico
+    const SaldoFidelidade *saldo = saldoCliente(codigoCliente);
+    int estadiasCliente = saldo ? saldo->totalEstadias : 0;
+    int totalDiarias = saldo ? saldo->totalDiarias : 0;
+    int pontos = saldo ? saldo->pontos - saldo->pontosResgatados : 0;
+    
+    // Exibe resultados
+    printf("\n=== PONTOS DE FIDELIDADE ===\n");
+    printf("Cliente: %s (Codigo: %d)\n", nomeCliente, codigoCliente);
+    printf("Total de estadias: %d\n", estadiasCliente);
+    printf("Total de diarias: %d\n", totalDiarias);
+    printf("Pontos de fidelidade: %d pontos\n", pontos);
+    if (saldo && saldo->pontosResgatados > 0)
+        printf("Pontos ja resgatados: %d pontos\n", saldo->pontosResgatados);
+    printf("\n(10 pontos por diaria hospedada)\n");
+    
+    // Mostra benefícios disponíveis baseados nos pontos
+    if (pontos > 0)
+    {
+        printf("\nVANTAGENS:\n");
+        if (pontos >= 100)
+            printf("- %d pontos: Direito a 1 diaria gratis!\n", (pontos/100)*100);
+        if (pontos >= 50)
+            printf("- %d pontos: Upgrade de quarto disponivel\n", (pontos/50)*50);
+        printf("- Proximo beneficio: %d pontos\n", ((pontos/100)+1)*100);
+
+        // Troca de pontos por um benefício (0 = só consultar)
+        int resgate = 0;
+        printf("\nPontos a resgatar (0 = nenhum): ");
+        scanf("%d", &resgate);
+        limparEntrada();
+        if (resgate > 0)
+        {
+            int restantes = 0;
+            int resultado = resgatarPontos(codigoCliente, resgate, &restantes);
+            if (resultado > 0)
+                printf("Resgate de %d pontos registrado. Saldo: %d pontos\n", resgate, restantes);
+            else if (resultado == 0)
+                printf("Saldo insuficiente: %d pontos disponiveis.\n", restantes);
+            else
+                printf("Cliente nao encontrado.\n");
+        }
+    }
+    
+    printf("\nPressione ENTER para voltar ao menu...");
+    getchar();
+}
+
+// ============================================================
+// FUNÇÕES DE CADASTRO
+// ============================================================
+
+/*
+ * Função: cadastrarCliente
+ * Objetivo: Cadastrar um novo cliente no sistema
+ *           Coleta informações via console e salva em arquivo
+ * Parâmetros: Nenhum
+ * Retorno: void
+ */
+void cadastrarCliente()
+{
+    Cliente c;
+
+    // Limpa buffer e coleta dados do cliente
+    limparEntrada();
+    printf("\nNome completo: ");
+    fgets(c.nome, 50, stdin);
+    c.nome[strcspn(c.nome, "\n")] = 0;  // Remove \n do final
+
+    printf("Endereco: ");
+    fgets(c.endereco, 50, stdin);
+    c.endereco[strcspn(c.endereco, "\n")] = 0;
+
+    printf("Telefone: ");
+    fgets(c.telefone, 20, stdin);
+    c.telefone[strcspn(c.telefone, "\n")] = 0;
+
+    // Gera o código só depois da digitação: a reserva trava os dados
+    c.codigoCliente = gerarCodigoCliente();
+
+    // Salva cliente no arquivo
+    salvarClienteArquivo(c);
+    printf("\nCliente cadastrado com sucesso! (Codigo %d)\n", c.codigoCliente);
+    
+    // Pausa antes de voltar ao menu
+    printf("\nPressione ENTER para voltar ao menu...");
+    limparEntrada();
+    getchar();
+}
+
+/*
+ * Função: cadastrarFuncionario
+ * Objetivo: Cadastrar um novo funcionário no sistema
+ *           Inclui validação de salário (não pode ser negativo)
+ * Parâmetros: Nenhum
+ * Retorno: void
+ */
+void cadastrarFuncionario()
+{
+    Funcionario arquivo;
+
+    // Coleta dados básicos
+    limparEntrada();
+    printf("\nNome completo: ");
+    fgets(arquivo.nome, 50, stdin);
+    arquivo.nome[strcspn(arquivo.nome, "\n")] = 0;
+
+    printf("Telefone: ");
+    fgets(arquivo.telefone, 20, stdin);
+    arquivo.telefone[strcspn(arquivo.telefone, "\n")] = 0;
+
+    printf("Cargo: ");
+    fgets(arquivo.cargo, 30, stdin);
+    arquivo.cargo[strcspn(arquivo.cargo, "\n")] = 0;
+
+    // Validação de salário (deve ser positivo)
+    do
+    {
+        printf("Salario: ");
+        scanf("%lf", &arquivo.salario);
+        if (arquivo.salario < 0)
+            printf("Valor invalido! O salario nao pode ser negativo.\n");
+    } while (arquivo.salario < 0);
+
+    // Salva funcionário (código gerado depois da digitação)
+    arquivo.codigoFuncionario = gerarCodigoFuncionario();
+    salvarFuncionarioArquivo(arquivo);
+    printf("\nFuncionario cadastrado! (Codigo %d)\n", arquivo.codigoFuncionario);
+
+    printf("\nPressione ENTER para voltar ao menu...");
+    limparEntrada();
+    getchar();
+}
+
+/*
+ * Função: cadastrarQuarto
+ * Objetivo: Cadastrar um novo quarto no hotel
+ *           Valida número único, capacidade positiva e valor positivo
+ * Parâmetros: Nenhum
+ * Retorno: void
+ */
+void cadastrarQuarto()
+{
+    Quarto q;
+
+    // Valida número do quarto (deve ser positivo)
+    do
+    {
+        printf("\nNumero do quarto: ");
+        scanf("%d", &q.numeroQuarto);
+        if (q.numeroQuarto <= 0)
+            printf("Numero invalido! O numero do quarto deve ser positivo.\n");
+    } while (q.numeroQuarto <= 0);
+
+    // Verifica se quarto com esse número já existe
+    Quarto existente;
+    if (buscarQuarto(q.numeroQuarto, &existente))
+    {
+        printf("Ja existe um quarto com esse numero.\n");
+        return;
+    }
+
+    // Valida capacidade (deve ser maior que zero)
+    do
+    {
+        printf("Capacidade: ");
+        scanf("%d", &q.capacidade);
+        if (q.capacidade <= 0)
+            printf("Capacidade invalida! Deve ser maior que zero.\n");
+    } while (q.capacidade <= 0);
+
+    // Valida valor da diária (deve ser positivo)
+    do
+    {
+        printf("Valor da diaria: ");
+        scanf("%lf", &q.valorDiaria);
+        if (q.valorDiaria <= 0)
+            printf("Valor invalido! A diaria deve ser positiva.\n");
+    } while (q.valorDiaria <= 0);
+
+    q.estaOcupado = 0;  // Novo quarto começa como livre
+
+    // Salva quarto
+    if (salvarQuartoArquivo(q))
+        printf("\nQuarto cadastrado com sucesso!\n");
+    else
+        printf("\nJa existe um quarto com esse numero (cadastrado em outra recepcao).\n");
+
+    printf("\nPressione ENTER para voltar ao menu...");
+    limparEntrada();
+    getchar();
+}
+
+// ============================================================
+// FUNÇÃO PARA REGISTRAR NOVA ESTADIA
+// ============================================================
+
+/*
+ * Função: novaEstadia
+ * Objetivo: Registrar uma nova estadia/hospedagem
+ *           Processo completo: valida cliente, mostra quartos disponíveis,
+ *           valida datas, calcula diárias e atualiza status
+ * Parâmetros: Nenhum
+ * Retorno: void
+ */
+void novaEstadia()
+{
+    Estadia e;
+
+    // Valida código do cliente
+    do
+    {
+        printf("Codigo do cliente: ");
+        scanf("%d", &e.codigoCliente);
+        if (e.codigoCliente <= 0)
+            printf("Codigo invalido! Deve ser positivo.\n");
+    } while (e.codigoCliente <= 0);
+
+    // Verifica se cliente existe
+    Cliente ctmp;
+    if (!buscarCliente(e.codigoCliente, &ctmp))
+    {
+        printf("Cliente nao encontrado!\n");
+        return;
+    }
+
+    // Valida quantidade de hóspedes
+    int hospedes;
+    do
+    {
+        printf("Quantidade de hospedes: ");
+        scanf("%d", &hospedes);
+        if (hospedes <= 0)
+            printf("Quantidade invalida! Deve ser maior que zero.\n");
+    } while (hospedes <= 0);
+
+    // Lê o período antes de escolher o quarto: permite reservas futuras
+    if (!lerData("Data de entrada", &e.dataEntrada)) {
+        return; // Falha na leitura da data
+    }
+
+    if (!lerData("Data de saida", &e.dataSaida)) {
+        return; // Falha na leitura da data
+    }
+
+    // Calcula quantidade de diárias
+    e.quantidadeDiarias = diasEntreDatas(e.dataEntrada, e.dataSaida);
+    if (e.quantidadeDiarias <= 0)
+    {
+        printf("Datas invalidas! A data de saida deve ser posterior a data de entrada.\n");
+        return;
+    }
+
+    int entrada = diaSerial(e.dataEntrada), saida = diaSerial(e.dataSaida);
+
+    // Mostra quartos livres no período compatíveis com a capacidade
+    int encontrou = 0;  // Flag para verificar se há quartos disponíveis
+
+    printf("\nQuartos disponiveis para %d hospede(s) de %02d/%02d/%04d a %02d/%02d/%04d:\n",
+           hospedes, e.dataEntrada.dia, e.dataEntrada.mes, e.dataEntrada.ano,
+           e.dataSaida.dia, e.dataSaida.mes, e.dataSaida.ano);
+
+    for (int i = 0; i < totalQuartos; i++)
+    {
+        Quarto q = tabelaQuartos[i];
+        // Consulta a agenda do quarto (busca binária nos períodos ativos)
+        if (quartoDisponivel(i, hospedes, entrada, saida))
+        {
+            printf("Quarto %d | Capacidade %d | Diaria: R$ %.2f\n", 
+                   q.numeroQuarto, q.capacidade, q.valorDiaria);
+            encontrou = 1;
+        }
+    }
+
+    // Se não encontrou quartos disponíveis
+    if (!encontrou)
+    {
+        printf("\nNenhum quarto disponivel com essa capacidade.\n");
+        return;
+    }
+
+    // Solicita número do quarto desejado
+    do
+    {
+        printf("\nDigite o numero do quarto desejado: ");
+        scanf("%d", &e.numeroQuarto);
+        if (e.numeroQuarto <= 0)
+            printf("Numero invalido! Deve ser positivo.\n");
+    } while (e.numeroQuarto <= 0);
+
+    // Valida escolha do quarto
+    Quarto escolhido;
+    if (!buscarQuarto(e.numeroQuarto, &escolhido) ||
+        !quartoDisponivel(mapaQuartosBuscar(e.numeroQuarto), hospedes, entrada, saida))
+    {
+        printf("Quarto invalido ou indisponivel no periodo!\n");
+        return;
+    }
+
+    e.estadiaAtiva = 1;  // Marca estadia como ativa
+    e.codigoEstadia = gerarCodigoEstadia();  // Gera código só quando a estadia é válida
+
+    // Salva estadia e marca quarto como ocupado (uma operação do diário)
+    if (!salvarEstadiaArquivo(e))
+    {
+        printf("Quarto reservado em outra recepcao enquanto os dados eram digitados!\n");
+        return;
+    }
+
+    // Mostra resumo da estadia
+    printf("\nEstadia registrada com sucesso!\n");
+    printf("Codigo da estadia: %d\n", e.codigoEstadia);
+    printf("Total de diarias: %d\n", e.quantidadeDiarias);
+    
+    double valorTotal = e.quantidadeDiarias * escolhido.valorDiaria;
+    printf("Valor total estimado: R$ %.2f\n", valorTotal);
+    
+    printf("\nPressione ENTER para voltar ao menu...");
+    limparEntrada();
+    getchar();
+}
+
+// ============================================================
+// FUNÇÃO PARA ENCERRAR ESTADIA
+// ============================================================
+
+/*
+ * Função: finalizarEstadia
+ * Objetivo: Encerrar uma estadia ativa localizada pelo índice de códigos
+ * Parâmetros: codigo - código da estadia
+ *             valorTotal - ponteiro para receber o valor total da estadia
+ * Retorno: int - 1 se encerrou, 0 se a estadia não existe ou já foi finalizada
+ */
+int finalizarEstadia(int codigo, double *valorTotal)
+{
+    travarAlteracao();  // Outro processo pode já ter encerrado a estadia
+    int posicao = indiceBuscar(&indiceEstadias, codigo);
+    if (posicao < 0 || !colunasEstadias.estadiaAtiva[posicao])
+    {
+        liberarAlteracao();
+        return 0;
+    }
+
+    Estadia e = tabelaEstadias[posicao];
+
+    // Obtém informações do quarto para cálculo
+    Quarto q;
+    *valorTotal = buscarQuarto(e.numeroQuarto, &q) ? e.quantidadeDiarias * q.valorDiaria : 0.0;
+
+    // Estadia e quarto mudam juntos: uma única operação do diário
+    marcarEstadiaFinalizada(posicao);  // Também libera o período na agenda do quarto
+
+    Encerramento enc = {e.codigoEstadia, e.numeroQuarto};
+    registrarOperacao(OP_ENCERRAMENTO, &enc);
+    return 1;
+}
+
+/*
+ * Função: encerrarEstadia
+ * Objetivo: Encerrar uma estadia ativa
+ *           Calcula valor total, marca estadia como finalizada
+ *           e libera o quarto para nova ocupação
+ * Parâmetros: Nenhum
+ * Retorno: void
+ */
+void encerrarEstadia()
+{
+    int codigo;
+    // Valida código da estadia
+    do
+    {
+        printf("Codigo da estadia: ");
+        scanf("%d", &codigo);
+        if (codigo <= 0)
+            printf("Codigo invalido! Deve ser positivo.\n");
+    } while (codigo <= 0);
+
+    // Localiza a estadia pelo índice e encerra (estadia e quarto juntos)
+    double total;
+    int achou = finalizarEstadia(codigo, &total);
+    if (achou)
+        printf("\nValor total da estadia: R$ %.2f\n", total);
+
+    // Feedback para o usuário
+    if (!achou)
+        printf("Estadia nao encontrada.\n");
+    else
+        printf("Estadia encerrada!\n");
+    
+    printf("\nPressione ENTER para voltar ao menu...");
+    limparEntrada();
+    getchar();
+}
+
+// ============================================================
+// SAÍDA EM BLOCOS (LISTAGENS E EXPORTAÇÃO)
+// ============================================================
+
+/*
+ * As listagens faziam várias chamadas a printf por registro, e cada uma
+ * interpretava o formato de novo: com um milhão de estadias o tempo ia
+ * quase todo nisso. Aqui cada registro é montado direto num buffer
+ * (inteiros, datas e valores convertidos à mão) e o buffer vai para o
+ * arquivo com um único fwrite a cada TAMANHO_SAIDA bytes.
+ *
+ * O mesmo registro sai em três formatos:
+ *   FORMATO_FICHA - um campo por linha com rótulo (listagens do menu)
+ *   FORMATO_TSV   - uma linha por registro, campos separados por TAB
+ *                   (respostas do modo lote; é o formato de sempre)
+ *   FORMATO_CSV   - separador ';' como na importação, com linha de
+ *                   cabeçalho e aspas nos textos que têm ';' ou aspas
+ */
+#define TAMANHO_SAIDA (1 << 20)     // Buffer das listagens (1 MB por fwrite)
+#define TAMANHO_LINHA_SAIDA 512     // Buffer de um registro avulso (cabe um registro inteiro)
+
+#define FORMATO_FICHA 0
+#define FORMATO_TSV   1
+#define FORMATO_CSV   2
+
+typedef struct
+{
+    FILE *destino;       // Arquivo que recebe os blocos
+    char *dados;         // Buffer
+    size_t usados;       // Bytes ainda não escritos
+    size_t capacidade;   // Tamanho do buffer
+    int formato;         // FORMATO_*
+    int alocado;         // 1 se o buffer foi alocado por abrirSaida
+} SaidaBuffer;
+
+/*
+ * Função: abrirSaida
+ * Objetivo: Preparar uma saída em blocos com buffer de TAMANHO_SAIDA bytes
+ * Parâmetros: s - saída a preparar
+ *             destino - arquivo que recebe os dados
+ *             formato - FORMATO_FICHA, FORMATO_TSV ou FORMATO_CSV
+ * Retorno: void
+ */
+void abrirSaida(SaidaBuffer *s, FILE *destino, int formato)
+{
+    s->destino = destino;
+    s->dados = malloc(TAMANHO_SAIDA);
+    if (!s->dados)
+    {
+        printf("Erro: memoria insuficiente para a listagem\n");
+        exit(1);
+    }
+    s->usados = 0;
+    s->capacidade = TAMANHO_SAIDA;
+    s->formato = formato;
+    s->alocado = 1;
+}
+
+/*
+ * Função: descarregarSaida
+ * Objetivo: Escrever no destino, de uma vez, o que está no buffer
+ * Parâmetros: s - saída em blocos
+ * Retorno: void
+ */
+void descarregarSaida(SaidaBuffer *s)
+{
+    if (s->usados > 0)
+        fwrite(s->dados, 1, s->usados, s->destino);
+    s->usados = 0;
+}
+
+/*
+ * Função: fecharSaida
+ * Objetivo: Descarregar o restante do buffer e liberá-lo
+ * Parâmetros: s - saída em blocos
+ * Retorno: void
+ */
+void fecharSaida(SaidaBuffer *s)
+{
+    descarregarSaida(s);
+    if (s->alocado)
+        free(s->dados);
+    s->dados = NULL;
+}
+
+/*
+ * Função: reservarSaida
+ * Objetivo: Garantir espaço contíguo no buffer, descarregando se preciso
+ * Parâmetros: s - saída em blocos
+ *             n - bytes necessários (no máximo a capacidade do buffer)
+ * Retorno: char* - posição onde escrever os n bytes
+ */
+char *reservarSaida(SaidaBuffer *s, size_t n)
+{
+    if (s->usados + n > s->capacidade)
+        descarregarSaida(s);
+    return s->dados + s->usados;
+}
+
+/*
+ * Função: saidaCaractere
+ * Objetivo: Acrescentar um caractere à saída
+ * Parâmetros: s - saída em blocos
+ *             c - caractere
+ * Retorno: void
+ */
+void saidaCaractere(SaidaBuffer *s, char c)
+{
+    *reservarSaida(s, 1) = c;
+    s->usados++;
+}
+
+/*
+ * Função: saidaTexto
+ * Objetivo: Acrescentar um texto à saída, em partes se não couber no buffer
+ * Parâmetros: s - saída em blocos
+ *             texto - texto terminado em '\0'
+ * Retorno: void
+ */
+void saidaTexto(SaidaBuffer *s, const char *texto)
+{
+    size_t n = strlen(texto);
+    while (n > 0)
+    {
+        if (s->usados == s->capacidade)
+            descarregarSaida(s);
+        size_t parte = s->capacidade - s->usados;
+        if (parte > n)
+            parte = n;
+        memcpy(s->dados + s->usados, texto, parte);
+        s->usados += parte;
+        texto += parte;
+        n -= parte;
+    }
+}
+
+/*
+ * Função: saidaInteiroLargura
+ * Objetivo: Acrescentar um inteiro em decimal, com zeros à esquerda até a
+ *           largura pedida (como %0*d)
+ * Parâmetros: s - saída em blocos
+ *             valor - número
+ *             largura - mínimo de dígitos (0 ou 1 = sem zeros à esquerda)
+ * Retorno: void
+ */
+void saidaInteiroLargura(SaidaBuffer *s, long long valor, int largura)
+{
+    char digitos[24];
+    int n = 0;
+    unsigned long long v = valor < 0 ? 0ULL - (unsigned long long)valor : (unsigned long long)valor;
+    do
+    {
+        digitos[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v > 0);
+    while (n < largura && n < 20)
+        digitos[n++] = '0';
+
+    char *p = reservarSaida(s, (size_t)n + 1);
+    int k = 0;
+    if (valor < 0)
+        p[k++] = '-';
+    while (n > 0)
+        p[k++] = digitos[--n];
+    s->usados += (size_t)k;
+}
+
+/*
+ * Função: saidaInteiro
+ * Objetivo: Acrescentar um inteiro em decimal (como %d)
+ * Parâmetros: s - saída em blocos
+ *             valor - número
+ * Retorno: void
+ */
+void saidaInteiro(SaidaBuffer *s, int valor)
+{
+    saidaInteiroLargura(s, valor, 0);
+}
+
+/*
+ * Função: saidaValor
+ * Objetivo: Acrescentar um valor com duas casas decimais (como %.2f)
+ *           Os centavos saem de conta inteira; os casos em que o
+ *           arredondamento poderia diferir do printf (meio centavo exato,
+ *           negativos, valores enormes, NaN) ficam com o próprio snprintf
+ * Parâmetros: s - saída em blocos
+ *             valor - número
+ * Retorno: void
+ */
+void saidaValor(SaidaBuffer *s, double valor)
+{
+    double centavos = valor * 100.0;
+    long long inteiro = 0;
+    double fracao = 0.5;
+    if (centavos >= 0 && centavos < 9e15 && !(centavos == 0 && 1.0 / valor < 0))
+    {
+        inteiro = (long long)centavos;
+        fracao = centavos - (double)inteiro;
+    }
+    if (fracao > 0.499999 && fracao < 0.500001)
+    {
+        char texto[512];
+        snprintf(texto, sizeof(texto), "%.2f", valor);
+        saidaTexto(s, texto);
+        return;
+    }
+    if (fracao > 0.5)
+        inteiro++;
+    saidaInteiroLargura(s, inteiro / 100, 0);
+    saidaCaractere(s, '.');
+    saidaInteiroLargura(s, inteiro % 100, 2);
+}
+
+/*
+ * Função: saidaData
+ * Objetivo: Acrescentar uma data no formato DD/MM/AAAA
+ * Parâmetros: s - saída em blocos
+ *             d - data
+ * Retorno: void
+ */
+void saidaData(SaidaBuffer *s, Data d)
+{
+    saidaInteiroLargura(s, d.dia, 2);
+    saidaCaractere(s, '/');
+    saidaInteiroLargura(s, d.mes, 2);
+    saidaCaractere(s, '/');
+    saidaInteiroLargura(s, d.ano, 4);
+}
+
+/*
+ * Função: saidaCampo
+ * Objetivo: Acrescentar um campo de texto de uma linha TSV ou CSV
+ *           No CSV, textos com ';', aspas ou quebra de linha vão entre
+ *           aspas, com as aspas internas dobradas
+ * Parâmetros: s - saída em blocos
+ *             texto - conteúdo do campo
+ * Retorno: void
+ */
+void saidaCampo(SaidaBuffer *s, const char *texto)
+{
+    if (s->formato != FORMATO_CSV || !texto[strcspn(texto, ";\"\r\n")])
+    {
+        saidaTexto(s, texto);
+        return;
+    }
+    saidaCaractere(s, '"');
+    for (const char *p = texto; *p; p++)
+    {
+        if (*p == '"')
+            saidaCaractere(s, '"');
+        saidaCaractere(s, *p);
+    }
+    saidaCaractere(s, '"');
+}
+
+/*
+ * Função: saidaSeparador
+ * Objetivo: Acrescentar o separador de campos do formato (TAB ou ';')
+ * Parâmetros: s - saída em blocos
+ * Retorno: void
+ */
+void saidaSeparador(SaidaBuffer *s)
+{
+    saidaCaractere(s, s->formato == FORMATO_CSV ? ';' : '\t');
+}
+
+/*
+ * Função: saidaCabecalho
+ * Objetivo: Escrever a linha de cabeçalho do CSV de uma entidade
+ *           (nos outros formatos não há cabeçalho)
+ * Parâmetros: s - saída em blocos
+ *             tipo - REGISTRO_CLIENTE, REGISTRO_FUNCIONARIO, REGISTRO_QUARTO
+ *                    ou REGISTRO_ESTADIA
+ * Retorno: void
+ */
+void saidaCabecalho(SaidaBuffer *s, int tipo)
+{
+    if (s->formato != FORMATO_CSV)
+        return;
+    switch (tipo)
+    {
+    case REGISTRO_CLIENTE:
+        saidaTexto(s, "codigo;nome;endereco;telefone\n");
+        break;
+    case REGISTRO_FUNCIONARIO:
+        saidaTexto(s, "codigo;nome;telefone;cargo;salario\n");
+        break;
+    case REGISTRO_QUARTO:
+        saidaTexto(s, "numero;capacidade;valorDiaria;status\n");
+        break;
+    default:
+        saidaTexto(s, "codigo;cliente;quarto;entrada;saida;diarias;status\n");
+        break;
+    }
+}
+
+/*
+ * Função: saidaCliente
+ * Objetivo: Acrescentar um cliente no formato da saída
+ * Parâmetros: s - saída em blocos
+ *             c - cliente
+ * Retorno: void
+ */
+void saidaCliente(SaidaBuffer *s, const Cliente *c)
+{
+    if (s->formato == FORMATO_FICHA)
+    {
+        saidaTexto(s, "\nCodigo: ");
+        saidaInteiro(s, c->codigoCliente);
+        saidaTexto(s, "\nNome: ");
+        saidaTexto(s, c->nome);
+        saidaTexto(s, "\nEndereco: ");
+        saidaTexto(s, c->endereco);
+        saidaTexto(s, "\nTelefone: ");
+        saidaTexto(s, c->telefone);
+        saidaTexto(s, "\n-------------------\n");
+        return;
+    }
+    saidaInteiro(s, c->codigoCliente);
+    saidaSeparador(s);
+    saidaCampo(s, c->nome);
+    saidaSeparador(s);
+    saidaCampo(s, c->endereco);
+    saidaSeparador(s);
+    saidaCampo(s, c->telefone);
+    saidaCaractere(s, '\n');
+}
+
+/*
+ * Função: saidaFuncionario
+ * Objetivo: Acrescentar um funcionário no formato da saída
+ * Parâmetros: s - saída em blocos
+ *             f - funcionário
+ * Retorno: void
+ */
+void saidaFuncionario(SaidaBuffer *s, const Funcionario *f)
+{
+    if (s->formato == FORMATO_FICHA)
+    {
+        saidaTexto(s, "\nCodigo: ");
+        saidaInteiro(s, f->codigoFuncionario);
+        saidaTexto(s, "\nNome: ");
+        saidaTexto(s, f->nome);
+        saidaTexto(s, "\nTelefone: ");
+        saidaTexto(s, f->telefone);
+        saidaTexto(s, "\nCargo: ");
+        saidaTexto(s, f->cargo);
+        saidaTexto(s, "\nSalario: R$ ");
+        saidaValor(s, f->salario);
+        saidaTexto(s, "\n-------------------\n");
+        return;
+    }
+    saidaInteiro(s, f->codigoFuncionario);
+    saidaSeparador(s);
+    saidaCampo(s, f->nome);
+    saidaSeparador(s);
+    saidaCampo(s, f->telefone);
+    saidaSeparador(s);
+    saidaCampo(s, f->cargo);
+    saidaSeparador(s);
+    saidaValor(s, f->salario);
+    saidaCaractere(s, '\n');
+}
+
+/*
+ * Função: saidaQuarto
+ * Objetivo: Acrescentar um quarto no formato da saída
+ * Parâmetros: s - saída em blocos
+ *             q - quarto
+ * Retorno: void
+ */
+void saidaQuarto(SaidaBuffer *s, const Quarto *q)
+{
+    const char *status = q->estaOcupado ? "OCUPADO" : "LIVRE";
+    if (s->formato == FORMATO_FICHA)
+    {
+        saidaTexto(s, "\nNumero: ");
+        saidaInteiro(s, q->numeroQuarto);
+        saidaTexto(s, "\nCapacidade: ");
+        saidaInteiro(s, q->capacidade);
+        saidaTexto(s, " hospedes\nValor da diaria: R$ ");
+        saidaValor(s, q->valorDiaria);
+        saidaTexto(s, "\nStatus: ");
+        saidaTexto(s, status);
+        saidaTexto(s, "\n-------------------\n");
+        return;
+    }
+    saidaInteiro(s, q->numeroQuarto);
+    saidaSeparador(s);
+    saidaInteiro(s, q->capacidade);
+    saidaSeparador(s);
+    saidaValor(s, q->valorDiaria);
+    saidaSeparador(s);
+    saidaTexto(s, status);
+    saidaCaractere(s, '\n');
+}
+
+/*
+ * Função: saidaEstadia
+ * Objetivo: Acrescentar uma estadia no formato da saída
+ * Parâmetros: s - saída em blocos
+ *             e - estadia
+ * Retorno: void
+ */
+void saidaEstadia(SaidaBuffer *s, const Estadia *e)
+{
+    const char *status = e->estadiaAtiva ? "ATIVA" : "FINALIZADA";
+    if (s->formato == FORMATO_FICHA)
+    {
+        saidaTexto(s, "\nCodigo da estadia: ");
+        saidaInteiro(s, e->codigoEstadia);
+        saidaTexto(s, "\nCodigo do cliente: ");
+        saidaInteiro(s, e->codigoCliente);
+        saidaTexto(s, "\nNumero do quarto: ");
+        saidaInteiro(s, e->numeroQuarto);
+        saidaTexto(s, "\nData de entrada: ");
+        saidaData(s, e->dataEntrada);
+        saidaTexto(s, "\nData de saida: ");
+        saidaData(s, e->dataSaida);
+        saidaTexto(s, "\nQuantidade de diarias: ");
+        saidaInteiro(s, e->quantidadeDiarias);
+        saidaTexto(s, "\nStatus: ");
+        saidaTexto(s, status);
+        saidaTexto(s, "\n-------------------\n");
+        return;
+    }
+    saidaInteiro(s, e->codigoEstadia);
+    saidaSeparador(s);
+    saidaInteiro(s, e->codigoCliente);
+    saidaSeparador(s);
+    saidaInteiro(s, e->numeroQuarto);
+    saidaSeparador(s);
+    saidaData(s, e->dataEntrada);
+    saidaSeparador(s);
+    saidaData(s, e->dataSaida);
+    saidaSeparador(s);
+    saidaInteiro(s, e->quantidadeDiarias);
+    saidaSeparador(s);
+    saidaTexto(s, status);
+    saidaCaractere(s, '\n');
+}
+
+/*
+ * Função: listarRegistros
+ * Objetivo: Escrever todos os registros de uma entidade em blocos
+ *           (estadias lidas por uma visão, sem segurar travaDados)
+ * Parâmetros: destino - arquivo que recebe a listagem
+ *             entidade - "clientes", "funcionarios", "quartos" ou "estadias"
+ *             formato - FORMATO_TSV ou FORMATO_CSV
+ * Retorno: int - quantidade de registros escritos, ou -1 se a entidade
+ *          não existe
+ */
+int listarRegistros(FILE *destino, const char *entidade, int formato)
+{
+    int tipo;
+    if (strcmp(entidade, "clientes") == 0)
+        tipo = REGISTRO_CLIENTE;
+    else if (strcmp(entidade, "funcionarios") == 0)
+        tipo = REGISTRO_FUNCIONARIO;
+    else if (strcmp(entidade, "quartos") == 0)
+        tipo = REGISTRO_QUARTO;
+    else if (strcmp(entidade, "estadias") == 0)
+        tipo = REGISTRO_ESTADIA;
+    else
+        return -1;
+
+    SaidaBuffer s;
+    abrirSaida(&s, destino, formato);
+    saidaCabecalho(&s, tipo);
+
+    int total = 0;
+    switch (tipo)
+    {
+    case REGISTRO_CLIENTE:
+        for (; total < totalClientes; total++)
+            saidaCliente(&s, &tabelaClientes[total]);
+        break;
+    case REGISTRO_FUNCIONARIO:
+        for (; total < totalFuncionarios; total++)
+            saidaFuncionario(&s, &tabelaFuncionarios[total]);
+        break;
+    case REGISTRO_QUARTO:
+    {
+        int hoje = diaSerialHoje();
+        for (; total < totalQuartos; total++)
+        {
+            Quarto q = quartoNoDia(total, hoje);
+            saidaQuarto(&s, &q);
+        }
+        break;
+    }
+    default:
+    {
+        VisaoEstadias visao;
+        abrirVisao(&visao);
+        for (; total < visao.totalEstadias; total++)
+        {
+            Estadia e = estadiaNaVisao(&visao, total);
+            saidaEstadia(&s, &e);
+        }
+        fecharVisao(&visao);
+        break;
+    }
+    }
+    fecharSaida(&s);
+    return total;
+}
+
+// ============================================================
+// FUNÇÕES PARA MOSTRAR DADOS (LISTAGENS)
+// ============================================================
+
+/*
+ * Função: mostrarClientes
+ * Objetivo: Listar todos os clientes cadastrados no sistema
+ *           Inclui contador total
+ * Parâmetros: Nenhum
+ * Retorno: void
+ */
+void mostrarClientes()
+{
+    if (totalClientes == 0)
+    {
+        printf("Nenhum cliente cadastrado.\n");
+        printf("\nPressione ENTER para voltar ao menu...");
+        getchar();
+        return;
+    }
+
+    int count = 0;  // Contador de clientes
+
+    printf("\n=== LISTA DE CLIENTES ===\n");
+    printf("========================================\n");
+    
+    // Exibe cada cliente da tabela (em blocos, sem um printf por campo)
+    SaidaBuffer saida;
+    abrirSaida(&saida, stdout, FORMATO_FICHA);
+    for (int i = 0; i < totalClientes; i++)
+    {
+        saidaCliente(&saida, &tabelaClientes[i]);
+        count++;
+    }
+    fecharSaida(&saida);
+    
+    printf("Total de clientes: %d\n", count);
+    printf("\nPressione ENTER para voltar ao menu...");
+    limparEntrada();
+    getchar();
+}
+
+/*
+ * Função: mostrarFuncionarios
+ * Objetivo: Listar todos os funcionários cadastrados
+ * Parâmetros: Nenhum
+ * Retorno: void
+ */
+void mostrarFuncionarios()
+{
+    if (totalFuncionarios == 0)
+    {
+        printf("Nenhum funcionario cadastrado.\n");
+        printf("\nPressione ENTER para voltar ao menu...");
+        getchar();
+        return;
+    }
+
+    int count = 0;
+
+    printf("\n=== LISTA DE FUNCIONaRIOS ===\n");
+    printf("========================================\n");
+    SaidaBuffer saida;
+    abrirSaida(&saida, stdout, FORMATO_FICHA);
+    for (int i = 0; i < totalFuncionarios; i++)
+    {
+        saidaFuncionario(&saida, &tabelaFuncionarios[i]);
+        count++;
+    }
+    fecharSaida(&saida);
+    
+    printf("Total de funcionarios: %d\n", count);
+    printf("\nPressione ENTER para voltar ao menu...");
+    limparEntrada();
+    getchar();
+}
+
+/*
+ * Função: mostrarQuartos
+ * Objetivo: Listar todos os quartos com status de ocupação
+ *           Inclui estatísticas: total, ocupados e livres
+ * Parâmetros: Nenhum
+ * Retorno: void
+ */
+void mostrarQuartos()
+{
+    if (totalQuartos == 0)
+    {
+        printf("Nenhum quarto cadastrado.\n");
+        printf("\nPressione ENTER para voltar ao menu...");
+        getchar();
+        return;
+    }
+
+    int count = 0;      // Total de quartos
+    int ocupados = 0;   // Quartos ocupados
+    int livres = 0;     // Quartos livres
+
+    printf("\n=== LISTA DE QUARTOS ===\n");
+    printf("========================================\n");
+    SaidaBuffer saida;
+    abrirSaida(&saida, stdout, FORMATO_FICHA);
+    int hoje = diaSerialHoje();  // Status do dia: reservas futuras não ocupam
+    for (int i = 0; i < totalQuartos; i++)
+    {
+        Quarto q = quartoNoDia(i, hoje);
+        saidaQuarto(&saida, &q);
+        
+        count++;
+        if (q.estaOcupado)
+            ocupados++;
+        else
+            livres++;
+    }
+    fecharSaida(&saida);
+    
+    // Mostra estatísticas
+    printf("RESUMO:\n");
+    printf("Total de quartos: %d\n", count);
+    printf("Quartos ocupados: %d\n", ocupados);
+    printf("Quartos livres: %d\n", livres);
+    printf("\nPressione ENTER para voltar ao menu...");
+    limparEntrada();
+    getchar();
+}
+
+/*
+ * Função: mostrarEstadias
+ * Objetivo: Listar todas as estadias registradas
+ *           Inclui status (ativa/finalizada) e estatísticas
+ * Parâmetros: Nenhum
+ * Retorno: void
+ */
+void mostrarEstadias()
+{
+    if (totalEstadias == 0)
+    {
+        printf("Nenhuma estadia registrada.\n");
+        printf("\nPressione ENTER para voltar ao menu...");
+        getchar();
+        return;
+    }
+
+    int count = 0;          // Total de estadias
+    int ativas = 0;         // Estadias ativas
+    int finalizadas = 0;    // Estadias finalizadas
+
+    printf("\n=== LISTA DE ESTADIAS ===\n");
+    printf("========================================\n");
+    VisaoEstadias visao;  // Lista e resumo do mesmo momento
+    abrirVisao(&visao);
+    SaidaBuffer saida;
+    abrirSaida(&saida, stdout, FORMATO_FICHA);
+    for (int i = 0; i < visao.totalEstadias; i++)
+    {
+        Estadia e = estadiaNaVisao(&visao, i);
+        saidaEstadia(&saida, &e);
+        
+        count++;
+        if (e.estadiaAtiva)
+            ativas++;
+        else
+            finalizadas++;
+    }
+    fecharSaida(&saida);
+    fecharVisao(&visao);
+    
+    // Mostra estatísticas
+    printf("RESUMO:\n");
+    printf("Total de estadias: %d\n", count);
+    printf("Estadias ativas: %d\n", ativas);
+    printf("Estadias finalizadas: %d\n", finalizadas);
+    printf("\nPressione ENTER para voltar ao menu...");
+    limparEntrada();
+    getchar();
+}
+
+// ============================================================
+// RELATÓRIO DE OCUPAÇÃO E RECEITA (PROCESSAMENTO PARALELO)
+// ============================================================
+
+/*
+ * Para um período [inicio, fim], soma as diárias ocupadas (quarto-noites)
+ * e a receita de cada dia, mês ou quarto, juntando cada estadia ao
+ * valorDiaria do seu quarto. Dela saem a taxa de ocupação (noites
+ * ocupadas / noites disponíveis), a diária média (ADR = receita / noites)
+ * e a receita. Estadias ativas e finalizadas contam igualmente.
+ *
+ * As estadias são divididas em blocos de BLOCO_RELATORIO posições,
+ * distribuídos sob demanda entre as threads de trabalho. Cada thread soma
+ * nos seus próprios vetores parciais, sem travas, e ao fim as parciais são
+ * somadas. As threads só leem a visão aberta no início do cálculo, que
+ * não muda com check-ins e check-outs feitos enquanto o relatório roda.
+ */
+#define AGRUPAR_DIA    0
+#define AGRUPAR_MES    1
+#define AGRUPAR_QUARTO 2
+
+#define BLOCO_RELATORIO 65536   // Estadias por bloco de trabalho
+#define MAX_THREADS 64
+
+typedef struct
+{
+    int agrupamento;          // AGRUPAR_DIA, AGRUPAR_MES ou AGRUPAR_QUARTO
+    int inicio;               // Primeiro dia do período (serial)
+    int fim;                  // Dia seguinte ao último do período (serial)
+    VisaoEstadias visao;      // Estadias e quartos no início do cálculo
+    int totalEstadias;        // Estadias consideradas (visao.totalEstadias)
+    int grupos;               // Quantidade de linhas do relatório
+    int *grupoDoDia;          // dia - inicio -> grupo (dia e mês)
+    int *inicioGrupo;         // Primeiro dia serial de cada grupo (dia e mês)
+    double *valorQuarto;      // valorDiaria por posição do quarto
+    long long *noites;        // Quarto-noites ocupadas por grupo
+    long long *disponiveis;   // Quarto-noites disponíveis por grupo
+    double *receita;          // Receita por grupo
+    int proximoBloco;         // Próximo bloco a ser entregue a uma thread
+    pthread_mutex_t travaBlocos;  // Protege proximoBloco
+} Relatorio;
+
+typedef struct
+{
+    Relatorio *relatorio;     // Relatório em cálculo (só proximoBloco muda)
+    long long *noites;        // Parcial da thread
+    double *receita;          // Parcial da thread
+} ParcialRelatorio;
+
+/*
+ * Função: threadsRelatorio
+ * Objetivo: Decidir quantas threads de trabalho usar
+ *           HOTEL_THREADS define a quantidade; o padrão é uma por processador
+ * Parâmetros: blocos - quantidade de blocos a processar
+ * Retorno: int - quantidade de threads (de 1 a MAX_THREADS)
+ */
+int threadsRelatorio(int blocos)
+{
+    const char *valor = getenv("HOTEL_THREADS");
+    int threads = valor && atoi(valor) > 0 ? atoi(valor) : processadoresDisponiveis();
+    if (threads > MAX_THREADS)
+        threads = MAX_THREADS;
+    if (threads > blocos)
+        threads = blocos;
+    return threads > 0 ? threads : 1;
+}
+
+/*
+ * Função: trabalhadorRelatorio
+ * Objetivo: Corpo de uma thread: pega blocos de estadias até acabarem e
+ *           soma as noites de cada estadia dentro do período nos parciais
+ * Parâmetros: argumento - ParcialRelatorio da thread
+ * Retorno: void* - NULL
+ */
+void *trabalhadorRelatorio(void *argumento)
+{
+    ParcialRelatorio *parcial = argumento;
+    Relatorio *r = parcial->relatorio;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&r->travaBlocos);
+        int bloco = r->proximoBloco++;
+        pthread_mutex_unlock(&r->travaBlocos);
+
+        int primeira = bloco * BLOCO_RELATORIO;
+        if (primeira >= r->totalEstadias)
+            break;
+        int ultima = primeira + BLOCO_RELATORIO < r->totalEstadias ? primeira + BLOCO_RELATORIO
+                                                                   : r->totalEstadias;
+
+        for (int i = primeira; i < ultima; i++)
+        {
+            // Interseção da estadia [entrada, saida) com o período
+            int de = r->visao.diaEntrada[i] > r->inicio ? r->visao.diaEntrada[i] : r->inicio;
+            int ate = r->visao.diaSaida[i] < r->fim ? r->visao.diaSaida[i] : r->fim;
+            if (de >= ate)
+                continue;
+            int quarto = r->visao.posicaoQuarto[i];
+            if (quarto < 0)
+                continue;
+            double valor = r->valorQuarto[quarto];
+
+            if (r->agrupamento == AGRUPAR_QUARTO)
+            {
+                parcial->noites[quarto] += ate - de;
+                parcial->receita[quarto] += (ate - de) * valor;
+            }
+            else
+                for (int dia = de; dia < ate; dia++)
+                {
+                    int grupo = r->grupoDoDia[dia - r->inicio];
+                    parcial->noites[grupo]++;
+                    parcial->receita[grupo] += valor;
+                }
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Função: liberarRelatorio
+ * Objetivo: Liberar os vetores de um relatório e fechar sua visão
+ * Parâmetros: r - relatório
+ * Retorno: void
+ */
+void liberarRelatorio(Relatorio *r)
+{
+    if (r->visao.quartos)
+        fecharVisao(&r->visao);
+    free(r->grupoDoDia);
+    free(r->inicioGrupo);
+    free(r->valorQuarto);
+    free(r->noites);
+    free(r->disponiveis);
+    free(r->receita);
+}
+
+/*
+ * Função: calcularRelatorio
+ * Objetivo: Calcular o relatório de ocupação e receita de um período
+ * Parâmetros: r - relatório a preencher
+ *             agrupamento - AGRUPAR_DIA, AGRUPAR_MES ou AGRUPAR_QUARTO
+ *             inicio, fim - primeiro e último dia do período (inclusive)
+ * Retorno: int - 1 se calculou, 0 se o período é inválido
+ */
+int calcularRelatorio(Relatorio *r, int agrupamento, Data inicio, Data fim)
+{
+    memset(r, 0, sizeof(Relatorio));
+    if (!validarData(inicio) || !validarData(fim) || diaSerial(fim) < diaSerial(inicio))
+        return 0;
+
+    r->agrupamento = agrupamento;
+    r->inicio = diaSerial(inicio);
+    r->fim = diaSerial(fim) + 1;
+    abrirVisao(&r->visao);
+    r->totalEstadias = r->visao.totalEstadias;
+    int quartos = r->visao.totalQuartos;
+    int dias = r->fim - r->inicio;
+
+    // Grupos de cada dia do período (dia e mês) e noites disponíveis
+    r->grupoDoDia = malloc((size_t)dias * sizeof(int));
+    r->inicioGrupo = malloc((size_t)dias * sizeof(int));
+    r->valorQuarto = malloc((size_t)(quartos > 0 ? quartos : 1) * sizeof(double));
+    int maxGrupos = agrupamento == AGRUPAR_QUARTO ? (quartos > 0 ? quartos : 1) : dias;
+    r->noites = calloc((size_t)maxGrupos, sizeof(long long));
+    r->disponiveis = calloc((size_t)maxGrupos, sizeof(long long));
+    r->receita = calloc((size_t)maxGrupos, sizeof(double));
+    if (!r->grupoDoDia || !r->inicioGrupo || !r->valorQuarto || !r->noites || !r->disponiveis || !r->receita)
+    {
+        printf("Erro: memoria insuficiente.\n");
+        exit(1);
+    }
+
+    for (int i = 0; i < quartos; i++)
+        r->valorQuarto[i] = r->visao.quartos[i].valorDiaria;
+
+    if (agrupamento == AGRUPAR_QUARTO)
+    {
+        r->grupos = quartos;
+        for (int i = 0; i < quartos; i++)
+            r->disponiveis[i] = dias;
+    }
+    else
+    {
+        int mesAnterior = 0;
+        for (int d = 0; d < dias; d++)
+        {
+            Data data = dataDoDiaSerial(r->inicio + d);
+            int mes = data.ano * 12 + data.mes;
+            if (d == 0 || agrupamento == AGRUPAR_DIA || mes != mesAnterior)
+                r->inicioGrupo[r->grupos++] = r->inicio + d;
+            mesAnterior = mes;
+            r->grupoDoDia[d] = r->grupos - 1;
+            r->disponiveis[r->grupos - 1] += quartos;
+        }
     }
-    // Busca por nome
-    else if (opcao == 2)
+
+    // Distribui os blocos entre as threads; cada uma soma nos seus parciais
+    int blocos = (r->totalEstadias + BLOCO_RELATORIO - 1) / BLOCO_RELATORIO;
+    int threads = threadsRelatorio(blocos);
+    pthread_t ids[MAX_THREADS];
+    ParcialRelatorio parciais[MAX_THREADS];
+    r->proximoBloco = 0;
+    pthread_mutex_init(&r->travaBlocos, NULL);
+
+    for (int t = 0; t < threads; t++)
     {
-        char nomeBusca[50];
-        printf("Digite o nome (ou parte do nome) do cliente: ");
-        fgets(nomeBusca, 50, stdin);
-        nomeBusca[strcspn(nomeBusca, "\n")] = 0;
-        
-        // Buscar cliente pelo nome no arquivo
-        FILE *arquivoClientes = fopen(ARQ_CLIENTES, "rb");
-        if (!arquivoClientes)
+        parciais[t].relatorio = r;
+        parciais[t].noites = calloc((size_t)maxGrupos, sizeof(long long));
+        parciais[t].receita = calloc((size_t)maxGrupos, sizeof(double));
+        if (!parciais[t].noites || !parciais[t].receita)
         {
-            printf("Nenhum cliente cadastrado.\n");
-            printf("\nPressione ENTER para voltar ao menu...");
-            getchar();
-            return;
+            printf("Erro: memoria insuficiente.\n");
+            exit(1);
         }
-        
-        Cliente c;
-        int encontrados = 0;
-        printf("\n=== CLIENTES ENCONTRADOS ===\n");
-        
-        // Lista todos os clientes que correspondem à busca
-        while (fread(&c, sizeof(Cliente), 1, arquivoClientes))
+    }
+    // A thread principal também trabalha (parcial 0)
+    int criadas = 1;
+    for (; criadas < threads; criadas++)
+        if (pthread_create(&ids[criadas], NULL, trabalhadorRelatorio, &parciais[criadas]) != 0)
+            break;  // Segue com as threads que conseguiu criar
+    trabalhadorRelatorio(&parciais[0]);
+    for (int t = 1; t < criadas; t++)
+        pthread_join(ids[t], NULL);
+    pthread_mutex_destroy(&r->travaBlocos);
+
+    // Soma os parciais na ordem das threads (resultado reproduzível)
+    for (int t = 0; t < threads; t++)
+    {
+        for (int g = 0; g < r->grupos; g++)
+        {
+            r->noites[g] += parciais[t].noites[g];
+            r->receita[g] += parciais[t].receita[g];
+        }
+        free(parciais[t].noites);
+        free(parciais[t].receita);
+    }
+    return 1;
+}
+
+/*
+ * Função: escreverRelatorio
+ * Objetivo: Escrever as linhas do relatório e a linha de total
+ * Parâmetros: saida - destino
+ *             r - relatório calculado
+ *             tabela - 1 para colunas alinhadas (menu), 0 para TAB (modo lote)
+ * Retorno: void
+ */
+void escreverRelatorio(FILE *saida, const Relatorio *r, int tabela)
+{
+    const char *formato = tabela ? "%-12s %12lld %12lld %9.1f%% %12.2f %16.2f\n"
+                                 : "%s\t%lld\t%lld\t%.1f\t%.2f\t%.2f\n";
+    long long totalNoites = 0, totalDisponiveis = 0;
+    double totalReceita = 0.0;
+    char rotulo[16];
+
+    if (tabela)
+        fprintf(saida, "%-12s %12s %12s %10s %12s %16s\n",
+                "Periodo", "Noites", "Disponiveis", "Ocupacao", "ADR (R$)", "Receita (R$)");
+    for (int g = 0; g < r->grupos; g++)
+    {
+        if (r->agrupamento == AGRUPAR_QUARTO)
+            snprintf(rotulo, sizeof(rotulo), "%d", r->visao.quartos[g].numeroQuarto);
+        else
+        {
+            Data d = dataDoDiaSerial(r->inicioGrupo[g]);
+            if (r->agrupamento == AGRUPAR_DIA)
+                snprintf(rotulo, sizeof(rotulo), "%02d/%02d/%04d", d.dia, d.mes, d.ano);
+            else
+                snprintf(rotulo, sizeof(rotulo), "%02d/%04d", d.mes, d.ano);
+        }
+        fprintf(saida, formato, rotulo, r->noites[g], r->disponiveis[g],
+                r->disponiveis[g] > 0 ? 100.0 * r->noites[g] / r->disponiveis[g] : 0.0,
+                r->noites[g] > 0 ? r->receita[g] / r->noites[g] : 0.0, r->receita[g]);
+        totalNoites += r->noites[g];
+        totalDisponiveis += r->disponiveis[g];
+        totalReceita += r->receita[g];
+    }
+    fprintf(saida, formato, "total", totalNoites, totalDisponiveis,
+            totalDisponiveis > 0 ? 100.0 * totalNoites / totalDisponiveis : 0.0,
+            totalNoites > 0 ? totalReceita / totalNoites : 0.0, totalReceita);
+}
+
+/*
+ * Função: relatorioOcupacao
+ * Objetivo: Opção do menu: pedir agrupamento e período e mostrar o relatório
+ * Parâmetros: -
+ * Retorno: void
+ */
+void relatorioOcupacao()
+{
+    int opcao;
+    printf("\n=== RELATORIO DE OCUPACAO E RECEITA ===\n");
+    printf("1 - Por dia\n");
+    printf("2 - Por mes\n");
+    printf("3 - Por quarto\n");
+    printf("Opcao: ");
+    scanf("%d", &opcao);
+    limparEntrada();
+
+    if (opcao < 1 || opcao > 3)
+    {
+        printf("Opcao invalida!\n");
+        return;
+    }
+
+    Data inicio, fim;
+    if (!lerData("Primeiro dia do periodo", &inicio) || !lerData("Ultimo dia do periodo", &fim))
+        return;
+
+    Relatorio r;
+    long long comeco = agoraMs();
+    if (!calcularRelatorio(&r, opcao - 1, inicio, fim))
+        printf("Periodo invalido! O ultimo dia deve ser igual ou posterior ao primeiro.\n");
+    else
+    {
+        printf("\n");
+        escreverRelatorio(stdout, &r, 1);
+        printf("\n(%d estadias analisadas em %lld ms)\n", r.totalEstadias, agoraMs() - comeco);
+    }
+    liberarRelatorio(&r);
+
+    printf("\nPressione ENTER para voltar ao menu...");
+    limparEntrada();
+    getchar();
+}
+
+// ============================================================
+// IMPORTAÇÃO EM LOTE (ARQUIVOS CSV)
+// ============================================================
+
+/*
+ * Carga não interativa de dados a partir de arquivos CSV separados por ';'
+ * (a primeira linha é o cabeçalho e é ignorada):
+ *   clientes:     nome;endereco;telefone
+ *   funcionarios: nome;telefone;cargo;salario
+ *   quartos:      numero;capacidade;valorDiaria
+ *   estadias:     codigoCliente;numeroQuarto;DD/MM/AAAA;DD/MM/AAAA[;ativa]
+ * Os códigos são atribuídos pelos contadores em uma única passada e os
+ * registros são gravados com um buffer grande, sincronizado uma vez no fim.
+ * Linhas inválidas são informadas e ignoradas.
+ */
+#define TAMANHO_BUFFER_IMPORTACAO (1 << 20)  // 1 MB de buffer de leitura
+#define MAX_CAMPOS_CSV 8
+#define TAMANHO_LINHA_CSV 512  // Linha mais longa aceita, com o \n e o \0
+
+/*
+ * Função: dividirCampos
+ * Objetivo: Separar uma linha CSV em campos (altera a linha, sem cópias)
+ *           Um campo entre aspas pode conter ';' e quebras de linha, com as
+ *           aspas internas dobradas, como a exportação em CSV grava
+ * Parâmetros: linha - linha lida do arquivo (o \n final é removido)
+ *             campos - vetor que recebe o início de cada campo
+ *             maximo - tamanho do vetor de campos
+ * Retorno: int - quantidade de campos encontrados
+ */
+int dividirCampos(char *linha, char *campos[], int maximo)
+{
+    size_t tamanho = strlen(linha);
+    while (tamanho > 0 && (linha[tamanho - 1] == '\n' || linha[tamanho - 1] == '\r'))
+        linha[--tamanho] = 0;  // Remove fim de linha (Windows ou Unix)
+
+    int total = 0;
+    char *leitura = linha;
+    while (total < maximo)
+    {
+        char *escrita = leitura;  // O campo sem as aspas nunca é maior que o original
+        campos[total++] = escrita;
+        if (*leitura == '"')
+        {
+            for (leitura++; *leitura; leitura++)
+            {
+                if (*leitura == '"' && *++leitura != '"')
+                    break;  // Aspas de fechamento
+                *escrita++ = *leitura;
+            }
+        }
+        while (*leitura && *leitura != ';')
+            *escrita++ = *leitura++;
+
+        int fim = *leitura == 0;
+        *escrita = 0;
+        if (fim)
+            break;
+        leitura++;
+    }
+    return total;
+}
+
+/*
+ * Função: copiarTexto
+ * Objetivo: Copiar texto para um campo de tamanho fixo, sempre terminado em \0
+ * Parâmetros: destino - campo de destino
+ *             origem - texto de origem
+ *             tamanho - tamanho do campo de destino
+ * Retorno: void
+ */
+void copiarTexto(char *destino, const char *origem, size_t tamanho)
+{
+    size_t n = strlen(origem);
+    if (n >= tamanho)
+        n = tamanho - 1;  // Trunca como o fgets do cadastro interativo
+    memcpy(destino, origem, n);
+    memset(destino + n, 0, tamanho - n);  // Zera o restante do campo
+}
+
+/*
+ * Função: lerDecimal
+ * Objetivo: Converter texto em número decimal aceitando vírgula ou ponto
+ * Parâmetros: texto - campo CSV (a vírgula é trocada por ponto no lugar)
+ *             valor - ponteiro para o resultado
+ * Retorno: int - 1 se o campo é um número válido, 0 caso contrário
+ */
+int lerDecimal(char *texto, double *valor)
+{
+    char *virgula = strchr(texto, ',');
+    if (virgula)
+        *virgula = '.';
+
+    char *fim;
+    *valor = strtod(texto, &fim);
+    return fim != texto && *fim == 0;
+}
+
+/*
+ * Função: lerDataCSV
+ * Objetivo: Converter um campo DD/MM/AAAA em Data e validá-la
+ * Parâmetros: texto - campo CSV
+ *             data - ponteiro para o resultado
+ * Retorno: int - 1 se a data é válida, 0 caso contrário
+ */
+int lerDataCSV(const char *texto, Data *data)
+{
+    char *fim;
+    data->dia = (int)strtol(texto, &fim, 10);
+    if (*fim != '/')
+        return 0;
+    data->mes = (int)strtol(fim + 1, &fim, 10);
+    if (*fim != '/')
+        return 0;
+    data->ano = (int)strtol(fim + 1, &fim, 10);
+    return *fim == 0 && validarData(*data);
+}
+
+/*
+ * Função: montarRegistro
+ * Objetivo: Validar campos de texto e montar o registro correspondente
+ *           (sem código e sem inseri-lo); usada pela importação e pelo modo lote
+ * Parâmetros: tipo - OP_CLIENTE, OP_FUNCIONARIO, OP_QUARTO ou OP_ESTADIA
+ *             campos - campos da linha
+ *             total - quantidade de campos
+ *             registro - área que recebe o registro montado
+ * Retorno: const char* - NULL se aceito, ou o motivo da rejeição
+ */
+const char *montarRegistro(int tipo, char *campos[], int total, void *registro)
+{
+    double valor;
+
+    if (tipo == OP_CLIENTE)
+    {
+        if (total < 3 || campos[0][0] == 0)
+            return "esperado nome;endereco;telefone";
+        Cliente *c = registro;
+        copiarTexto(c->nome, campos[0], sizeof(c->nome));
+        copiarTexto(c->endereco, campos[1], sizeof(c->endereco));
+        copiarTexto(c->telefone, campos[2], sizeof(c->telefone));
+        c->codigoCliente = 0;
+    }
+    else if (tipo == OP_FUNCIONARIO)
+    {
+        if (total < 4 || campos[0][0] == 0)
+            return "esperado nome;telefone;cargo;salario";
+        if (!lerDecimal(campos[3], &valor) || valor < 0)
+            return "salario invalido";
+        Funcionario *f = registro;
+        memset(f, 0, sizeof(Funcionario));
+        copiarTexto(f->nome, campos[0], sizeof(f->nome));
+        copiarTexto(f->telefone, campos[1], sizeof(f->telefone));
+        copiarTexto(f->cargo, campos[2], sizeof(f->cargo));
+        f->salario = valor;
+    }
+    else if (tipo == OP_QUARTO)
+    {
+        if (total < 3)
+            return "esperado numero;capacidade;valorDiaria";
+        Quarto *q = registro;
+        memset(q, 0, sizeof(Quarto));
+        q->numeroQuarto = atoi(campos[0]);
+        q->capacidade = atoi(campos[1]);
+        if (q->numeroQuarto <= 0)
+            return "numero do quarto invalido";
+        if (mapaQuartosBuscar(q->numeroQuarto) >= 0)
+            return "ja existe um quarto com esse numero";
+        if (q->capacidade <= 0)
+            return "capacidade invalida";
+        if (!lerDecimal(campos[2], &valor) || valor <= 0)
+            return "valor da diaria invalido";
+        q->valorDiaria = valor;
+        q->estaOcupado = 0;
+    }
+    else  // OP_ESTADIA
+    {
+        if (total < 4)
+            return "esperado codigoCliente;numeroQuarto;entrada;saida[;ativa]";
+        Estadia *e = registro;
+        memset(e, 0, sizeof(Estadia));
+        e->codigoCliente = atoi(campos[0]);
+        e->numeroQuarto = atoi(campos[1]);
+        if (indiceBuscar(&indiceClientes, e->codigoCliente) < 0)
+            return "cliente nao encontrado";
+        int posicaoQuarto = mapaQuartosBuscar(e->numeroQuarto);
+        if (posicaoQuarto < 0)
+            return "quarto nao encontrado";
+        if (!lerDataCSV(campos[2], &e->dataEntrada) || !lerDataCSV(campos[3], &e->dataSaida))
+            return "data invalida";
+        e->quantidadeDiarias = diasEntreDatas(e->dataEntrada, e->dataSaida);
+        if (e->quantidadeDiarias <= 0)
+            return "saida deve ser posterior a entrada";
+        e->estadiaAtiva = total >= 5 && atoi(campos[4]) == 1;
+        if (e->estadiaAtiva &&
+            !quartoLivreNoPeriodo(posicaoQuarto, diaSerial(e->dataEntrada), diaSerial(e->dataSaida)))
+            return "quarto ja reservado no periodo";
+    }
+    return NULL;
+}
+
+/*
+ * Função: importarRegistro
+ * Objetivo: Atribuir código a um registro montado e inseri-lo na tabela
+ *           (os contadores são gravados uma única vez ao fim da importação)
+ * Parâmetros: tipo - tipo do registro (OP_*)
+ *             registro - registro montado por montarRegistro
+ * Retorno: void
+ */
+void importarRegistro(int tipo, void *registro)
+{
+    if (tipo == OP_CLIENTE)
+    {
+        Cliente *c = registro;
+        c->codigoCliente = sequencias.proximoCliente++;
+        inserirClienteTabela(*c);
+    }
+    else if (tipo == OP_FUNCIONARIO)
+    {
+        Funcionario *f = registro;
+        f->codigoFuncionario = sequencias.proximoFuncionario++;
+        inserirFuncionarioTabela(*f);
+    }
+    else if (tipo == OP_QUARTO)
+    {
+        inserirQuartoTabela(*(Quarto *)registro);
+    }
+    else
+    {
+        Estadia *e = registro;
+        e->codigoEstadia = sequencias.proximoEstadia++;
+        inserirEstadiaTabela(*e);
+    }
+}
+
+/*
+ * Função: lerLinhaCSV
+ * Objetivo: Ler uma linha do CSV; se um campo entre aspas tem quebras de
+ *           linha, continua nas linhas seguintes até fechar as aspas
+ *           Uma linha que não cabe é descartada até o fim, para não virar
+ *           dois registros
+ * Parâmetros: entrada - arquivo CSV
+ *             linha - destino
+ *             tamanho - tamanho do destino
+ *             numeroLinha - contador de linhas do arquivo (atualizado)
+ * Retorno: int - 1 se leu, 0 no fim do arquivo, -1 se a linha não coube
+ */
+int lerLinhaCSV(FILE *entrada, char *linha, int tamanho, int *numeroLinha)
+{
+    int usados = 0, entreAspas = 0, coube = 1;
+    while (fgets(linha + usados, tamanho - usados, entrada))
+    {
+        int n = (int)strlen(linha + usados);
+        for (int i = usados; i < usados + n; i++)
+            if (linha[i] == '"')
+                entreAspas = !entreAspas;  // Aspas dobradas trocam duas vezes
+        usados += n;
+
+        if (n == 0 || (linha[usados - 1] != '\n' && !feof(entrada)))
+        {
+            coube = 0;
+            break;
+        }
+        (*numeroLinha)++;
+        if (!entreAspas || feof(entrada))
+            return 1;
+    }
+    if (coube)
+        return usados > 0;  // Fim do arquivo (com aspas abertas, vale o que veio)
+
+    int c;
+    while ((c = fgetc(entrada)) != EOF)
+    {
+        if (c == '"')
+            entreAspas = !entreAspas;
+        else if (c == '\n')
+        {
+            (*numeroLinha)++;
+            if (!entreAspas)
+                break;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Função: importarCSV
+ * Objetivo: Importar um arquivo CSV inteiro para o arquivo binário da entidade
+ * Parâmetros: entidade - "clientes", "funcionarios", "quartos" ou "estadias"
+ *             caminho - caminho do arquivo CSV
+ * Retorno: int - 0 se a importação foi feita, 1 em caso de erro
+ */
+int importarCSV(const char *entidade, const char *caminho)
+{
+    int tipo;
+    const char *destino;
+    int tipoRegistro;
+
+    if (strcmp(entidade, "clientes") == 0)
+    {
+        tipo = OP_CLIENTE; destino = ARQ_CLIENTES; tipoRegistro = REGISTRO_CLIENTE;
+    }
+    else if (strcmp(entidade, "funcionarios") == 0)
+    {
+        tipo = OP_FUNCIONARIO; destino = ARQ_FUNCIONARIOS; tipoRegistro = REGISTRO_FUNCIONARIO;
+    }
+    else if (strcmp(entidade, "quartos") == 0)
+    {
+        tipo = OP_QUARTO; destino = ARQ_QUARTOS; tipoRegistro = REGISTRO_QUARTO;
+    }
+    else if (strcmp(entidade, "estadias") == 0)
+    {
+        tipo = OP_ESTADIA; destino = ARQ_ESTADIAS; tipoRegistro = REGISTRO_ESTADIA;
+    }
+    else
+    {
+        printf("Entidade invalida: %s (use clientes, funcionarios, quartos ou estadias)\n", entidade);
+        return 1;
+    }
+
+    FILE *entrada = fopen(caminho, "r");
+    if (!entrada)
+    {
+        printf("Nao foi possivel abrir %s\n", caminho);
+        return 1;
+    }
+
+    // A carga grava direto nos arquivos: o diário precisa estar vazio antes
+    // e os outros processos esperam até o fim (códigos e posições contínuos)
+    confirmarDiario();
+    travarAlteracao();
+    atualizarSequencias();
+    checkpointDiario();
+
+    EscritaRegistros saida;
+    if (!abrirEscrita(&saida, destino, tipoRegistro, -1))
+    {
+        printf("Nao foi possivel abrir %s\n", destino);
+        fclose(entrada);
+        liberarAlteracao();
+        return 1;
+    }
+    setvbuf(entrada, NULL, _IOFBF, TAMANHO_BUFFER_IMPORTACAO);
+
+    long long inicio = agoraMs();
+    char linha[TAMANHO_LINHA_CSV];
+    char *campos[MAX_CAMPOS_CSV];
+    Operacao registro;  // Área grande o bastante para qualquer registro
+    int numeroLinha = 0, importados = 0, rejeitados = 0;
+
+    for (;;)
+    {
+        int inicioLinha = numeroLinha + 1;
+        int lida = lerLinhaCSV(entrada, linha, sizeof(linha), &numeroLinha);
+        if (lida == 0)
+            break;
+        if (inicioLinha == 1)
+            continue;  // Cabeçalho
+        if (lida < 0)
+        {
+            printf("Linha %d rejeitada: linha longa demais (maximo %d caracteres)\n",
+                   inicioLinha, TAMANHO_LINHA_CSV - 2);
+            rejeitados++;
+            continue;
+        }
+
+        int total = dividirCampos(linha, campos, MAX_CAMPOS_CSV);
+        if (total == 1 && campos[0][0] == 0)
+            continue;  // Linha em branco
+
+        const char *erro = montarRegistro(tipo, campos, total, &registro.dados);
+        if (erro)
+        {
+            printf("Linha %d rejeitada: %s\n", inicioLinha, erro);
+            rejeitados++;
+            continue;
+        }
+        importarRegistro(tipo, &registro.dados);
+        escreverRegistro(&saida, &registro.dados);  // Cabeçalho do bloco só quando ele enche
+        importados++;
+    }
+    fclose(entrada);
+
+    fecharEscrita(&saida, 1);
+
+    // Estadias ativas ocupam quartos: grava a tabela de quartos de uma vez
+    if (tipo == OP_ESTADIA && totalQuartos > 0)
+    {
+        gravarArquivo(ARQ_QUARTOS, REGISTRO_QUARTO, tabelaQuartos, totalQuartos);
+        sincronizarDados();
+    }
+    if (!salvarSequencias())
+        printf("Aviso: nao foi possivel gravar %s.\n", ARQ_SEQUENCIAS);
+    liberarAlteracao();
+
+    long long duracao = agoraMs() - inicio;
+    printf("Importacao de %s concluida: %d registro(s) importado(s), %d linha(s) rejeitada(s) em %lld ms\n",
+           entidade, importados, rejeitados, duracao);
+    return 0;
+}
+
+// ============================================================
+// MODO LOTE (COMANDOS POR LINHA)
+// ============================================================
+
+/*
+ * Executa comandos lidos linha a linha (da entrada padrão ou de um arquivo),
+ * sem menus nem pausas. Cada comando é uma palavra seguida de argumentos
+ * separados por ';'. A resposta de cada comando são zero ou mais linhas de
+ * dados (campos separados por TAB) seguidas de uma linha de status:
+ * "ok ..." ou "erro <motivo>". Linhas vazias e iniciadas por '#' são ignoradas.
+ *
+ *   cliente nome;endereco;telefone                 -> ok <codigo>
+ *   funcionario nome;telefone;cargo;salario        -> ok <codigo>
+ *   quarto numero;capacidade;valorDiaria           -> ok <numero>
+ *   checkin cliente;quarto;hospedes;entrada;saida  -> ok <estadia> <diarias> <valor>
+ *   checkout codigoEstadia                         -> ok <valor>
+ *   buscar-cliente codigo
+ *   pesquisar-cliente parte-do-nome
+ *   pesquisar-funcionario parte-do-nome
+ *   estadias-cliente codigo
+ *   pontos codigo                                  -> ok <estadias> <diarias> <pontos>
+ *   resgatar codigo;pontos                         -> ok <pontos restantes>
+ *   quartos-livres hospedes[;entrada;saida]        (sem período: livres hoje)
+ *   listar clientes|funcionarios|quartos|estadias[;csv|;tsv]
+ *                                                  (csv: separador ';' e cabeçalho)
+ *   resumo                                         -> totais do hotel
+ */
+#define BUFFER_LOTE 65536          // Bytes de comandos lidos de uma vez e buffer das respostas
+#define RESPOSTAS_POR_GRUPO 256    // Alterações por confirmação (respostas curtas cabem no buffer)
+
+/*
+ * Função: escreverCliente
+ * Objetivo: Escrever um cliente como linha de dados do modo lote
+ * Parâmetros: saida - destino da resposta
+ *             c - cliente a escrever
+ * Retorno: void
+ */
+void escreverCliente(FILE *saida, const Cliente *c)
+{
+    char linha[TAMANHO_LINHA_SAIDA];
+    SaidaBuffer s = {saida, linha, 0, sizeof(linha), FORMATO_TSV, 0};
+    saidaCliente(&s, c);
+    descarregarSaida(&s);
+}
+
+/*
+ * Função: escreverFuncionario
+ * Objetivo: Escrever um funcionário como linha de dados do modo lote
+ * Parâmetros: saida - destino da resposta
+ *             f - funcionário a escrever
+ * Retorno: void
+ */
+void escreverFuncionario(FILE *saida, const Funcionario *f)
+{
+    char linha[TAMANHO_LINHA_SAIDA];
+    SaidaBuffer s = {saida, linha, 0, sizeof(linha), FORMATO_TSV, 0};
+    saidaFuncionario(&s, f);
+    descarregarSaida(&s);
+}
+
+/*
+ * Função: escreverQuarto
+ * Objetivo: Escrever um quarto como linha de dados do modo lote
+ * Parâmetros: saida - destino da resposta
+ *             q - quarto a escrever
+ * Retorno: void
+ */
+void escreverQuarto(FILE *saida, const Quarto *q)
+{
+    char linha[TAMANHO_LINHA_SAIDA];
+    SaidaBuffer s = {saida, linha, 0, sizeof(linha), FORMATO_TSV, 0};
+    saidaQuarto(&s, q);
+    descarregarSaida(&s);
+}
+
+/*
+ * Função: escreverEstadia
+ * Objetivo: Escrever uma estadia como linha de dados do modo lote
+ * Parâmetros: saida - destino da resposta
+ *             e - estadia a escrever
+ * Retorno: void
+ */
+void escreverEstadia(FILE *saida, const Estadia *e)
+{
+    char linha[TAMANHO_LINHA_SAIDA];
+    SaidaBuffer s = {saida, linha, 0, sizeof(linha), FORMATO_TSV, 0};
+    saidaEstadia(&s, e);
+    descarregarSaida(&s);
+}
+
+/*
+ * Função: comandoCheckin
+ * Objetivo: Registrar uma estadia com as mesmas validações de novaEstadia
+ * Parâmetros: campos - cliente;quarto;hospedes;entrada;saida
+ *             total - quantidade de campos
+ *             saida - destino da resposta
+ * Retorno: int - 1 se registrou, 0 em caso de erro
+ */
+int comandoCheckin(char *campos[], int total, FILE *saida)
+{
+    if (total < 5)
+    {
+        fprintf(saida, "erro esperado cliente;quarto;hospedes;entrada;saida\n");
+        return 0;
+    }
+
+    int hospedes = atoi(campos[2]);
+    if (hospedes <= 0)
+    {
+        fprintf(saida, "erro quantidade de hospedes invalida\n");
+        return 0;
+    }
+
+    // Reaproveita a validação da importação (cliente, quarto e datas)
+    char *camposEstadia[5] = {campos[0], campos[1], campos[3], campos[4], "1"};
+    Estadia e;
+    const char *erro = montarRegistro(OP_ESTADIA, camposEstadia, 5, &e);
+    if (erro)
+    {
+        fprintf(saida, "erro %s\n", erro);
+        return 0;
+    }
+
+    Quarto escolhido = tabelaQuartos[mapaQuartosBuscar(e.numeroQuarto)];  // Já validado
+    if (escolhido.capacidade < hospedes)
+    {
+        fprintf(saida, "erro capacidade do quarto insuficiente\n");
+        return 0;
+    }
+
+    e.codigoEstadia = gerarCodigoEstadia();
+    if (!salvarEstadiaArquivo(e))
+    {
+        fprintf(saida, "erro quarto ja reservado no periodo\n");
+        return 0;
+    }
+    fprintf(saida, "ok %d %d %.2f\n", e.codigoEstadia, e.quantidadeDiarias,
+            e.quantidadeDiarias * escolhido.valorDiaria);
+    return 1;
+}
+
+/*
+ * Função: executarComando
+ * Objetivo: Interpretar e executar um comando do modo lote
+ * Parâmetros: linha - linha com o comando (é alterada durante a análise)
+ *             saida - destino da resposta
+ * Retorno: int - 1 se ok, 0 se erro, -1 se a linha foi ignorada
+ */
+int executarComando(char *linha, FILE *saida)
+{
+    linha[strcspn(linha, "\r\n")] = 0;
+    while (*linha == ' ' || *linha == '\t')
+        linha++;
+    if (*linha == 0 || *linha == '#')
+        return -1;  // Linha vazia ou comentário
+
+    // Separa o nome do comando dos argumentos
+    char *argumentos = strchr(linha, ' ');
+    if (argumentos)
+        *argumentos++ = 0;
+    else
+        argumentos = "";
+
+    char copia[512];
+    copiarTexto(copia, argumentos, sizeof(copia));
+    char *campos[MAX_CAMPOS_CSV];
+    int total = dividirCampos(copia, campos, MAX_CAMPOS_CSV);
+
+    if (strcmp(linha, "cliente") == 0 || strcmp(linha, "funcionario") == 0 ||
+        strcmp(linha, "quarto") == 0)
+    {
+        int tipo = linha[0] == 'c' ? OP_CLIENTE : linha[0] == 'f' ? OP_FUNCIONARIO : OP_QUARTO;
+        Operacao registro;
+        const char *erro = montarRegistro(tipo, campos, total, &registro.dados);
+        if (erro)
         {
-            if (strstr(c.nome, nomeBusca) != NULL)
-            {
-                printf("%d - %s\n", c.codigoCliente, c.nome);
-                encontrados++;
-            }
+            fprintf(saida, "erro %s\n", erro);
+            return 0;
         }
-        fclose(arquivoClientes);
-        
-        // Se não encontrou nenhum cliente
-        if (encontrados == 0)
+        if (tipo == OP_CLIENTE)
         {
-            printf("Nenhum cliente encontrado com esse nome.\n");
-            printf("\nPressione ENTER para voltar ao menu...");
-            getchar();
-            return;
+            registro.dados.cliente.codigoCliente = gerarCodigoCliente();
+            salvarClienteArquivo(registro.dados.cliente);
+            fprintf(saida, "ok %d\n", registro.dados.cliente.codigoCliente);
         }
-        
-        // Se encontrou mais de um cliente, pede para escolher
-        if (encontrados > 1)
+        else if (tipo == OP_FUNCIONARIO)
         {
-            printf("\nDigite o codigo do cliente desejado: ");
-            scanf("%d", &codigoCliente);
-            limparEntrada();
-            
-            // Obter nome do cliente selecionado
-            Cliente clienteSelecionado;
-            if (buscarCliente(codigoCliente, &clienteSelecionado))
-            {
-                strcpy(nomeCliente, clienteSelecionado.nome);
-            }
+            registro.dados.funcionario.codigoFuncionario = gerarCodigoFuncionario();
+            salvarFuncionarioArquivo(registro.dados.funcionario);
+            fprintf(saida, "ok %d\n", registro.dados.funcionario.codigoFuncionario);
         }
-        else  // Se encontrou apenas um cliente
+        else
         {
-            // Reabre arquivo para pegar dados do único cliente encontrado
-            arquivoClientes = fopen(ARQ_CLIENTES, "rb");
-            while (fread(&c, sizeof(Cliente), 1, arquivoClientes))
+            if (!salvarQuartoArquivo(registro.dados.quarto))
             {
-                if (strstr(c.nome, nomeBusca) != NULL)
-                {
-                    codigoCliente = c.codigoCliente;
-                    strcpy(nomeCliente, c.nome);
-                    break;
-                }
+                fprintf(saida, "erro ja existe um quarto com esse numero\n");
+                return 0;
             }
-            fclose(arquivoClientes);
+            fprintf(saida, "ok %d\n", registro.dados.quarto.numeroQuarto);
         }
+        return 1;
     }
-    else
-    {
-        printf("Opcao invalida!\n");
-        printf("\nPressione ENTER para voltar ao menu...");
-        getchar();
-        return;
-    }
-    
-    // Agora mostrar as estadias deste cliente
-    FILE *arquivoEstadias = fopen(ARQ_ESTADIAS, "rb");
-    if (!arquivoEstadias)
+
+    if (strcmp(linha, "checkin") == 0)
+        return comandoCheckin(campos, total, saida);
+
+    if (strcmp(linha, "checkout") == 0)
     {
-        printf("Nenhuma estadia registrada.\n");
-        printf("\nPressione ENTER para voltar ao menu...");
-        getchar();
-        return;
+        double valor;
+        if (!finalizarEstadia(atoi(campos[0]), &valor))
+        {
+            fprintf(saida, "erro estadia nao encontrada ou ja finalizada\n");
+            return 0;
+        }
+        fprintf(saida, "ok %.2f\n", valor);
+        return 1;
     }
-    
-    Estadia e;
-    int totalEstadias = 0;   // Contador de estadias
-    int totalDiarias = 0;    // Acumulador de diárias
-    
-    printf("\n=== ESTADIAS DO CLIENTE: %s (Codigo: %d) ===\n", nomeCliente, codigoCliente);
-    printf("==============================================\n");
-    
-    // Percorre todas as estadias procurando as do cliente
-    while (fread(&e, sizeof(Estadia), 1, arquivoEstadias))
+
+    if (strcmp(linha, "buscar-cliente") == 0)
     {
-        if (e.codigoCliente == codigoCliente)
+        Cliente c;
+        if (!buscarCliente(atoi(campos[0]), &c))
         {
-            printf("\nEstadia: %d\n", e.codigoEstadia);
-            printf("Quarto: %d\n", e.numeroQuarto);
-            printf("Entrada: %02d/%02d/%04d\n", e.dataEntrada.dia, e.dataEntrada.mes, e.dataEntrada.ano);
-            printf("Saida: %02d/%02d/%04d\n", e.dataSaida.dia, e.dataSaida.mes, e.dataSaida.ano);
-            printf("Diarias: %d\n", e.quantidadeDiarias);
-            printf("Status: %s\n", e.estadiaAtiva ? "ATIVA" : "FINALIZADA");
-            printf("-------------------\n");
-            
-            totalEstadias++;
-            totalDiarias += e.quantidadeDiarias;
+            fprintf(saida, "erro cliente nao encontrado\n");
+            return 0;
         }
+        escreverCliente(saida, &c);
+        fprintf(saida, "ok 1\n");
+        return 1;
     }
-    
-    fclose(arquivoEstadias);
-    
-    // Mostra resumo
-    if (totalEstadias == 0)
+
+    if (strcmp(linha, "pesquisar-cliente") == 0)
     {
-        printf("Nenhuma estadia encontrada para este cliente.\n");
+        int encontrados = pesquisarNomesClientes(argumentos);
+        for (int i = 0; i < encontrados; i++)
+            escreverCliente(saida, &tabelaClientes[resultadosNome[i]]);
+        fprintf(saida, "ok %d\n", encontrados);
+        return 1;
     }
-    else
+
+    if (strcmp(linha, "pesquisar-funcionario") == 0)
     {
-        printf("\nRESUMO:\n");
-        printf("Total de estadias: %d\n", totalEstadias);
-        printf("Total de diarias: %d\n", totalDiarias);
-        
-        // Calcular pontos de fidelidade (10 pontos por diária)
-        int pontos = totalDiarias * 10;
-        printf("Pontos de fidelidade acumulados: %d pontos\n", pontos);
+        int encontrados = pesquisarNomesFuncionarios(argumentos);
+        for (int i = 0; i < encontrados; i++)
+            escreverFuncionario(saida, &tabelaFuncionarios[resultadosNome[i]]);
+        fprintf(saida, "ok %d\n", encontrados);
+        return 1;
     }
-    
-    printf("\nPressione ENTER para voltar ao menu...");
-    getchar();
-}
 
-// ============================================================
-// FUNÇÃO PARA CALCULAR PONTOS DE FIDELIDADE
-// ============================================================
+    if (strcmp(linha, "estadias-cliente") == 0 || strcmp(linha, "pontos") == 0)
+    {
+        int codigo = atoi(campos[0]);
+        const SaldoFidelidade *saldo = saldoCliente(codigo);
+        if (!saldo)
+        {
+            fprintf(saida, "erro cliente nao encontrado\n");
+            return 0;
+        }
+        if (linha[0] == 'e')
+            for (int i = indiceBuscar(&primeiraEstadiaCliente, codigo); i >= 0;
+                 i = colunasEstadias.proximaDoCliente[i])
+            {
+                Estadia e = estadiaAtual(i);
+                escreverEstadia(saida, &e);
+            }
+        fprintf(saida, "ok %d %d %d\n", saldo->totalEstadias, saldo->totalDiarias,
+                saldo->pontos - saldo->pontosResgatados);
+        return 1;
+    }
 
-/*
- * Função: calcularPontosFidelidade
- * Objetivo: Calcular pontos de fidelidade de um cliente
- *           Sistema: 10 pontos por diária hospedada
- * Parâmetros: Nenhum
- * Retorno: void
- */
-void calcularPontosFidelidade()
-{
-    int opcao;
-    printf("\n=== CALCULAR PONTOS DE FIDELIDADE ===\n");
-    printf("1 - Calcular por codigo do cliente\n");
-    printf("2 - Calcular por nome do cliente\n");
-    printf("Opcao: ");
-    scanf("%d", &opcao);
-    limparEntrada();
-    
-    int codigoCliente = -1;
-    char nomeCliente[50] = "";
-    
-    // Processamento similar à função mostrarEstadiasCliente
-    if (opcao == 1)
+    if (strcmp(linha, "resgatar") == 0)
     {
-        printf("Digite o codigo do cliente: ");
-        scanf("%d", &codigoCliente);
-        limparEntrada();
-        
-        Cliente c;
-        if (!buscarCliente(codigoCliente, &c))
+        if (total < 2)
         {
-            printf("Cliente nao encontrado.\n");
-            printf("\nPressione ENTER para voltar ao menu...");
-            getchar();
-            return;
+            fprintf(saida, "erro use resgatar cliente;pontos\n");
+            return 0;
         }
-        strcpy(nomeCliente, c.nome);
+        int restantes = 0;
+        int resultado = resgatarPontos(atoi(campos[0]), atoi(campos[1]), &restantes);
+        if (resultado < 0)
+            fprintf(saida, "erro cliente nao encontrado\n");
+        else if (resultado == 0)
+            fprintf(saida, "erro saldo insuficiente (%d pontos disponiveis)\n", restantes);
+        else
+            fprintf(saida, "ok %d\n", restantes);
+        return resultado > 0;
     }
-    else if (opcao == 2)
+
+    if (strcmp(linha, "fidelidade") == 0)
     {
-        char nomeBusca[50];
-        printf("Digite o nome (ou parte do nome) do cliente: ");
-        fgets(nomeBusca, 50, stdin);
-        nomeBusca[strcspn(nomeBusca, "\n")] = 0;
-        
-        FILE *arquivoClientes = fopen(ARQ_CLIENTES, "rb");
-        if (!arquivoClientes)
+        if (strcmp(campos[0], "verificar") == 0)
         {
-            printf("Nenhum cliente cadastrado.\n");
-            printf("\nPressione ENTER para voltar ao menu...");
-            getchar();
-            return;
+            int divergentes = verificarFidelidade(saida);
+            if (divergentes > 0)
+            {
+                fprintf(saida, "erro %d saldo(s) divergente(s)\n", divergentes);
+                return 0;
+            }
+            fprintf(saida, "ok %d\n", totalClientes);
         }
-        
-        Cliente c;
-        int encontrados = 0;
-        printf("\n=== CLIENTES ENCONTRADOS ===\n");
-        
-        while (fread(&c, sizeof(Cliente), 1, arquivoClientes))
+        else if (strcmp(campos[0], "reconstruir") == 0)
         {
-            if (strstr(c.nome, nomeBusca) != NULL)
+            if (!reconstruirFidelidade())
             {
-                printf("%d - %s\n", c.codigoCliente, c.nome);
-                encontrados++;
+                fprintf(saida, "erro nao foi possivel gravar %s\n", ARQ_FIDELIDADE);
+                return 0;
             }
+            fprintf(saida, "ok %d\n", totalClientes);
         }
-        fclose(arquivoClientes);
-        
-        if (encontrados == 0)
+        else
         {
-            printf("Nenhum cliente encontrado com esse nome.\n");
-            printf("\nPressione ENTER para voltar ao menu...");
-            getchar();
-            return;
+            fprintf(saida, "erro use fidelidade verificar|reconstruir\n");
+            return 0;
         }
-        
-        if (encontrados > 1)
+        return 1;
+    }
+
+    if (strcmp(linha, "quartos-livres") == 0)
+    {
+        // Sem período: quartos livres esta noite (reservas futuras não contam)
+        int hospedes = atoi(campos[0]);
+        int hoje = diaSerialHoje();
+        int diaEntrada = hoje, diaSaida = hoje + 1;
+        if (total >= 3)
         {
-            printf("\nDigite o codigo do cliente desejado: ");
-            scanf("%d", &codigoCliente);
-            limparEntrada();
-            
-            Cliente clienteSelecionado;
-            if (buscarCliente(codigoCliente, &clienteSelecionado))
+            Data de, ds;
+            if (!lerDataCSV(campos[1], &de) || !lerDataCSV(campos[2], &ds) || diasEntreDatas(de, ds) <= 0)
             {
-                strcpy(nomeCliente, clienteSelecionado.nome);
+                fprintf(saida, "erro periodo invalido\n");
+                return 0;
             }
+            diaEntrada = diaSerial(de);
+            diaSaida = diaSerial(ds);
         }
-        else
-        {
-            arquivoClientes = fopen(ARQ_CLIENTES, "rb");
-            while (fread(&c, sizeof(Cliente), 1, arquivoClientes))
+        int livres = 0;
+        for (int i = 0; i < totalQuartos; i++)
+            if (quartoDisponivel(i, hospedes, diaEntrada, diaSaida))
             {
-                if (strstr(c.nome, nomeBusca) != NULL)
-                {
-                    codigoCliente = c.codigoCliente;
-                    strcpy(nomeCliente, c.nome);
-                    break;
-                }
+                Quarto q = quartoNoDia(i, hoje);
+                escreverQuarto(saida, &q);
+                livres++;
             }
-            fclose(arquivoClientes);
+        fprintf(saida, "ok %d\n", livres);
+        return 1;
+    }
+
+    if (strcmp(linha, "listar") == 0)
+    {
+        int formato = FORMATO_TSV;
+        if (total >= 2 && strcmp(campos[1], "csv") == 0)
+            formato = FORMATO_CSV;
+        else if (total >= 2 && strcmp(campos[1], "tsv") != 0)
+            formato = -1;
+
+        // Estadias são lidas por uma visão, sem segurar travaDados
+        int registros = formato < 0 ? -1 : listarRegistros(saida, campos[0], formato);
+        if (registros < 0)
+        {
+            fprintf(saida, "erro use listar clientes|funcionarios|quartos|estadias[;csv|;tsv]\n");
+            return 0;
         }
+        fprintf(saida, "ok %d\n", registros);
+        return 1;
     }
-    else
+
+    if (strcmp(linha, "relatorio") == 0)
     {
-        printf("Opcao invalida!\n");
-        printf("\nPressione ENTER para voltar ao menu...");
-        getchar();
-        return;
+        Data inicio, fim;
+        int agrupamento = strcmp(campos[0], "dia") == 0 ? AGRUPAR_DIA
+                        : strcmp(campos[0], "mes") == 0 ? AGRUPAR_MES
+                        : strcmp(campos[0], "quarto") == 0 ? AGRUPAR_QUARTO : -1;
+        if (agrupamento < 0 || total < 3)
+        {
+            fprintf(saida, "erro use relatorio dia|mes|quarto;inicio;fim\n");
+            return 0;
+        }
+        Relatorio r;
+        if (!lerDataCSV(campos[1], &inicio) || !lerDataCSV(campos[2], &fim) ||
+            !calcularRelatorio(&r, agrupamento, inicio, fim))
+        {
+            fprintf(saida, "erro periodo invalido\n");
+            return 0;
+        }
+        escreverRelatorio(saida, &r, 0);
+        fprintf(saida, "ok %d\n", r.grupos);
+        liberarRelatorio(&r);
+        return 1;
     }
-    
-    // Calcular pontos de fidelidade
-    FILE *arquivoEstadias = fopen(ARQ_ESTADIAS, "rb");
-    if (!arquivoEstadias)
+
+    if (strcmp(linha, "resumo") == 0)
     {
-        printf("Nenhuma estadia registrada.\n");
-        printf("\nPressione ENTER para voltar ao menu...");
-        getchar();
-        return;
+        int ocupados = 0, ativas = contarEstadiasAtivas(), hoje = diaSerialHoje();
+        for (int i = 0; i < totalQuartos; i++)
+            ocupados += quartoOcupadoNoDia(i, hoje);
+        fprintf(saida, "clientes\t%d\nfuncionarios\t%d\nquartos\t%d\nquartos_ocupados\t%d\n"
+                       "estadias\t%d\nestadias_ativas\t%d\n",
+                totalClientes, totalFuncionarios, totalQuartos, ocupados, totalEstadias, ativas);
+        fprintf(saida, "ok\n");
+        return 1;
     }
-    
-    Estadia e;
-    int totalDiarias = 0;    // Acumula total de diárias
-    int totalEstadias = 0;   // Conta total de estadias
-    
-    // Soma diárias de todas as estadias do cliente
-    while (fread(&e, sizeof(Estadia), 1, arquivoEstadias))
+
+    fprintf(saida, "erro comando desconhecido: %s\n", linha);
+    return 0;
+}
+
+/*
+ * Função: comandoAlteraDados
+ * Objetivo: Decidir se um comando do modo lote altera dados (no servidor,
+ *           precisa da trava de escrita)
+ * Parâmetros: linha - linha com o comando (não é alterada)
+ * Retorno: int - 1 se o comando altera dados, 0 se só consulta
+ */
+int comandoAlteraDados(const char *linha)
+{
+    static const char *comandos[] = {"cliente", "funcionario", "quarto", "checkin",
+                                     "checkout", "resgatar", "fidelidade"};
+    while (*linha == ' ' || *linha == '\t')
+        linha++;
+    size_t tamanho = strcspn(linha, " \r\n");
+
+    for (int i = 0; i < 7; i++)
+        if (strlen(comandos[i]) == tamanho && strncmp(linha, comandos[i], tamanho) == 0)
+            return 1;
+    return 0;
+}
+
+/*
+ * Função: executarLote
+ * Objetivo: Executar os comandos de uma entrada até o fim
+ *           Os comandos são lidos em blocos; antes de esperar por mais
+ *           entrada o grupo do diário é confirmado e só então as respostas
+ *           saem, então nenhum "ok" aparece antes de a operação estar no
+ *           disco e nenhum grupo fica aberto com a entrada parada
+ * Parâmetros: entrada - origem dos comandos
+ *             saida - destino das respostas
+ * Retorno: int - 0 se todos os comandos tiveram sucesso, 1 caso contrário
+ */
+int executarLote(FILE *entrada, FILE *saida)
+{
+    char *buffer = malloc(BUFFER_LOTE + 1);
+    if (!buffer)
+    {
+        printf("Erro: memoria insuficiente.\n");
+        return 1;
+    }
+    fflush(saida);
+    setvbuf(saida, NULL, _IOFBF, BUFFER_LOTE);  // Respostas só saem com fflush
+
+    int descritor = fileno(entrada);
+    int comandos = 0, erros = 0, alteracoes = 0;
+    int usados = 0, fimEntrada = 0;
+    long long inicio = agoraMs();
+
+    while (!fimEntrada)
     {
-        if (e.codigoCliente == codigoCliente)
+        // A leitura pode esperar: confirma o grupo, solta a trava e entrega
+        // as respostas antes
+        liberarAntesDeEsperar();
+        alteracoes = 0;
+        fflush(saida);
+
+        long lidos = (long)read(descritor, buffer + usados, (size_t)(BUFFER_LOTE - usados));
+        if (lidos < 0 && errno == EINTR)
+            continue;
+        if (lidos <= 0)
         {
-            totalDiarias += e.quantidadeDiarias;
-            totalEstadias++;
+            // Fim da entrada: a última linha pode ter chegado sem \n
+            fimEntrada = 1;
+            if (usados == 0)
+                break;
+            buffer[usados++] = '\n';
+        }
+        else
+            usados += (int)lidos;
+
+        char *linha = buffer, *fim;
+        while ((fim = memchr(linha, '\n', (size_t)(buffer + usados - linha))) != NULL)
+        {
+            *fim = 0;
+            // Consultas podem encher o buffer das respostas: as alterações
+            // anteriores são confirmadas antes, para nenhum "ok" sair antes do disco
+            int altera = comandoAlteraDados(linha);
+            if (alteracoes > 0 && (!altera || alteracoes >= RESPOSTAS_POR_GRUPO))
+            {
+                confirmarDiario();
+                alteracoes = 0;
+            }
+
+            atualizarDados();  // Inclui o que outros processos gravaram
+            int resultado = executarComando(linha, saida);
+            linha = fim + 1;
+            if (resultado < 0)
+                continue;
+            comandos++;
+            alteracoes += altera;
+            if (resultado == 0)
+                erros++;
+        }
+
+        // Guarda a linha incompleta para a próxima leitura
+        usados -= (int)(linha - buffer);
+        memmove(buffer, linha, (size_t)usados);
+        if (usados == BUFFER_LOTE)
+        {
+            fprintf(saida, "erro linha muito longa\n");
+            erros++;
+            usados = 0;
         }
     }
-    
-    fclose(arquivoEstadias);
-    
-    // Calcula pontos: 10 pontos por diária
-    int pontos = totalDiarias * 10;
-    
-    // Exibe resultados
-    printf("\n=== PONTOS DE FIDELIDADE ===\n");
-    printf("Cliente: %s (Codigo: %d)\n", nomeCliente, codigoCliente);
-    printf("Total de estadias: %d\n", totalEstadias);
-    printf("Total de diarias: %d\n", totalDiarias);
-    printf("Pontos de fidelidade: %d pontos\n", pontos);
-    printf("\n(10 pontos por diaria hospedada)\n");
-    
-    // Mostra benefícios disponíveis baseados nos pontos
-    if (pontos > 0)
+    confirmarDiario();  // Confirma o último grupo antes de medir o tempo
+    fflush(saida);
+    free(buffer);
+
+    long long duracao = agoraMs() - inicio;
+    fprintf(stderr, "# %d comando(s), %d erro(s) em %lld ms\n", comandos, erros, duracao);
+    return erros > 0;
+}
+
+// ============================================================
+// MODO SERVIDOR (VÁRIAS RECEPÇÕES EM UM ÚNICO CONJUNTO DE DADOS)
+// ============================================================
+
+/*
+ * "hotel servidor [socket] [threads]" carrega os dados uma vez e atende,
+ * por um socket de domínio Unix (padrão SOCKET_PADRAO), os mesmos comandos
+ * do modo lote enviados por vários clientes locais ao mesmo tempo. A
+ * thread principal só aceita conexões e as coloca numa fila; um grupo fixo
+ * de threads de trabalho atende cada conexão até o cliente desconectar.
+ *
+ * Os comandos que alteram dados (cadastros, checkin, checkout e
+ * fidelidade) tomam a trava de escrita das tabelas; os demais usam a trava
+ * de leitura e rodam em paralelo. O relatório e a listagem de estadias
+ * leem por uma visão (ver VISÕES DE LEITURA) e não seguram trava nenhuma:
+ * check-ins e check-outs seguem enquanto eles rodam. O cliente pode
+ * enviar vários comandos sem esperar as respostas (pipeline): tudo o que
+ * chega numa leitura do socket é executado em ordem, o grupo do diário é
+ * confirmado e as respostas saem juntas. "hotel conectar [socket]" envia
+ * a entrada padrão ao servidor e mostra as respostas.
+ *
+ * O mesmo código atende no Windows: o Winsock tem sockets de domínio Unix
+ * desde o Windows 10 (versão 1803), com o mesmo caminho de arquivo como
+ * endereço. As diferenças (tipo do socket, Ctrl+C, respostas por FILE*)
+ * ficam em Soquete, controleEncerramento e SaidaConexao.
+ */
+#define SOCKET_PADRAO "hotel.sock"
+#define FILA_CONEXOES 128       // Conexões aceitas aguardando uma thread
+#define BUFFER_CONEXAO 65536    // Bytes lidos/escritos de uma vez por conexão
+
+typedef struct
+{
+    Soquete conexoes[FILA_CONEXOES];  // Sockets aguardando atendimento (fila circular)
+    int inicio;                       // Posição da conexão mais antiga
+    int quantidade;                   // Conexões na fila
+    int encerrando;                   // 1 quando o servidor está parando
+    Soquete ativas[MAX_THREADS];      // Conexão em atendimento por thread (SOQUETE_INVALIDO = nenhuma)
+    pthread_mutex_t trava;            // Protege todos os campos acima
+    pthread_cond_t temConexao;        // Sinaliza conexão nova ou encerramento
+} FilaConexoes;
+
+FilaConexoes filaConexoes;
+volatile sig_atomic_t pedidoEncerramento = 0;  // Ctrl+C/SIGTERM recebido
+
+#ifdef _WIN32
+Soquete soqueteServidor = SOQUETE_INVALIDO;    // Fechado por controleEncerramento
+
+/*
+ * Função: controleEncerramento
+ * Objetivo: Tratador de Ctrl+C/Ctrl+Break/fechamento do console: pede o
+ *           encerramento do servidor (roda numa thread do sistema; fechar
+ *           o socket interrompe o accept da thread principal)
+ * Parâmetros: evento - evento do console
+ * Retorno: BOOL - TRUE (evento tratado)
+ */
+BOOL WINAPI controleEncerramento(DWORD evento)
+{
+    (void)evento;
+    pedidoEncerramento = 1;
+    fecharSoquete(soqueteServidor);
+    return TRUE;
+}
+#else
+/*
+ * Função: sinalEncerramento
+ * Objetivo: Tratador de SIGINT/SIGTERM: pede o encerramento do servidor
+ *           (a espera em accept é interrompida com EINTR)
+ * Parâmetros: sinal - sinal recebido
+ * Retorno: void
+ */
+void sinalEncerramento(int sinal)
+{
+    (void)sinal;
+    pedidoEncerramento = 1;
+}
+#endif
+
+/*
+ * Função: iniciarRede
+ * Objetivo: Preparar o uso de sockets (no Windows, iniciar o Winsock)
+ * Parâmetros: -
+ * Retorno: int - 1 se os sockets podem ser usados
+ */
+int iniciarRede()
+{
+#ifdef _WIN32
+    WSADATA dados;
+    if (WSAStartup(MAKEWORD(2, 2), &dados) != 0)
     {
-        printf("\nVANTAGENS:\n");
-        if (pontos >= 100)
-            printf("- %d pontos: Direito a 1 diaria gratis!\n", (pontos/100)*100);
-        if (pontos >= 50)
-            printf("- %d pontos: Upgrade de quarto disponivel\n", (pontos/50)*50);
-        printf("- Proximo beneficio: %d pontos\n", ((pontos/100)+1)*100);
+        printf("Nao foi possivel iniciar o Winsock\n");
+        return 0;
     }
-    
-    printf("\nPressione ENTER para voltar ao menu...");
-    getchar();
+#endif
+    return 1;
 }
 
-// ============================================================
-// FUNÇÕES DE CADASTRO
-// ============================================================
+/*
+ * Função: enviarTudo
+ * Objetivo: Enviar um trecho inteiro por um socket (send pode enviar menos)
+ * Parâmetros: conexao - socket
+ *             dados, tamanho - bytes a enviar
+ * Retorno: int - 1 se enviou tudo, 0 se a conexão caiu
+ */
+int enviarTudo(Soquete conexao, const char *dados, size_t tamanho)
+{
+    while (tamanho > 0)
+    {
+        int parte = tamanho > BUFFER_CONEXAO ? BUFFER_CONEXAO : (int)tamanho;
+        int enviados = (int)send(conexao, dados, parte, 0);
+        if (enviados < 0 && soqueteInterrompido())
+            continue;
+        if (enviados <= 0)
+            return 0;
+        dados += enviados;
+        tamanho -= (size_t)enviados;
+    }
+    return 1;
+}
 
 /*
- * Função: cadastrarCliente
- * Objetivo: Cadastrar um novo cliente no sistema
- *           Coleta informações via console e salva em arquivo
- * Parâmetros: Nenhum
- * Retorno: void
+ * Respostas de uma conexão: executarComando escreve num FILE*. No POSIX o
+ * FILE* é aberto direto sobre uma cópia do socket. No Windows um socket não
+ * é descritor da biblioteca C: as respostas passam por um pipe, e uma
+ * thread as envia ao cliente; se o cliente cai, a thread fecha o pipe e a
+ * escrita seguinte falha, como no POSIX.
  */
-void cadastrarCliente()
+typedef struct
 {
-    Cliente c;
-    c.codigoCliente = gerarCodigoCliente();  // Gera código automaticamente
+    FILE *arquivo;      // Onde executarComando escreve as respostas
+#ifdef _WIN32
+    Soquete conexao;    // Destino das respostas
+    int leitura;        // Ponta de leitura do pipe
+    pthread_t envio;    // Thread que copia o pipe para o socket
+#endif
+} SaidaConexao;
 
-    // Limpa buffer e coleta dados do cliente
-    limparEntrada();
-    printf("\nNome completo: ");
-    fgets(c.nome, 50, stdin);
-    c.nome[strcspn(c.nome, "\n")] = 0;  // Remove \n do final
+#ifdef _WIN32
+/*
+ * Função: enviarRespostas
+ * Objetivo: Thread do Windows: copia as respostas do pipe para o socket
+ *           até a conexão terminar
+ * Parâmetros: argumento - ponteiro para a SaidaConexao
+ * Retorno: void* - NULL
+ */
+void *enviarRespostas(void *argumento)
+{
+    SaidaConexao *s = argumento;
+    char buffer[BUFFER_CONEXAO];
+    int lidos;
+    while ((lidos = _read(s->leitura, buffer, sizeof(buffer))) > 0)
+        if (!enviarTudo(s->conexao, buffer, (size_t)lidos))
+            break;  // Cliente desconectou
+    _close(s->leitura);  // Escritas seguintes no pipe falham
+    return NULL;
+}
+#endif
 
-    printf("Endereco: ");
-    fgets(c.endereco, 50, stdin);
-    c.endereco[strcspn(c.endereco, "\n")] = 0;
+/*
+ * Função: abrirSaidaConexao
+ * Objetivo: Abrir o FILE* em que as respostas de uma conexão são escritas
+ * Parâmetros: s - saída a preencher
+ *             conexao - socket do cliente
+ * Retorno: int - 1 se abriu, 0 caso contrário
+ */
+int abrirSaidaConexao(SaidaConexao *s, Soquete conexao)
+{
+#ifdef _WIN32
+    int pontas[2];
+    if (_pipe(pontas, BUFFER_CONEXAO, _O_BINARY) != 0)
+        return 0;
+    s->conexao = conexao;
+    s->leitura = pontas[0];
+    s->arquivo = _fdopen(pontas[1], "wb");
+    if (!s->arquivo || pthread_create(&s->envio, NULL, enviarRespostas, s) != 0)
+    {
+        if (s->arquivo)
+            fclose(s->arquivo);
+        else
+            _close(pontas[1]);
+        _close(pontas[0]);
+        return 0;
+    }
+#else
+    int copia = dup(conexao);
+    s->arquivo = copia >= 0 ? fdopen(copia, "w") : NULL;
+    if (!s->arquivo)
+    {
+        if (copia >= 0)
+            close(copia);
+        return 0;
+    }
+#endif
+    setvbuf(s->arquivo, NULL, _IOFBF, BUFFER_CONEXAO);
+    return 1;
+}
 
-    printf("Telefone: ");
-    fgets(c.telefone, 20, stdin);
-    c.telefone[strcspn(c.telefone, "\n")] = 0;
+/*
+ * Função: fecharSaidaConexao
+ * Objetivo: Entregar as últimas respostas e fechar a saída da conexão
+ * Parâmetros: s - saída aberta por abrirSaidaConexao
+ * Retorno: void
+ */
+void fecharSaidaConexao(SaidaConexao *s)
+{
+    fclose(s->arquivo);
+#ifdef _WIN32
+    pthread_join(s->envio, NULL);  // Fim do pipe: a thread envia o resto e termina
+#endif
+}
 
-    // Salva cliente no arquivo
-    salvarClienteArquivo(c);
-    printf("\nCliente cadastrado com sucesso! (Codigo %d)\n", c.codigoCliente);
-    
-    // Pausa antes de voltar ao menu
-    printf("\nPressione ENTER para voltar ao menu...");
-    limparEntrada();
-    getchar();
+/*
+ * Função: comandoUsaVisao
+ * Objetivo: Decidir se um comando do modo lote lê só por uma visão e pode
+ *           rodar sem travaDados (relatório e listagem de estadias)
+ * Parâmetros: linha - linha com o comando (não é alterada)
+ * Retorno: int - 1 se o comando abre sua própria visão
+ */
+int comandoUsaVisao(const char *linha)
+{
+    while (*linha == ' ' || *linha == '\t')
+        linha++;
+    if (strncmp(linha, "relatorio", 9) == 0 && strchr(" \r\n", linha[9]))
+        return 1;
+    if (strncmp(linha, "listar", 6) != 0 || linha[6] != ' ')
+        return 0;
+    linha += 7;
+    while (*linha == ' ' || *linha == '\t')
+        linha++;
+    return strncmp(linha, "estadias", 8) == 0 && strchr(" ;\r\n", linha[8]);
 }
 
 /*
- * Função: cadastrarFuncionario
- * Objetivo: Cadastrar um novo funcionário no sistema
- *           Inclui validação de salário (não pode ser negativo)
- * Parâmetros: Nenhum
- * Retorno: void
+ * Função: atenderConexao
+ * Objetivo: Executar os comandos de uma conexão até o cliente desconectar
+ *           Cada leitura é executada inteira antes de as respostas serem
+ *           enviadas, o que agrupa comandos enviados em pipeline
+ * Parâmetros: conexao - socket do cliente
+ * Retorno: int - quantidade de comandos executados
  */
-void cadastrarFuncionario()
+int atenderConexao(Soquete conexao)
 {
-    Funcionario arquivo;
-    arquivo.codigoFuncionario = gerarCodigoFuncionario();
+    SaidaConexao respostas;
+    char *buffer = malloc(BUFFER_CONEXAO + 1);
+    if (!buffer || !abrirSaidaConexao(&respostas, conexao))
+    {
+        free(buffer);
+        return 0;
+    }
+    FILE *saida = respostas.arquivo;
 
-    // Coleta dados básicos
-    limparEntrada();
-    printf("\nNome completo: ");
-    fgets(arquivo.nome, 50, stdin);
-    arquivo.nome[strcspn(arquivo.nome, "\n")] = 0;
+    int usados = 0, comandos = 0, fimEntrada = 0;
+    while (!fimEntrada)
+    {
+        int lidos = (int)recv(conexao, buffer + usados, BUFFER_CONEXAO - usados, 0);
+        if (lidos < 0 && soqueteInterrompido())
+            continue;
+        if (lidos <= 0)
+        {
+            // Cliente fechou: a última linha pode ter chegado sem \n
+            fimEntrada = 1;
+            if (usados == 0)
+                break;
+            buffer[usados++] = '\n';
+        }
+        else
+            usados += lidos;
 
-    printf("Telefone: ");
-    fgets(arquivo.telefone, 20, stdin);
-    arquivo.telefone[strcspn(arquivo.telefone, "\n")] = 0;
+        // Outro processo (lote, importação) pode ter gravado nos arquivos
+        pthread_rwlock_rdlock(&travaDados);
+        int desatualizado = lerGeracao() != geracaoConhecida;
+        pthread_rwlock_unlock(&travaDados);
+        if (desatualizado)
+        {
+            pthread_rwlock_wrlock(&travaDados);
+            atualizarDados();
+            pthread_rwlock_unlock(&travaDados);
+        }
 
-    printf("Cargo: ");
-    fgets(arquivo.cargo, 30, stdin);
-    arquivo.cargo[strcspn(arquivo.cargo, "\n")] = 0;
+        // Executa todos os comandos completos recebidos até agora
+        int alteracoes = 0;
+        char *inicio = buffer, *fim;
+        while ((fim = memchr(inicio, '\n', (size_t)(buffer + usados - inicio))) != NULL)
+        {
+            *fim = 0;
+            int escrita = comandoAlteraDados(inicio);
+            int visao = !escrita && comandoUsaVisao(inicio);
+            if (alteracoes > 0 && (!escrita || alteracoes >= RESPOSTAS_POR_GRUPO))
+            {
+                // Consultas podem encher o buffer das respostas: confirma antes
+                pthread_rwlock_wrlock(&travaDados);
+                confirmarDiario();
+                pthread_rwlock_unlock(&travaDados);
+                alteracoes = 0;
+            }
+            if (escrita)
+                pthread_rwlock_wrlock(&travaDados);
+            else if (!visao)
+                pthread_rwlock_rdlock(&travaDados);
+            if (executarComando(inicio, saida) >= 0)
+                comandos++;
+            if (!visao)
+                pthread_rwlock_unlock(&travaDados);
+            alteracoes += escrita;
+            inicio = fim + 1;
+        }
 
-    // Validação de salário (deve ser positivo)
-    do
-    {
-        printf("Salario: ");
-        scanf("%lf", &arquivo.salario);
-        if (arquivo.salario < 0)
-            printf("Valor invalido! O salario nao pode ser negativo.\n");
-    } while (arquivo.salario < 0);
+        // Guarda a linha incompleta para a próxima leitura
+        usados -= (int)(inicio - buffer);
+        memmove(buffer, inicio, (size_t)usados);
+        if (usados == BUFFER_CONEXAO)
+        {
+            fprintf(saida, "erro linha muito longa\n");
+            usados = 0;
+        }
 
-    // Salva funcionário
-    salvarFuncionarioArquivo(arquivo);
-    printf("\nFuncionario cadastrado! (Codigo %d)\n", arquivo.codigoFuncionario);
+        // Respostas de alterações só saem depois de confirmado o grupo, e a
+        // trava dos arquivos não fica retida enquanto o cliente não escreve
+        if (alteracoes > 0)
+        {
+            pthread_rwlock_wrlock(&travaDados);
+            liberarAntesDeEsperar();
+            pthread_rwlock_unlock(&travaDados);
+        }
+        if (fflush(saida) != 0)
+            break;  // Cliente desconectou
+    }
 
-    printf("\nPressione ENTER para voltar ao menu...");
-    limparEntrada();
-    getchar();
+    free(buffer);
+    fecharSaidaConexao(&respostas);
+    return comandos;
 }
 
 /*
- * Função: cadastrarQuarto
- * Objetivo: Cadastrar um novo quarto no hotel
- *           Valida número único, capacidade positiva e valor positivo
- * Parâmetros: Nenhum
- * Retorno: void
+ * Função: trabalhadorServidor
+ * Objetivo: Corpo de uma thread do servidor: retira conexões da fila e as
+ *           atende até o servidor ser encerrado
+ * Parâmetros: argumento - ponteiro para o número da thread
+ * Retorno: void* - NULL
  */
-void cadastrarQuarto()
+void *trabalhadorServidor(void *argumento)
 {
-    Quarto q;
+    int id = *(int *)argumento;
+    FilaConexoes *fila = &filaConexoes;
 
-    // Valida número do quarto (deve ser positivo)
-    do
+    for (;;)
     {
-        printf("\nNumero do quarto: ");
-        scanf("%d", &q.numeroQuarto);
-        if (q.numeroQuarto <= 0)
-            printf("Numero invalido! O numero do quarto deve ser positivo.\n");
-    } while (q.numeroQuarto <= 0);
+        pthread_mutex_lock(&fila->trava);
+        while (fila->quantidade == 0 && !fila->encerrando)
+            pthread_cond_wait(&fila->temConexao, &fila->trava);
+        if (fila->encerrando)
+        {
+            pthread_mutex_unlock(&fila->trava);
+            break;
+        }
+        Soquete conexao = fila->conexoes[fila->inicio];
+        fila->inicio = (fila->inicio + 1) % FILA_CONEXOES;
+        fila->quantidade--;
+        fila->ativas[id] = conexao;
+        pthread_mutex_unlock(&fila->trava);
 
-    // Verifica se quarto com esse número já existe
-    Quarto existente;
-    if (buscarQuarto(q.numeroQuarto, &existente))
-    {
-        printf("Ja existe um quarto com esse numero.\n");
-        return;
-    }
+        atenderConexao(conexao);
 
-    // Valida capacidade (deve ser maior que zero)
-    do
-    {
-        printf("Capacidade: ");
-        scanf("%d", &q.capacidade);
-        if (q.capacidade <= 0)
-            printf("Capacidade invalida! Deve ser maior que zero.\n");
-    } while (q.capacidade <= 0);
+        // Só fecha depois de sair de ativas: o socket não é reaproveitado
+        // enquanto o encerramento ainda pode usá-lo. Se o encerramento já o
+        // fechou (Windows), ativas está vazia
+        pthread_mutex_lock(&fila->trava);
+        int fechada = fila->ativas[id] == SOQUETE_INVALIDO;
+        fila->ativas[id] = SOQUETE_INVALIDO;
+        pthread_mutex_unlock(&fila->trava);
+        if (!fechada)
+            fecharSoquete(conexao);
+    }
+    return NULL;
+}
 
-    // Valida valor da diária (deve ser positivo)
-    do
+/*
+ * Função: enderecoSocket
+ * Objetivo: Montar o endereço de um socket de domínio Unix
+ * Parâmetros: caminho - caminho do socket
+ *             endereco - endereço a preencher
+ * Retorno: int - 1 se o caminho cabe no endereço, 0 caso contrário
+ */
+int enderecoSocket(const char *caminho, struct sockaddr_un *endereco)
+{
+    memset(endereco, 0, sizeof(*endereco));
+    endereco->sun_family = AF_UNIX;
+    if (strlen(caminho) >= sizeof(endereco->sun_path))
     {
-        printf("Valor da diaria: ");
-        scanf("%lf", &q.valorDiaria);
-        if (q.valorDiaria <= 0)
-            printf("Valor invalido! A diaria deve ser positiva.\n");
-    } while (q.valorDiaria <= 0);
-
-    q.estaOcupado = 0;  // Novo quarto começa como livre
-
-    // Salva quarto
-    salvarQuartoArquivo(q);
-    printf("\nQuarto cadastrado com sucesso!\n");
-
-    printf("\nPressione ENTER para voltar ao menu...");
-    limparEntrada();
-    getchar();
+        printf("Caminho do socket muito longo: %s\n", caminho);
+        return 0;
+    }
+    strcpy(endereco->sun_path, caminho);
+    return 1;
 }
 
-// ============================================================
-// FUNÇÃO PARA REGISTRAR NOVA ESTADIA
-// ============================================================
-
 /*
- * Função: novaEstadia
- * Objetivo: Registrar uma nova estadia/hospedagem
- *           Processo completo: valida cliente, mostra quartos disponíveis,
- *           valida datas, calcula diárias e atualiza status
- * Parâmetros: Nenhum
- * Retorno: void
+ * Função: executarServidor
+ * Objetivo: Atender comandos de vários clientes até receber SIGINT/SIGTERM
+ * Parâmetros: caminho - caminho do socket
+ *             threads - quantidade de threads de trabalho
+ * Retorno: int - código de saída do programa
  */
-void novaEstadia()
+int executarServidor(const char *caminho, int threads)
 {
-    Estadia e;
-    e.codigoEstadia = gerarCodigoEstadia();  // Gera código automático
+    struct sockaddr_un endereco;
+    if (!enderecoSocket(caminho, &endereco))
+        return 1;
+    if (threads > MAX_THREADS)
+        threads = MAX_THREADS;
 
-    // Valida código do cliente
-    do
-    {
-        printf("Codigo do cliente: ");
-        scanf("%d", &e.codigoCliente);
-        if (e.codigoCliente <= 0)
-            printf("Codigo invalido! Deve ser positivo.\n");
-    } while (e.codigoCliente <= 0);
+    if (!iniciarRede())
+        return 1;
 
-    // Verifica se cliente existe
-    Cliente ctmp;
-    if (!buscarCliente(e.codigoCliente, &ctmp))
+    // Um socket que aceita conexões pertence a outro servidor em execução
+    Soquete servidor = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (servidor == SOQUETE_INVALIDO)
     {
-        printf("Cliente nao encontrado!\n");
-        return;
+        printf("Nao foi possivel criar o socket\n");
+        return 1;
+    }
+    if (connect(servidor, (struct sockaddr *)&endereco, sizeof(endereco)) == 0)
+    {
+        printf("Ja existe um servidor atendendo em %s\n", caminho);
+        fecharSoquete(servidor);
+        return 1;
     }
+    fecharSoquete(servidor);
+    remove(caminho);  // Sobra de um servidor que não terminou normalmente
 
-    // Valida quantidade de hóspedes
-    int hospedes;
-    do
+    servidor = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (servidor == SOQUETE_INVALIDO ||
+        bind(servidor, (struct sockaddr *)&endereco, sizeof(endereco)) != 0 ||
+        listen(servidor, FILA_CONEXOES) != 0)
     {
-        printf("Quantidade de hospedes: ");
-        scanf("%d", &hospedes);
-        if (hospedes <= 0)
-            printf("Quantidade invalida! Deve ser maior que zero.\n");
-    } while (hospedes <= 0);
+        printf("Nao foi possivel atender em %s\n", caminho);
+        if (servidor != SOQUETE_INVALIDO)
+            fecharSoquete(servidor);
+        return 1;
+    }
 
-    // Mostra quartos disponíveis compatíveis com a capacidade
-    FILE *arquivo = fopen(ARQ_QUARTOS, "rb");
-    Quarto q;
-    int encontrou = 0;  // Flag para verificar se há quartos disponíveis
+#ifdef _WIN32
+    soqueteServidor = servidor;
+    SetConsoleCtrlHandler(controleEncerramento, TRUE);
+#else
+    // Sem SA_RESTART: o sinal interrompe o accept da thread principal
+    struct sigaction acao;
+    memset(&acao, 0, sizeof(acao));
+    acao.sa_handler = sinalEncerramento;
+    sigaction(SIGINT, &acao, NULL);
+    sigaction(SIGTERM, &acao, NULL);
+    acao.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &acao, NULL);  // Cliente que desconecta não derruba o servidor
+#endif
+
+    FilaConexoes *fila = &filaConexoes;
+    memset(fila, 0, sizeof(*fila));
+    for (int t = 0; t < MAX_THREADS; t++)
+        fila->ativas[t] = SOQUETE_INVALIDO;
+    pthread_mutex_init(&fila->trava, NULL);
+    pthread_cond_init(&fila->temConexao, NULL);
 
-    printf("\nQuartos disponiveis para %d hospede(s):\n", hospedes);
+#ifndef _WIN32
+    // As threads de trabalho nascem com os sinais bloqueados: só a
+    // principal recebe SIGINT/SIGTERM
+    sigset_t sinais, anteriores;
+    sigemptyset(&sinais);
+    sigaddset(&sinais, SIGINT);
+    sigaddset(&sinais, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &sinais, &anteriores);
+#endif
+    pthread_t ids[MAX_THREADS];
+    int numeros[MAX_THREADS];
+    int criadas = 0;
+    for (; criadas < threads; criadas++)
+    {
+        numeros[criadas] = criadas;
+        if (pthread_create(&ids[criadas], NULL, trabalhadorServidor, &numeros[criadas]) != 0)
+            break;  // Segue com as threads que conseguiu criar
+    }
+#ifndef _WIN32
+    pthread_sigmask(SIG_SETMASK, &anteriores, NULL);
+#endif
+
+    int atendidas = 0;
+    if (criadas == 0)
+        printf("Nao foi possivel criar as threads do servidor\n");
+    else
+    {
+        printf("Servidor atendendo em %s com %d thread(s)\n", caminho, criadas);
+        fflush(stdout);
+    }
 
-    while (fread(&q, sizeof(Quarto), 1, arquivo))
+    while (criadas > 0 && !pedidoEncerramento)
     {
-        // Mostra apenas quartos livres com capacidade suficiente
-        if (!q.estaOcupado && q.capacidade >= hospedes)
+        Soquete conexao = accept(servidor, NULL, NULL);
+        if (conexao == SOQUETE_INVALIDO)
         {
-            printf("Quarto %d | Capacidade %d | Diaria: R$ %.2f\n", 
-                   q.numeroQuarto, q.capacidade, q.valorDiaria);
-            encontrou = 1;
+            if (soqueteInterrompido())
+                continue;
+            break;  // Inclui o socket fechado por controleEncerramento
+        }
+
+        pthread_mutex_lock(&fila->trava);
+        if (fila->quantidade == FILA_CONEXOES)
+        {
+            pthread_mutex_unlock(&fila->trava);
+            const char recusa[] = "erro servidor ocupado\n";
+            enviarTudo(conexao, recusa, sizeof(recusa) - 1);  // Cliente pode já ter desconectado
+            fecharSoquete(conexao);
+            continue;
         }
+        fila->conexoes[(fila->inicio + fila->quantidade) % FILA_CONEXOES] = conexao;
+        fila->quantidade++;
+        atendidas++;
+        pthread_cond_signal(&fila->temConexao);
+        pthread_mutex_unlock(&fila->trava);
     }
-    fclose(arquivo);
 
-    // Se não encontrou quartos disponíveis
-    if (!encontrou)
+    // Encerramento: descarta a fila e faz as conexões ativas lerem o fim
+    pthread_mutex_lock(&fila->trava);
+    fila->encerrando = 1;
+    for (; fila->quantidade > 0; fila->quantidade--)
     {
-        printf("\nNenhum quarto disponivel com essa capacidade.\n");
-        return;
+        fecharSoquete(fila->conexoes[fila->inicio]);
+        fila->inicio = (fila->inicio + 1) % FILA_CONEXOES;
     }
+    for (int t = 0; t < criadas; t++)
+        if (fila->ativas[t] != SOQUETE_INVALIDO)
+        {
+#ifdef _WIN32
+            // No Windows só fechar o socket cancela um recv em andamento
+            fecharSoquete(fila->ativas[t]);
+            fila->ativas[t] = SOQUETE_INVALIDO;
+#else
+            shutdown(fila->ativas[t], SHUT_RD);
+#endif
+        }
+    pthread_cond_broadcast(&fila->temConexao);
+    pthread_mutex_unlock(&fila->trava);
 
-    // Solicita número do quarto desejado
-    do
-    {
-        printf("\nDigite o numero do quarto desejado: ");
-        scanf("%d", &e.numeroQuarto);
-        if (e.numeroQuarto <= 0)
-            printf("Numero invalido! Deve ser positivo.\n");
-    } while (e.numeroQuarto <= 0);
+    for (int t = 0; t < criadas; t++)
+        pthread_join(ids[t], NULL);
+#ifdef _WIN32
+    if (!pedidoEncerramento)  // Senão controleEncerramento já o fechou
+#endif
+        fecharSoquete(servidor);
+    remove(caminho);
+    pthread_mutex_destroy(&fila->trava);
+    pthread_cond_destroy(&fila->temConexao);
+
+    confirmarDiario();  // O checkpoint final fica com encerrarDiario (atexit)
+    printf("Servidor encerrado (%d conexao(oes) atendida(s))\n", atendidas);
+    return criadas > 0 ? 0 : 1;
+}
+
+Soquete conexaoCliente = SOQUETE_INVALIDO;  // Conexão do modo conectar
+
+/*
+ * Função: enviarEntrada
+ * Objetivo: Thread do modo conectar: copia a entrada padrão para o
+ *           servidor e avisa o fim da entrada ao terminar
+ * Parâmetros: argumento - não usado (a conexão é conexaoCliente)
+ * Retorno: void* - NULL
+ */
+void *enviarEntrada(void *argumento)
+{
+    (void)argumento;
+    Soquete conexao = conexaoCliente;
+    char buffer[BUFFER_CONEXAO];
+    int lidos;
+
+    while ((lidos = (int)read(fileno(stdin), buffer, sizeof(buffer))) > 0)
+        if (!enviarTudo(conexao, buffer, (size_t)lidos))
+            return NULL;  // Servidor fechou a conexão
+    shutdown(conexao, FIM_ESCRITA);  // Servidor lê o fim e fecha depois das respostas
+    return NULL;
+}
 
-    // Valida escolha do quarto
-    Quarto escolhido;
-    if (!buscarQuarto(e.numeroQuarto, &escolhido) ||
-        escolhido.estaOcupado ||
-        escolhido.capacidade < hospedes)
-    {
-        printf("Quarto invalido ou indisponivel!\n");
-        return;
-    }
+/*
+ * Função: executarConexao
+ * Objetivo: Enviar comandos da entrada padrão a um servidor e mostrar as
+ *           respostas (entrada e respostas correm ao mesmo tempo, em pipeline)
+ * Parâmetros: caminho - caminho do socket do servidor
+ * Retorno: int - 0 se a conexão foi feita, 1 caso contrário
+ */
+int executarConexao(const char *caminho)
+{
+    struct sockaddr_un endereco;
+    if (!enderecoSocket(caminho, &endereco))
+        return 1;
 
-    // Lê data de entrada com validação
-    if (!lerData("Data de entrada", &e.dataEntrada)) {
-        return; // Falha na leitura da data
-    }
+    if (!iniciarRede())
+        return 1;
 
-    // Lê data de saída com validação
-    if (!lerData("Data de saida", &e.dataSaida)) {
-        return; // Falha na leitura da data
+    Soquete conexao = conexaoCliente = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (conexao == SOQUETE_INVALIDO ||
+        connect(conexao, (struct sockaddr *)&endereco, sizeof(endereco)) != 0)
+    {
+        printf("Nao foi possivel conectar ao servidor em %s\n", caminho);
+        if (conexao != SOQUETE_INVALIDO)
+            fecharSoquete(conexao);
+        return 1;
     }
 
-    // Calcula quantidade de diárias
-    e.quantidadeDiarias = diasEntreDatas(e.dataEntrada, e.dataSaida);
-    if (e.quantidadeDiarias <= 0)
+    pthread_t envio;
+    if (pthread_create(&envio, NULL, enviarEntrada, NULL) != 0)
     {
-        printf("Datas invalidas! A data de saida deve ser posterior a data de entrada.\n");
-        return;
+        fecharSoquete(conexao);
+        return 1;
     }
 
-    e.estadiaAtiva = 1;  // Marca estadia como ativa
-
-    // Salva estadia e marca quarto como ocupado
-    salvarEstadiaArquivo(e);
-    quartoOcupado(e.numeroQuarto, 1);
+    char buffer[BUFFER_CONEXAO];
+    int lidos;
+    while ((lidos = (int)recv(conexao, buffer, sizeof(buffer), 0)) > 0)
+    {
+        fwrite(buffer, 1, (size_t)lidos, stdout);
+        fflush(stdout);
+    }
 
-    // Mostra resumo da estadia
-    printf("\nEstadia registrada com sucesso!\n");
-    printf("Codigo da estadia: %d\n", e.codigoEstadia);
-    printf("Total de diarias: %d\n", e.quantidadeDiarias);
-    
-    double valorTotal = e.quantidadeDiarias * escolhido.valorDiaria;
-    printf("Valor total estimado: R$ %.2f\n", valorTotal);
-    
-    printf("\nPressione ENTER para voltar ao menu...");
-    limparEntrada();
-    getchar();
+    // Servidor fechou: a thread de envio pode estar esperando a entrada
+    // padrão, e termina com o processo
+    pthread_detach(envio);
+    return 0;
 }
 
 // ============================================================
-// FUNÇÃO PARA ENCERRAR ESTADIA
+// BENCHMARK COM GERADOR DE DADOS SINTÉTICOS
 // ============================================================
 
 /*
- * Função: encerrarEstadia
- * Objetivo: Encerrar uma estadia ativa
- *           Calcula valor total, marca estadia como finalizada
- *           e libera o quarto para nova ocupação
- * Parâmetros: Nenhum
- * Retorno: void
+ * "hotel benchmark [estadias] [clientes] [quartos] [amostras]" cria o
+ * diretório DIR_BENCHMARK, gera nele arquivos .bin sintéticos na escala
+ * pedida (de 1 mil a 10 milhões de estadias), carrega-os como o programa
+ * normal e mede cada operação chamando os mesmos comandos do modo lote.
+ * O resultado é uma linha JSON por operação (latências em microssegundos
+ * e vazão), para acompanhar regressões entre versões.
  */
-void encerrarEstadia()
+#define DIR_BENCHMARK "benchmark_dados"
+
+unsigned int estadoAleatorio = 2463534242u;  // Semente fixa: dados reproduzíveis
+
+/*
+ * Função: aleatorio
+ * Objetivo: Gerar um número pseudoaleatório (xorshift32)
+ * Parâmetros: limite - o resultado fica entre 0 e limite - 1
+ * Retorno: int - número sorteado
+ */
+int aleatorio(int limite)
 {
-    int codigo;
-    // Valida código da estadia
-    do
-    {
-        printf("Codigo da estadia: ");
-        scanf("%d", &codigo);
-        if (codigo <= 0)
-            printf("Codigo invalido! Deve ser positivo.\n");
-    } while (codigo <= 0);
+    estadoAleatorio ^= estadoAleatorio << 13;
+    estadoAleatorio ^= estadoAleatorio >> 17;
+    estadoAleatorio ^= estadoAleatorio << 5;
+    return (int)(estadoAleatorio % (unsigned int)limite);
+}
 
-    // Abre arquivos para leitura e escrita temporária
-    FILE *in = fopen(ARQ_ESTADIAS, "rb");
-    FILE *out = fopen("temp.dat", "wb");
+/*
+ * Função: gerarDadosSinteticos
+ * Objetivo: Gravar clientes, funcionários, quartos e estadias sintéticos
+ *           no diretório atual (cada arquivo com uma única escrita)
+ *           As últimas estadias ficam ativas, no máximo uma por quarto; as
+ *           finalizadas vão direto para o histórico, como após uma compactação
+ * Parâmetros: nEstadias, nClientes, nQuartos - escala dos dados
+ * Retorno: void
+ */
+void gerarDadosSinteticos(int nEstadias, int nClientes, int nQuartos)
+{
+    static const char *nomes[] = {"Maria", "Jose", "Ana", "Joao", "Antonio", "Francisca",
+                                  "Carlos", "Paulo", "Adriana", "Lucas", "Juliana", "Marcos",
+                                  "Patricia", "Pedro", "Aline", "Rafael", "Camila", "Samuel",
+                                  "Guilherme", "Fernanda"};
+    static const char *sobrenomes[] = {"Silva", "Santos", "Oliveira", "Souza", "Lima", "Pereira",
+                                       "Ferreira", "Costa", "Rodrigues", "Almeida", "Nascimento",
+                                       "Carvalho", "Gomes", "Martins", "Araujo", "Ribeiro",
+                                       "Barbosa", "Rocha", "Dias", "Teixeira"};
 
-    Estadia e;
-    int achou = 0;  // Flag para verificar se encontrou a estadia
+    Cliente *clientes = calloc((size_t)nClientes, sizeof(Cliente));
+    Quarto *quartos = calloc((size_t)nQuartos, sizeof(Quarto));
+    Estadia *estadias = calloc((size_t)nEstadias, sizeof(Estadia));
+    if (!clientes || !quartos || !estadias)
+    {
+        printf("Erro: memoria insuficiente.\n");
+        exit(1);
+    }
 
-    // Processa todas as estadias
-    while (fread(&e, sizeof(Estadia), 1, in))
+    for (int i = 0; i < nClientes; i++)
     {
-        // Se encontrou a estadia ativa procurada
-        if (e.codigoEstadia == codigo && e.estadiaAtiva)
-        {
-            // Obtém informações do quarto para cálculo
-            Quarto q;
-            buscarQuarto(e.numeroQuarto, &q);
+        clientes[i].codigoCliente = i + 1;
+        snprintf(clientes[i].nome, sizeof(clientes[i].nome), "%s %s %s %d",
+                 nomes[aleatorio(20)], sobrenomes[aleatorio(20)], sobrenomes[aleatorio(20)], i + 1);
+        snprintf(clientes[i].endereco, sizeof(clientes[i].endereco), "Rua %d, %d",
+                 aleatorio(5000), aleatorio(2000));
+        snprintf(clientes[i].telefone, sizeof(clientes[i].telefone), "31 9%08d", aleatorio(100000000));
+    }
 
-            double total = e.quantidadeDiarias * q.valorDiaria;
+    for (int i = 0; i < nQuartos; i++)
+    {
+        quartos[i].numeroQuarto = 101 + (i / 50) * 100 + i % 50;  // Andares de 50 quartos
+        quartos[i].capacidade = 1 + aleatorio(4);
+        quartos[i].valorDiaria = 120.0 + aleatorio(20) * 15.0;
+    }
 
-            printf("\nValor total da estadia: R$ %.2f\n", total);
+    Data inicio = {1, 1, 2000};
+    int inicioPeriodo = diaSerial(inicio);
+    int ativas = nQuartos / 2 < nEstadias ? nQuartos / 2 : nEstadias;
+    for (int i = 0; i < nEstadias; i++)
+    {
+        Estadia *e = &estadias[i];
+        e->codigoEstadia = i + 1;
+        e->codigoCliente = 1 + aleatorio(nClientes);
+        int entrada = inicioPeriodo + aleatorio(25 * 365);  // Entradas entre 2000 e 2024
+        e->quantidadeDiarias = 1 + aleatorio(14);
+        e->dataEntrada = dataDoDiaSerial(entrada);
+        e->dataSaida = dataDoDiaSerial(entrada + e->quantidadeDiarias);
 
-            e.estadiaAtiva = 0;  // Marca como finalizada
-            quartoOcupado(e.numeroQuarto, 0);  // Libera quarto
-            achou = 1;
+        int indiceAtiva = i - (nEstadias - ativas);
+        if (indiceAtiva >= 0)
+        {
+            // Estadia ativa: quarto exclusivo, marcado como ocupado
+            e->numeroQuarto = quartos[indiceAtiva * 2].numeroQuarto;
+            quartos[indiceAtiva * 2].estaOcupado = 1;
+            e->estadiaAtiva = 1;
+        }
+        else
+        {
+            e->numeroQuarto = quartos[aleatorio(nQuartos)].numeroQuarto;
+            e->estadiaAtiva = 0;
         }
-        fwrite(&e, sizeof(Estadia), 1, out);  // Escreve no temporário
     }
 
-    // Fecha arquivos e substitui original
-    fclose(in);
-    fclose(out);
-    remove(ARQ_ESTADIAS);
-    rename("temp.dat", ARQ_ESTADIAS);
+    gravarArquivo(ARQ_CLIENTES, REGISTRO_CLIENTE, clientes, nClientes);
+    gravarArquivo(ARQ_QUARTOS, REGISTRO_QUARTO, quartos, nQuartos);
+    gravarHistorico(ARQ_HISTORICO, estadias, nEstadias - ativas, 0, 0);
+    gravarArquivo(ARQ_ESTADIAS, REGISTRO_ESTADIA, estadias + (nEstadias - ativas), ativas);
 
-    // Feedback para o usuário
-    if (!achou)
-        printf("Estadia nao encontrada.\n");
-    else
-        printf("Estadia encerrada!\n");
-    
-    printf("\nPressione ENTER para voltar ao menu...");
-    limparEntrada();
-    getchar();
+    // Arquivos derivados são recriados pela carga normal
+    remove(ARQ_FUNCIONARIOS);
+    remove(ARQ_SEQUENCIAS);
+    remove(ARQ_DIARIO);
+
+    free(clientes);
+    free(quartos);
+    free(estadias);
 }
 
-// ============================================================
-// FUNÇÕES PARA MOSTRAR DADOS (LISTAGENS)
-// ============================================================
+/*
+ * Função: compararLatencias
+ * Objetivo: Comparação para qsort de latências (ordem crescente)
+ * Parâmetros: a, b - ponteiros para as latências
+ * Retorno: int - negativo, zero ou positivo
+ */
+int compararLatencias(const void *a, const void *b)
+{
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
 
 /*
- * Função: mostrarClientes
- * Objetivo: Listar todos os clientes cadastrados no sistema
- *           Inclui contador total
- * Parâmetros: Nenhum
+ * Função: medirComando
+ * Objetivo: Executar um comando do modo lote várias vezes e escrever uma
+ *           linha JSON com percentis de latência e vazão
+ * Parâmetros: operacao - nome da operação no resultado
+ *             formato - comando com um %d substituído a cada amostra
+ *             valores - valor do %d em cada amostra
+ *             amostras - quantidade de execuções
+ *             nulo - destino descartável das respostas
  * Retorno: void
  */
-void mostrarClientes()
+void medirComando(const char *operacao, const char *formato, const int *valores,
+                  int amostras, FILE *nulo)
 {
-    FILE *arquivo = fopen(ARQ_CLIENTES, "rb");
-    if (!arquivo)
-    {
-        printf("Nenhum cliente cadastrado.\n");
-        printf("\nPressione ENTER para voltar ao menu...");
-        getchar();
+    long long *latencias = malloc((size_t)amostras * sizeof(long long));
+    if (!latencias)
         return;
-    }
-
-    Cliente c;
-    int count = 0;  // Contador de clientes
 
-    printf("\n=== LISTA DE CLIENTES ===\n");
-    printf("========================================\n");
-    
-    // Lê e exibe cada cliente
-    while (fread(&c, sizeof(Cliente), 1, arquivo))
+    char linha[512];
+    long long inicioTotal = agoraNs();
+    for (int i = 0; i < amostras; i++)
     {
-        printf("\nCodigo: %d\n", c.codigoCliente);
-        printf("Nome: %s\n", c.nome);
-        printf("Endereco: %s\n", c.endereco);
-        printf("Telefone: %s\n", c.telefone);
-        printf("-------------------\n");
-        count++;
+        snprintf(linha, sizeof(linha), formato, valores[i]);
+        long long inicio = agoraNs();
+        executarComando(linha, nulo);
+        latencias[i] = agoraNs() - inicio;
     }
-    fclose(arquivo);
-    
-    printf("Total de clientes: %d\n", count);
-    printf("\nPressione ENTER para voltar ao menu...");
-    limparEntrada();
-    getchar();
+    confirmarDiario();  // Grupo pendente entra no tempo total
+    long long totalNs = agoraNs() - inicioTotal;
+
+    qsort(latencias, (size_t)amostras, sizeof(long long), compararLatencias);
+    printf("{\"operacao\":\"%s\",\"amostras\":%d,\"p50_us\":%.2f,\"p90_us\":%.2f,"
+           "\"p99_us\":%.2f,\"max_us\":%.2f,\"ops_por_s\":%.1f}\n",
+           operacao, amostras,
+           latencias[amostras / 2] / 1000.0,
+           latencias[(int)(amostras * 0.90)] / 1000.0,
+           latencias[(int)(amostras * 0.99)] / 1000.0,
+           latencias[amostras - 1] / 1000.0,
+           totalNs > 0 ? amostras * 1e9 / (double)totalNs : 0.0);
+    fflush(stdout);
+    free(latencias);
 }
 
 /*
- * Função: mostrarFuncionarios
- * Objetivo: Listar todos os funcionários cadastrados
- * Parâmetros: Nenhum
- * Retorno: void
+ * Função: executarBenchmark
+ * Objetivo: Gerar os dados sintéticos, carregá-los e medir as operações
+ * Parâmetros: argc, argv - argumentos (benchmark [estadias] [clientes] [quartos] [amostras])
+ * Retorno: int - código de saída do programa
  */
-void mostrarFuncionarios()
+int executarBenchmark(int argc, char *argv[])
 {
-    FILE *arquivo = fopen(ARQ_FUNCIONARIOS, "rb");
-    if (!arquivo)
+    int nEstadias = argc > 2 ? atoi(argv[2]) : 100000;
+    int nClientes = argc > 3 ? atoi(argv[3]) : (nEstadias / 10 > 1000 ? nEstadias / 10 : 1000);
+    int nQuartos = argc > 4 ? atoi(argv[4]) : 500;
+    int amostras = argc > 5 ? atoi(argv[5]) : 200;
+    if (nEstadias <= 0 || nClientes <= 0 || nQuartos <= 1 || amostras <= 0)
     {
-        printf("Nenhum funcionario cadastrado.\n");
-        printf("\nPressione ENTER para voltar ao menu...");
-        getchar();
-        return;
+        printf("Uso: %s benchmark [estadias] [clientes] [quartos] [amostras]\n", argv[0]);
+        return 1;
     }
 
-    Funcionario func;
-    int count = 0;
-
-    printf("\n=== LISTA DE FUNCIONaRIOS ===\n");
-    printf("========================================\n");
-    while (fread(&func, sizeof(Funcionario), 1, arquivo))
+    criarDiretorio(DIR_BENCHMARK);
+    if (mudarDiretorio(DIR_BENCHMARK) != 0)
     {
-        printf("\nCodigo: %d\n", func.codigoFuncionario);
-        printf("Nome: %s\n", func.nome);
-        printf("Telefone: %s\n", func.telefone);
-        printf("Cargo: %s\n", func.cargo);
-        printf("Salario: R$ %.2f\n", func.salario);
-        printf("-------------------\n");
-        count++;
+        printf("Nao foi possivel usar o diretorio %s\n", DIR_BENCHMARK);
+        return 1;
     }
-    fclose(arquivo);
-    
-    printf("Total de funcionarios: %d\n", count);
-    printf("\nPressione ENTER para voltar ao menu...");
-    limparEntrada();
-    getchar();
+
+    long long inicio = agoraNs();
+    gerarDadosSinteticos(nEstadias, nClientes, nQuartos);
+    long long geracao = agoraNs() - inicio;
+
+    inicio = agoraNs();
+    carregarDados();
+    reproduzirDiario();
+    carregarSequencias();
+    long long carga = agoraNs() - inicio;
+
+    printf("{\"estadias\":%d,\"clientes\":%d,\"quartos\":%d,\"amostras\":%d,"
+           "\"grupo_commit\":%d,\"geracao_ms\":%.1f,\"carga_ms\":%.1f}\n",
+           nEstadias, nClientes, nQuartos, amostras, grupoCommit, geracao / 1e6, carga / 1e6);
+
+    FILE *nulo = fopen(DISPOSITIVO_NULO, "w");
+    int *valores = malloc((size_t)amostras * sizeof(int));
+    if (!nulo || !valores)
+        return 1;
+
+    for (int i = 0; i < amostras; i++)
+        valores[i] = 1 + aleatorio(nClientes);
+    medirComando("buscar-cliente", "buscar-cliente %d", valores, amostras, nulo);
+    medirComando("estadias-cliente", "estadias-cliente %d", valores, amostras, nulo);
+    medirComando("pontos", "pontos %d", valores, amostras, nulo);
+
+    for (int i = 0; i < amostras; i++)
+        valores[i] = 1 + aleatorio(nClientes);
+    medirComando("pesquisar-cliente", "pesquisar-cliente Silva %d", valores, amostras, nulo);
+
+    for (int i = 0; i < amostras; i++)
+        valores[i] = 1 + aleatorio(4);
+    medirComando("quartos-livres", "quartos-livres %d", valores, amostras, nulo);
+
+    for (int i = 0; i < amostras; i++)
+        valores[i] = 1 + aleatorio(27);
+    medirComando("quartos-livres-periodo", "quartos-livres 2;%02d/03/2024;28/03/2024", valores, amostras, nulo);
+
+    int amostrasRelatorio = amostras < 20 ? amostras : 20;  // Relatórios percorrem todas as estadias
+    for (int i = 0; i < amostrasRelatorio; i++)
+        valores[i] = 2001 + aleatorio(24);
+    medirComando("relatorio-mes", "relatorio mes;01/01/2000;31/12/%d", valores, amostrasRelatorio, nulo);
+    medirComando("relatorio-quarto", "relatorio quarto;01/01/2000;31/12/%d", valores, amostrasRelatorio, nulo);
+
+    // Encerra estadias ativas (as últimas geradas), no máximo uma por amostra
+    int ativas = nQuartos / 2 < nEstadias ? nQuartos / 2 : nEstadias;
+    int encerramentos = ativas < amostras ? ativas : amostras;
+    for (int i = 0; i < encerramentos; i++)
+        valores[i] = nEstadias - i;
+    medirComando("checkout", "checkout %d", valores, encerramentos, nulo);
+
+    free(valores);
+    fclose(nulo);
+    return 0;
 }
 
 /*
- * Função: mostrarQuartos
- * Objetivo: Listar todos os quartos com status de ocupação
- *           Inclui estatísticas: total, ocupados e livres
- * Parâmetros: Nenhum
- * Retorno: void
+ * Função: consultarHistorico
+ * Objetivo: Listar as estadias finalizadas de um período direto do arquivo
+ *           do histórico, sem carregar os dados: blocos cujas faixas de datas
+ *           ou de clientes não cruzam a consulta nem são decodificados
+ * Parâmetros: textoInicio, textoFim - período (DD/MM/AAAA)
+ *             cliente - código do cliente (0 = todos)
+ * Retorno: int - código de saída do programa
  */
-void mostrarQuartos()
+int consultarHistorico(const char *textoInicio, const char *textoFim, int cliente)
 {
-    FILE *arquivo = fopen(ARQ_QUARTOS, "rb");
-    if (!arquivo)
+    Data dataInicio, dataFim;
+    if (!lerDataCSV(textoInicio, &dataInicio) || !lerDataCSV(textoFim, &dataFim))
     {
-        printf("Nenhum quarto cadastrado.\n");
-        printf("\nPressione ENTER para voltar ao menu...");
-        getchar();
-        return;
+        printf("erro datas invalidas (use DD/MM/AAAA)\n");
+        return 1;
     }
+    int inicio = diaSerial(dataInicio), fim = diaSerial(dataFim);
+    converterArquivosAntigos();
 
-    Quarto q;
-    int count = 0;      // Total de quartos
-    int ocupados = 0;   // Quartos ocupados
-    int livres = 0;     // Quartos livres
+    // Trava compartilhada: nenhuma compactação troca o arquivo durante a leitura
+    travarDados(TRAVA_COMPARTILHADA);
+    size_t bytes;
+    const unsigned char *mapa = mapearArquivo(ARQ_HISTORICO, &bytes);
+    CabecalhoArquivo cabecalho = {REGISTRO_HISTORICO, 0, 1, {0}};
+    if (mapa)
+        decodificarCabecalho(ARQ_HISTORICO, mapa, bytes, REGISTRO_HISTORICO, &cabecalho);
 
-    printf("\n=== LISTA DE QUARTOS ===\n");
-    printf("========================================\n");
-    while (fread(&q, sizeof(Quarto), 1, arquivo))
+    Estadia bloco[REGISTROS_POR_BLOCO];
+    SaidaBuffer saida;
+    abrirSaida(&saida, stdout, FORMATO_TSV);
+    int encontradas = 0, blocos = 0, lidos = 0;
+    long deslocamento = TAMANHO_CABECALHO;
+    for (int indice = 0; indice < cabecalho.total; blocos++)
     {
-        printf("\nNumero: %d\n", q.numeroQuarto);
-        printf("Capacidade: %d hospedes\n", q.capacidade);
-        printf("Valor da diaria: R$ %.2f\n", q.valorDiaria);
-        printf("Status: %s\n", q.estaOcupado ? "OCUPADO" : "LIVRE");
-        printf("-------------------\n");
-        
-        count++;
-        if (q.estaOcupado)
-            ocupados++;
-        else
-            livres++;
+        BlocoHistorico b;
+        if ((size_t)deslocamento + TAMANHO_CABECALHO_HISTORICO > bytes ||
+            !lerBlocoHistorico(mapa + deslocamento, deslocamento, bytes, &b))
+            historicoDanificado(ARQ_HISTORICO, indice);
+
+        if (b.menorEntrada <= fim && b.maiorSaida >= inicio &&
+            (cliente == 0 || (b.menorCliente <= cliente && cliente <= b.maiorCliente)))
+        {
+            if (!decodificarBlocoHistorico(mapa + deslocamento, &b, bloco))
+                historicoDanificado(ARQ_HISTORICO, indice);
+            lidos++;
+            for (int i = 0; i < b.registros && indice + i < cabecalho.total; i++)
+            {
+                const Estadia *e = &bloco[i];
+                if (diaSerial(e->dataEntrada) <= fim && diaSerial(e->dataSaida) >= inicio &&
+                    (cliente == 0 || e->codigoCliente == cliente))
+                {
+                    saidaEstadia(&saida, e);
+                    encontradas++;
+                }
+            }
+        }
+        indice += b.registros;
+        deslocamento = b.proximo;
     }
-    fclose(arquivo);
-    
-    // Mostra estatísticas
-    printf("RESUMO:\n");
-    printf("Total de quartos: %d\n", count);
-    printf("Quartos ocupados: %d\n", ocupados);
-    printf("Quartos livres: %d\n", livres);
-    printf("\nPressione ENTER para voltar ao menu...");
-    limparEntrada();
-    getchar();
+    desmapearArquivo(mapa, bytes);
+    travarDados(TRAVA_LIVRE);
+
+    fecharSaida(&saida);
+    printf("ok %d\n", encontradas);
+    fprintf(stderr, "# %d de %d bloco(s) do historico decodificado(s)\n", lidos, blocos);
+    return 0;
 }
 
 /*
- * Função: mostrarEstadias
- * Objetivo: Listar todas as estadias registradas
- *           Inclui status (ativa/finalizada) e estatísticas
- * Parâmetros: Nenhum
- * Retorno: void
+ * Função: executarModoComando
+ * Objetivo: Executar o programa sem o menu, a partir dos argumentos
+ *           Uso: hotel importar <entidade> <arquivo.csv>
+ *                hotel lote [arquivo-de-comandos]
+ *                hotel exportar <entidade> [csv|tsv]
+ *                hotel servidor [socket] [threads]
+ * Parâmetros: argc, argv - argumentos recebidos por main
+ * Retorno: int - código de saída do programa
  */
-void mostrarEstadias()
+int executarModoComando(int argc, char *argv[])
 {
-    FILE *arquivo = fopen(ARQ_ESTADIAS, "rb");
-    if (!arquivo)
+    if (strcmp(argv[1], "importar") == 0 && argc == 4)
+        return importarCSV(argv[2], argv[3]);
+
+    if (strcmp(argv[1], "lote") == 0 && argc <= 3)
     {
-        printf("Nenhuma estadia registrada.\n");
-        printf("\nPressione ENTER para voltar ao menu...");
-        getchar();
-        return;
+        FILE *entrada = argc == 3 ? fopen(argv[2], "r") : stdin;
+        if (!entrada)
+        {
+            printf("Nao foi possivel abrir %s\n", argv[2]);
+            return 1;
+        }
+        int resultado = executarLote(entrada, stdout);
+        if (entrada != stdin)
+            fclose(entrada);
+        return resultado;
     }
 
-    Estadia e;
-    int count = 0;          // Total de estadias
-    int ativas = 0;         // Estadias ativas
-    int finalizadas = 0;    // Estadias finalizadas
+    if (strcmp(argv[1], "exportar") == 0 && (argc == 3 || argc == 4))
+    {
+        // Só os registros, sem a linha de status do modo lote
+        int formato = argc == 4 && strcmp(argv[3], "csv") == 0 ? FORMATO_CSV : FORMATO_TSV;
+        if (argc == 4 && formato == FORMATO_TSV && strcmp(argv[3], "tsv") != 0)
+        {
+            fprintf(stderr, "Formato invalido: use csv ou tsv\n");
+            return 1;
+        }
+        int registros = listarRegistros(stdout, argv[2], formato);
+        if (registros < 0)
+        {
+            fprintf(stderr, "Entidade invalida: use clientes, funcionarios, quartos ou estadias\n");
+            return 1;
+        }
+        fprintf(stderr, "# %d registro(s) exportado(s)\n", registros);
+        return 0;
+    }
 
-    printf("\n=== LISTA DE ESTADIAS ===\n");
-    printf("========================================\n");
-    while (fread(&e, sizeof(Estadia), 1, arquivo))
-    {
-        printf("\nCodigo da estadia: %d\n", e.codigoEstadia);
-        printf("Codigo do cliente: %d\n", e.codigoCliente);
-        printf("Numero do quarto: %d\n", e.numeroQuarto);
-        printf("Data de entrada: %02d/%02d/%04d\n", e.dataEntrada.dia, e.dataEntrada.mes, e.dataEntrada.ano);
-        printf("Data de saida: %02d/%02d/%04d\n", e.dataSaida.dia, e.dataSaida.mes, e.dataSaida.ano);
-        printf("Quantidade de diarias: %d\n", e.quantidadeDiarias);
-        printf("Status: %s\n", e.estadiaAtiva ? "ATIVA" : "FINALIZADA");
-        printf("-------------------\n");
-        
-        count++;
-        if (e.estadiaAtiva)
-            ativas++;
-        else
-            finalizadas++;
+    if (strcmp(argv[1], "relatorio") == 0 && argc == 5)
+    {
+        char comando[128];
+        snprintf(comando, sizeof(comando), "relatorio %s;%s;%s", argv[2], argv[3], argv[4]);
+        return executarComando(comando, stdout) == 1 ? 0 : 1;
     }
-    fclose(arquivo);
-    
-    // Mostra estatísticas
-    printf("RESUMO:\n");
-    printf("Total de estadias: %d\n", count);
-    printf("Estadias ativas: %d\n", ativas);
-    printf("Estadias finalizadas: %d\n", finalizadas);
-    printf("\nPressione ENTER para voltar ao menu...");
-    limparEntrada();
-    getchar();
+
+    if (strcmp(argv[1], "fidelidade") == 0 && argc == 3)
+    {
+        char comando[64];
+        snprintf(comando, sizeof(comando), "fidelidade %s", argv[2]);
+        return executarComando(comando, stdout) == 1 ? 0 : 1;
+    }
+
+    if (strcmp(argv[1], "compactar") == 0 && argc == 2)
+    {
+        travarAlteracao();
+        int movidas = compactarEstadias();
+        liberarAlteracao();
+        printf("%d estadia(s) finalizada(s) movida(s) para %s; %d em %s\n",
+               movidas, ARQ_HISTORICO, registrosQuentes, ARQ_ESTADIAS);
+        return 0;
+    }
+
+    if (strcmp(argv[1], "servidor") == 0 && argc <= 4)
+    {
+        int threads = argc == 4 ? atoi(argv[3]) : processadoresDisponiveis();
+        return executarServidor(argc >= 3 ? argv[2] : SOCKET_PADRAO, threads > 0 ? threads : 1);
+    }
+
+    printf("Uso:\n");
+    printf("  %s                                  (menu interativo)\n", argv[0]);
+    printf("  %s importar <entidade> <arquivo.csv>\n", argv[0]);
+    printf("     entidade: clientes, funcionarios, quartos ou estadias\n");
+    printf("  %s lote [arquivo]                   (comandos da entrada padrao ou do arquivo)\n", argv[0]);
+    printf("  %s exportar <entidade> [csv|tsv]    (todos os registros na saida padrao)\n", argv[0]);
+    printf("  %s relatorio <dia|mes|quarto> <DD/MM/AAAA> <DD/MM/AAAA>\n", argv[0]);
+    printf("  %s fidelidade <verificar|reconstruir>\n", argv[0]);
+    printf("  %s compactar                        (move estadias finalizadas para o historico)\n", argv[0]);
+    printf("  %s historico <DD/MM/AAAA> <DD/MM/AAAA> [cliente]  (estadias finalizadas no periodo)\n", argv[0]);
+    printf("  %s benchmark [estadias] [clientes] [quartos] [amostras]\n", argv[0]);
+    printf("  %s servidor [socket] [threads]      (atende comandos do modo lote de varios clientes)\n", argv[0]);
+    printf("  %s conectar [socket]                (envia comandos ao servidor)\n", argv[0]);
+    return 1;
 }
 
 // ============================================================
@@ -1592,14 +9184,48 @@ void mostrarEstadias()
 /*
  * Função: main
  * Objetivo: Exibe menu e gerencia navegação entre funcionalidades
- * Parâmetros:-
+ *           Com argumentos, executa o modo de linha de comando
+ * Parâmetros: argc, argv - argumentos da linha de comando
  * Retorno: int - 0 se execução bem sucedida
  */
-int main()
+int main(int argc, char *argv[])
 {
     int menu;  // Armazena opção escolhida pelo usuário
+
+    // O benchmark usa seus próprios dados, em outro diretório
+    if (argc > 1 && strcmp(argv[1], "benchmark") == 0)
+        return executarBenchmark(argc, argv);
+
+    // A consulta ao histórico lê só os blocos do período, sem carregar os dados
+    if (argc > 1 && strcmp(argv[1], "historico") == 0 && (argc == 4 || argc == 5))
+        return consultarHistorico(argv[2], argv[3], argc == 5 ? atoi(argv[4]) : 0);
+
+    // O cliente do servidor não abre os arquivos: o servidor é o dono deles
+    if (argc > 1 && strcmp(argv[1], "conectar") == 0 && argc <= 3)
+        return executarConexao(argc == 3 ? argv[2] : SOCKET_PADRAO);
+
+    // A exportação não grava nada: arquivos de versões anteriores e diários
+    // pendentes entram só na memória
+    somenteLeitura = argc > 1 && strcmp(argv[1], "exportar") == 0;
+
+    carregarDados();      // Carrega todos os arquivos para memória uma única vez
+    reproduzirDiario();   // Reaplica operações não levadas aos arquivos
+    conferirBlocosSuspeitos();  // Avisa os blocos que nem o diário explicou
+    if (!somenteLeitura)
+        carregarSequencias(); // Lê (ou reconstrói) os contadores de códigos
+
+    if (argc > 1)
+        return executarModoComando(argc, argv);  // Modos não interativos
+
+    // No menu as operações chegam no ritmo de quem digita: cada uma é
+    // confirmada antes da mensagem de sucesso, sem grupo aberto entre elas
+    grupoCommit = 1;
+
     do
     {
+        liberarAntesDeEsperar();  // Nada retido enquanto o menu espera a opção
+        atualizarDados();         // Inclui o que outras recepções gravaram
+
         // Exibe menu com categorias organizadas
         printf("\n========== HOTEL DESCANSO GARANTIDO ==========\n");
         
@@ -1623,6 +9249,7 @@ int main()
         printf("11 - Pesquisar funcionario\n");
         printf("12 - Mostrar estadias de um cliente\n");
         printf("13 - Calcular pontos de fidelidade\n");
+        printf("14 - Relatorio de ocupacao e receita\n");
         
         printf("\n=== SISTEMA ===\n");
         printf("0 - Sair\n");
@@ -1680,13 +9307,16 @@ int main()
         case 13:
             calcularPontosFidelidade();
             break;
+        case 14:
+            relatorioOcupacao();
+            break;
         case 0:
             printf("\nSaindo do sistema...\n");
             printf("Obrigado por usar o sistema do Hotel Descanso Garantido!\n");
             break;
         default:
             // Opção inválida
-            printf("Opcao invalida! Digite um numero entre 0 e 13.\n");
+            printf("Opcao invalida! Digite um numero entre 0 e 14.\n");
             limparEntrada();
             getchar();
         }